@@ -4,133 +4,73 @@
  * Created by Claude Code (Anthropic)
  */
 
-#include <pspkernel.h>
-#include <pspctrl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
 
+#include "audio_monitor.h"
+#include "dynamic_text.h"
+#include "input.h"
+#include "platform.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "replay.h"
+#include "sequencer.h"
+#include "synth.h"
+#include "text_atlas.h"
+
 #define SCREEN_WIDTH 480
 #define SCREEN_HEIGHT 272
+#define FRAME_SAMPLE_MS 500
+
+// Help lines under the title, 25 pixels apart
+static const char *help_lines[] = {
+    "X - Play Beep 1 (440 Hz)",
+    "O - Play Beep 2 (880 Hz)",
+    "[] - Play/Pause Music",
+    "^ - Stop Music",
+    "L/R - Volume Down/Up",
+    "START - Quit",
+};
+
+#define HELP_LINE_COUNT (int)(sizeof(help_lines) / sizeof(help_lines[0]))
+
+#define SAMPLE_RATE 22050
+#define MUSIC_VOICE 0
+
+// Sine beeps with 10 ms fades so they do not click
+static const SynthNote beep1_notes[] = {{440, 1}}; // A4 note
+static const SynthNote beep2_notes[] = {{880, 1}}; // A5 note
+static const SynthNote music_notes[] = {{523, 1}}; // C5 note (longer for "music")
+static const SynthPattern beep1_pattern = {beep1_notes, 1, 200, 9830, 10, 10, 0};
+static const SynthPattern beep2_pattern = {beep2_notes, 1, 150, 9830, 10, 10, 0};
+static const SynthPattern music_pattern = {music_notes, 1, 1000, 9830, 10, 10, 1};
 
-typedef struct
-{
-    SDL_Texture *texture;
-    int w;
-    int h;
-} Text;
-
-Text createText(SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *text)
-{
-    Text t = {NULL, 0, 0};
-
-    SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
-    if (!surface)
-        return t;
-
-    t.texture = SDL_CreateTextureFromSurface(renderer, surface);
-    t.w = surface->w;
-    t.h = surface->h;
-    SDL_FreeSurface(surface);
-
-    return t;
-}
-
-void drawText(SDL_Renderer *renderer, Text *text, int x, int y)
-{
-    if (!text->texture)
-        return;
-
-    SDL_Rect dst = {x, y, text->w, text->h};
-    SDL_RenderCopy(renderer, text->texture, NULL, &dst);
-}
-
-void freeText(Text *text)
-{
-    if (text->texture)
-        SDL_DestroyTexture(text->texture);
-    text->texture = NULL;
-}
-
-// Generate a simple sine wave beep sound
-void generateBeepSound(const char *filename, int frequency, int duration_ms)
+int main(int argc, char **argv)
 {
-    int sample_rate = 22050;
-    int samples = (sample_rate * duration_ms) / 1000;
-
-    SDL_AudioSpec spec;
-    spec.freq = sample_rate;
-    spec.format = AUDIO_S16SYS;
-    spec.channels = 1;
-    spec.samples = 4096;
-    spec.callback = NULL;
-
-    Sint16 *buffer = (Sint16 *)malloc(samples * sizeof(Sint16));
-    if (!buffer)
-        return;
-
-    // Generate sine wave
-    for (int i = 0; i < samples; i++)
-    {
-        double t = (double)i / sample_rate;
-        double envelope = 1.0;
-
-        // Add envelope to prevent clicking
-        if (i < sample_rate / 100) // 10ms fade in
-            envelope = (double)i / (sample_rate / 100);
-        else if (i > samples - sample_rate / 100) // 10ms fade out
-            envelope = (double)(samples - i) / (sample_rate / 100);
-
-        buffer[i] = (Sint16)(32767 * 0.3 * envelope * sin(2.0 * M_PI * frequency * t));
-    }
+    platformInit(argc, argv);
 
-    // Save as WAV
-    SDL_RWops *file = SDL_RWFromFile(filename, "wb");
-    if (file)
+    int save_audio = 0;
+    int audio_profile = AUDIO_PROFILE_DEFAULT;
+    for (int i = 1; i < argc; i++)
     {
-        // WAV header
-        SDL_RWwrite(file, "RIFF", 4, 1);
-        Uint32 chunk_size = 36 + samples * 2;
-        SDL_RWwrite(file, &chunk_size, 4, 1);
-        SDL_RWwrite(file, "WAVE", 4, 1);
-
-        // fmt chunk
-        SDL_RWwrite(file, "fmt ", 4, 1);
-        Uint32 fmt_size = 16;
-        SDL_RWwrite(file, &fmt_size, 4, 1);
-        Uint16 audio_format = 1; // PCM
-        SDL_RWwrite(file, &audio_format, 2, 1);
-        Uint16 num_channels = 1;
-        SDL_RWwrite(file, &num_channels, 2, 1);
-        SDL_RWwrite(file, &sample_rate, 4, 1);
-        Uint32 byte_rate = sample_rate * 2;
-        SDL_RWwrite(file, &byte_rate, 4, 1);
-        Uint16 block_align = 2;
-        SDL_RWwrite(file, &block_align, 2, 1);
-        Uint16 bits_per_sample = 16;
-        SDL_RWwrite(file, &bits_per_sample, 2, 1);
-
-        // data chunk
-        SDL_RWwrite(file, "data", 4, 1);
-        Uint32 data_size = samples * 2;
-        SDL_RWwrite(file, &data_size, 4, 1);
-        SDL_RWwrite(file, buffer, samples * 2, 1);
-
-        SDL_RWclose(file);
+        if (strcmp(argv[i], "--save-audio") == 0)
+            save_audio = 1;
+        else if (strncmp(argv[i], "--latency=", 10) == 0 && parseAudioProfile(argv[i] + 10) >= 0)
+            audio_profile = parseAudioProfile(argv[i] + 10);
     }
 
-    free(buffer);
-}
-
-int main(int argc, char **argv)
-{
-    (void)argc;
-    (void)argv;
+    // Headless runs alternate both beeps and toggle the music
+    static const AutopilotStep autopilot[] = {
+        {30, 0}, {1, PSP_CTRL_CROSS}, {30, 0}, {1, PSP_CTRL_CIRCLE}, {30, 0}, {1, PSP_CTRL_SQUARE}};
+    platformSetAutopilot(autopilot, (int)(sizeof(autopilot) / sizeof(autopilot[0])), 0);
 
     // Initialize PSP controls
-    sceCtrlSetSamplingCycle(0);
+    static Input input;
+    initInput(&input);
     sceCtrlSetSamplingMode(PSP_CTRL_MODE_DIGITAL);
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
@@ -142,14 +82,26 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    // Initialize SDL_mixer
-    if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) < 0)
+    // Initialize SDL_mixer with the chosen buffer size; the monitor times every callback
+    static AudioMonitor monitor;
+    if (openAudioMonitor(&monitor, audio_profile, SAMPLE_RATE) < 0)
     {
         TTF_Quit();
         SDL_Quit();
         return 1;
     }
 
+    // The music is mixed block by block in the music hook, never rendered ahead
+    static Sequencer sequencer;
+    int mix_rate, mix_channels;
+    Uint16 mix_format;
+    int have_music = Mix_QuerySpec(&mix_rate, &mix_format, &mix_channels) && mix_format == AUDIO_S16SYS;
+    if (have_music)
+    {
+        initSequencer(&sequencer, mix_rate, mix_channels);
+        hookAudioMonitor(&monitor, sequencerHook, &sequencer);
+    }
+
     SDL_Window *win = SDL_CreateWindow(
         "Audio Demo",
         SDL_WINDOWPOS_UNDEFINED,
@@ -160,7 +112,7 @@ int main(int argc, char **argv)
 
     if (!win)
     {
-        Mix_CloseAudio();
+        closeAudioMonitor(&monitor);
         TTF_Quit();
         SDL_Quit();
         return 1;
@@ -170,7 +122,7 @@ int main(int argc, char **argv)
     if (!renderer)
     {
         SDL_DestroyWindow(win);
-        Mix_CloseAudio();
+        closeAudioMonitor(&monitor);
         TTF_Quit();
         SDL_Quit();
         return 1;
@@ -181,7 +133,20 @@ int main(int argc, char **argv)
     {
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(win);
-        Mix_CloseAudio();
+        closeAudioMonitor(&monitor);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    // The title and help lines are drawn from one glyph texture instead of a texture per line
+    static TextAtlas atlas;
+    if (createTextAtlas(&atlas, renderer, font) < 0)
+    {
+        TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(win);
+        closeAudioMonitor(&monitor);
         TTF_Quit();
         SDL_Quit();
         return 1;
@@ -190,170 +155,226 @@ int main(int argc, char **argv)
     SDL_Color white = {255, 255, 255, 255};
     SDL_Color green = {0, 255, 0, 255};
 
-    // Generate sound files
-    generateBeepSound("beep.wav", 440, 200);   // A4 note
-    generateBeepSound("beep2.wav", 880, 150);  // A5 note
-    generateBeepSound("music.wav", 523, 1000); // C5 note (longer for "music")
-
-    // Load sounds
-    Mix_Chunk *beep1 = Mix_LoadWAV("beep.wav");
-    Mix_Chunk *beep2 = Mix_LoadWAV("beep2.wav");
-    Mix_Music *music = Mix_LoadMUS("music.wav");
-
-    // UI text
-    Text title = createText(renderer, font, white, "PSP Audio Demo");
-    Text line1 = createText(renderer, font, green, "X - Play Beep 1 (440 Hz)");
-    Text line2 = createText(renderer, font, green, "O - Play Beep 2 (880 Hz)");
-    Text line3 = createText(renderer, font, green, "[] - Play/Pause Music");
-    Text line4 = createText(renderer, font, green, "^ - Stop Music");
-    Text line5 = createText(renderer, font, green, "L/R - Volume Down/Up");
-    Text line6 = createText(renderer, font, green, "START - Quit");
-
-    char status_buffer[64];
-    Text status_text = {NULL, 0, 0};
-
-    SceCtrlData pad;
+    // Render the beeps in memory; --save-audio also writes them and one pass of the music out as WAV files
+    SynthSound beep1_sound, beep2_sound;
+    renderSynthPattern(&beep1_sound, &beep1_pattern, SAMPLE_RATE);
+    renderSynthPattern(&beep2_sound, &beep2_pattern, SAMPLE_RATE);
+
+    if (save_audio)
+    {
+        SynthSound music_sound;
+        saveSynthSound(&beep1_sound, "beep.wav");
+        saveSynthSound(&beep2_sound, "beep2.wav");
+        if (renderSynthPattern(&music_sound, &music_pattern, SAMPLE_RATE) == 0)
+        {
+            saveSynthSound(&music_sound, "music.wav");
+            freeSynthSound(&music_sound);
+        }
+    }
+
+    // Chunks are decoded into the mixer's format, so the rendered sounds can go
+    Mix_Chunk *beep1 = synthChunk(&beep1_sound);
+    Mix_Chunk *beep2 = synthChunk(&beep2_sound);
+    freeSynthSound(&beep1_sound);
+    freeSynthSound(&beep2_sound);
+
+    // Dynamic labels only re-rasterize when their contents change
+    DynamicText status_text;
+    DynamicText frame_text;
+    DynamicText latency_text;
+    createDynamicText(&status_text, renderer, font, white, "Music: Stopped | Volume: 100%");
+    createDynamicText(&frame_text, renderer, font, green, "Frame: 00.00 ms | Redraws: 0000");
+    createDynamicText(&latency_text, renderer, font, green, "Audio: 0000 | Lag: 000 ms | Underruns: 00");
+
+    static ProfilerOverlay overlay;
+    initProfilerOverlay(&overlay, renderer, "Orbitron-Regular.ttf");
+
+    // Frame cost is averaged over FRAME_SAMPLE_MS so the counter stays readable
+    Uint64 perf_freq = SDL_GetPerformanceFrequency();
+    Uint64 frame_cost_total = 0;
+    int frame_cost_count = 0;
+    Uint32 frame_sample_start = SDL_GetTicks();
+    float frame_cost_ms = 0.0f;
+
     int running = 1;
-    int music_playing = 0;
     int volume = MIX_MAX_VOLUME / 2;
-    int button_pressed = 0;
 
-    Mix_VolumeMusic(volume);
+    setSequencerVolume(&sequencer, volume);
     Mix_Volume(-1, volume);
 
-    while (running)
+    while (running && platformRunning())
     {
-        sceCtrlReadBufferPositive(&pad, 1);
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        profilerBeginFrame();
+
+        profileBegin("input");
+        updateInput(&input);
 
-        if (pad.Buttons)
+        // Every press in the order it happened, so two buttons together or a tap between frames all count
+        InputEvent event;
+        while (nextInputEvent(&input, &event))
         {
-            if (!button_pressed)
+            if (!event.down)
+                continue;
+
+            if (event.button == PSP_CTRL_START)
             {
-                if (pad.Buttons & PSP_CTRL_START)
-                {
-                    running = 0;
-                }
-                else if (pad.Buttons & PSP_CTRL_CROSS)
+                running = 0;
+            }
+            else if (event.button == PSP_CTRL_CROSS)
+            {
+                if (beep1)
                 {
-                    if (beep1)
-                        Mix_PlayChannel(-1, beep1, 0);
+                    markAudioTrigger(&monitor);
+                    Mix_PlayChannel(-1, beep1, 0);
                 }
-                else if (pad.Buttons & PSP_CTRL_CIRCLE)
+            }
+            else if (event.button == PSP_CTRL_CIRCLE)
+            {
+                if (beep2)
                 {
-                    if (beep2)
-                        Mix_PlayChannel(-1, beep2, 0);
+                    markAudioTrigger(&monitor);
+                    Mix_PlayChannel(-1, beep2, 0);
                 }
-                else if (pad.Buttons & PSP_CTRL_SQUARE)
+            }
+            else if (event.button == PSP_CTRL_SQUARE)
+            {
+                if (have_music)
                 {
-                    if (music)
+                    if (voicePlaying(&sequencer, MUSIC_VOICE))
                     {
-                        if (music_playing)
-                        {
-                            if (Mix_PausedMusic())
-                            {
-                                Mix_ResumeMusic();
-                            }
-                            else
-                            {
-                                Mix_PauseMusic();
-                            }
-                        }
-                        else
-                        {
-                            Mix_PlayMusic(music, -1); // Loop forever
-                            music_playing = 1;
-                        }
+                        pauseSequencer(&sequencer, !sequencerPaused(&sequencer));
+                    }
+                    else
+                    {
+                        pauseSequencer(&sequencer, 0);
+                        playVoice(&sequencer, MUSIC_VOICE, &music_pattern); // Loops forever
                     }
                 }
-                else if (pad.Buttons & PSP_CTRL_TRIANGLE)
-                {
-                    Mix_HaltMusic();
-                    music_playing = 0;
-                }
-                else if (pad.Buttons & PSP_CTRL_LTRIGGER)
-                {
-                    volume -= 16;
-                    if (volume < 0)
-                        volume = 0;
-                    Mix_VolumeMusic(volume);
-                    Mix_Volume(-1, volume);
-                }
-                else if (pad.Buttons & PSP_CTRL_RTRIGGER)
-                {
-                    volume += 16;
-                    if (volume > MIX_MAX_VOLUME)
-                        volume = MIX_MAX_VOLUME;
-                    Mix_VolumeMusic(volume);
-                    Mix_Volume(-1, volume);
-                }
-
-                button_pressed = 1;
+            }
+            else if (event.button == PSP_CTRL_TRIANGLE)
+            {
+                playVoice(&sequencer, MUSIC_VOICE, NULL);
+            }
+            else if (event.button == PSP_CTRL_LTRIGGER)
+            {
+                volume -= 16;
+                if (volume < 0)
+                    volume = 0;
+                setSequencerVolume(&sequencer, volume);
+                Mix_Volume(-1, volume);
+            }
+            else if (event.button == PSP_CTRL_RTRIGGER)
+            {
+                volume += 16;
+                if (volume > MIX_MAX_VOLUME)
+                    volume = MIX_MAX_VOLUME;
+                setSequencerVolume(&sequencer, volume);
+                Mix_Volume(-1, volume);
+            }
+            else if (event.button == PSP_CTRL_SELECT)
+            {
+                overlay.visible = !overlay.visible;
             }
         }
-        else
-        {
-            button_pressed = 0;
-        }
+        profileEnd();
 
         // Update status
+        profileBegin("update");
         const char *music_status = "Stopped";
-        if (Mix_PlayingMusic())
+        if (voicePlaying(&sequencer, MUSIC_VOICE))
         {
-            if (Mix_PausedMusic())
+            if (sequencerPaused(&sequencer))
                 music_status = "Paused";
             else
                 music_status = "Playing";
         }
 
-        snprintf(status_buffer, sizeof(status_buffer),
-                 "Music: %s | Volume: %d%%",
-                 music_status,
-                 (volume * 100) / MIX_MAX_VOLUME);
+        setDynamicText(&status_text, "Music: %s | Volume: %d%%",
+                       music_status,
+                       (volume * 100) / MIX_MAX_VOLUME);
 
-        freeText(&status_text);
-        status_text = createText(renderer, font, white, status_buffer);
+        if (SDL_GetTicks() - frame_sample_start >= FRAME_SAMPLE_MS && frame_cost_count > 0)
+        {
+            frame_cost_ms = (float)((double)frame_cost_total * 1000.0 / perf_freq / frame_cost_count);
+            frame_cost_total = 0;
+            frame_cost_count = 0;
+            frame_sample_start = SDL_GetTicks();
+        }
+        setDynamicText(&frame_text, "Frame: %.2f ms | Redraws: %d", frame_cost_ms, status_text.renders);
+
+        // Lag is press to heard: the wait for the callback plus the buffer queued ahead of it
+        AudioStats audio_stats;
+        audioMonitorStats(&monitor, &audio_stats);
+        if (audio_stats.presses > 0)
+            setDynamicText(&latency_text, "Audio: %d | Lag: %.0f ms | Underruns: %d",
+                           audio_stats.bufferFrames, audio_stats.meanMs + audio_stats.periodMs, audio_stats.underruns);
+        else
+            setDynamicText(&latency_text, "Audio: %d | Lag: -- | Underruns: %d",
+                           audio_stats.bufferFrames, audio_stats.underruns);
+        profileEnd();
 
         // Render
+        profileBegin("render");
         SDL_SetRenderDrawColor(renderer, 0, 0, 50, 255);
         SDL_RenderClear(renderer);
 
-        drawText(renderer, &title, 10, 10);
-        drawText(renderer, &line1, 20, 50);
-        drawText(renderer, &line2, 20, 75);
-        drawText(renderer, &line3, 20, 100);
-        drawText(renderer, &line4, 20, 125);
-        drawText(renderer, &line5, 20, 150);
-        drawText(renderer, &line6, 20, 175);
-        drawText(renderer, &status_text, 10, 220);
+        drawAtlasText(renderer, &atlas, white, "PSP Audio Demo", 10, 10);
+        for (int i = 0; i < HELP_LINE_COUNT; i++)
+            drawAtlasText(renderer, &atlas, green, help_lines[i], 20, 50 + i * 25);
+        drawDynamicText(renderer, &latency_text, 10, 197);
+        drawDynamicText(renderer, &status_text, 10, 220);
+        drawDynamicText(renderer, &frame_text, 10, 245);
+        profileEnd();
 
+        profileBegin("hud");
+        drawProfilerOverlay(renderer, &overlay, SCREEN_WIDTH - 250, 10);
+        profileEnd();
+
+        profileBegin("present");
         SDL_RenderPresent(renderer);
+        profileEnd();
+
+        // Cost of input, update and render, excluding the frame delay
+        frame_cost_total += SDL_GetPerformanceCounter() - frame_start;
+        frame_cost_count++;
 
-        SDL_Delay(16); // ~60 FPS
+        if (!platformHeadless())
+            SDL_Delay(16); // ~60 FPS
+        profilerEndFrame();
+    }
+
+    if (platformProfileDumps())
+    {
+        profilerWriteCsv("profile.csv");
+        profilerWriteTrace("profile.json");
+    }
+    if (platformHeadless())
+    {
+        profilerPrintSummary(stdout);
+        audioMonitorPrintSummary(&monitor, stdout);
+        platformPrintSummary(stdout);
     }
 
     // Cleanup
-    freeText(&title);
-    freeText(&line1);
-    freeText(&line2);
-    freeText(&line3);
-    freeText(&line4);
-    freeText(&line5);
-    freeText(&line6);
-    freeText(&status_text);
+    freeProfilerOverlay(&overlay);
+    freeTextAtlas(&atlas);
+    freeDynamicText(&status_text);
+    freeDynamicText(&frame_text);
+    freeDynamicText(&latency_text);
 
     if (beep1)
         Mix_FreeChunk(beep1);
     if (beep2)
         Mix_FreeChunk(beep2);
-    if (music)
-        Mix_FreeMusic(music);
 
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
-    Mix_CloseAudio();
+    closeAudioMonitor(&monitor);
     TTF_Quit();
     SDL_Quit();
+    stopReplay();
     sceKernelExitGame();
 
     return 0;
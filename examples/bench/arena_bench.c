@@ -0,0 +1,212 @@
+/**
+ * Level arena benchmark
+ *
+ * Builds and frees maze3d levels over and over, the way the game does on
+ * every level load: a streaming world, its wall list, the four wall meshes
+ * and the visibility set, then a walk that moves the window a few times and
+ * rebuilds all of them. Each level is built twice, once from the heap with
+ * a malloc per buffer as before and once in a single LEVEL_ARENA_SIZE
+ * arena block, and the two are compared on time per level, heap calls per
+ * level and the heap held between levels, which must come back to the
+ * same figure after every arena level however many are cycled.
+ *
+ * Usage: arena_bench [--levels=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arena.h"
+#include "memory_stats.h"
+#include "world.h"
+
+/* As in maze3d/main.c */
+typedef struct {
+    float u, v;
+    float x, y, z;
+} MeshVertex;
+
+typedef struct {
+    Arena arena;
+    World world;
+    MeshVertex *meshes[4];   /* Brick, exit, visible brick, visible exit */
+    Visibility visibility;
+    unsigned char *runQueued;
+} Level;
+
+#define LEVEL_MAX_RUNS WORLD_MAX_WALLS   /* Every run holds at least one face */
+#define VISIBLE_MAX_RUNS 128
+
+#define LEVEL_ARENA_SIZE (sizeof(Level) + 4096 + \
+                          WORLD_MAX_WALLS * (2 * sizeof(Wall) + 2 * sizeof(int) + 1) + \
+                          LEVEL_MAX_RUNS * (6 * sizeof(MeshVertex) + 1) + \
+                          2 * VISIBLE_MAX_RUNS * 6 * sizeof(MeshVertex))
+
+/* The game's three levels and two far bigger ones; the window is the same size for all of them */
+static const struct { int width, height; } gSizes[] = {{5, 5}, {8, 8}, {12, 10}, {64, 64}, {1000, 1000}};
+
+#define SIZE_COUNT (int)(sizeof(gSizes) / sizeof(gSizes[0]))
+#define WALK_STEPS 6
+
+static int gMostWalls = 0;
+static int gMostRuns = 0;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *levelAlloc(Level *level, int useArena, size_t size)
+{
+    return useArena ? arenaAlloc(&level->arena, size) : malloc(size);
+}
+
+/* Meshes and visibility for the current window, as buildWallMeshes does */
+static int buildMeshes(Level *level, int useArena)
+{
+    const Maze *maze = &level->world.window;
+    int exitCount = 0;
+    for (int i = 0; i < maze->runCount; i++) {
+        if (maze->runs[i].isExit) exitCount++;
+    }
+    int brickCount = maze->runCount - exitCount;
+    int counts[4] = {brickCount, exitCount, brickCount < VISIBLE_MAX_RUNS ? brickCount : VISIBLE_MAX_RUNS,
+                     exitCount < VISIBLE_MAX_RUNS ? exitCount : VISIBLE_MAX_RUNS};
+    if (maze->wallCount > gMostWalls) gMostWalls = maze->wallCount;
+    if (maze->runCount > gMostRuns) gMostRuns = maze->runCount;
+
+    for (int m = 0; m < 4; m++) {
+        if (!useArena) free(level->meshes[m]);
+        level->meshes[m] = levelAlloc(level, useArena, (counts[m] ? counts[m] : 1) * 6 * sizeof(MeshVertex));
+        if (!level->meshes[m]) return -1;
+
+        /* Touch the storage, or the allocator's cost is all there is to time */
+        for (int i = 0; i < counts[m] * 6; i++) level->meshes[m][i].x = (float)i;
+    }
+
+    if (!useArena) free(level->runQueued);
+    level->runQueued = useArena ? arenaCalloc(&level->arena, maze->runCount + 1, 1) : calloc(maze->runCount + 1, 1);
+    if (!level->runQueued) return -1;
+
+    if (!useArena) freeVisibility(&level->visibility);
+    return initVisibility(&level->visibility, maze);
+}
+
+static void freeLevel(Level *level, int useArena)
+{
+    if (useArena) {
+        Arena arena = level->arena;
+        freeArena(&arena);
+        return;
+    }
+
+    freeWorld(&level->world);
+    freeVisibility(&level->visibility);
+    for (int m = 0; m < 4; m++) free(level->meshes[m]);
+    free(level->runQueued);
+    free(level);
+}
+
+/* Builds level n, walks it across a few chunks and frees it. Returns the arena's high-water mark, -1 on failure. */
+static long cycleLevel(int n, int useArena)
+{
+    int width = gSizes[n % SIZE_COUNT].width;
+    int height = gSizes[n % SIZE_COUNT].height;
+    Level *level;
+
+    if (useArena) {
+        Arena arena;
+        if (initArena(&arena, LEVEL_ARENA_SIZE) < 0) return -1;
+        level = arenaCalloc(&arena, 1, sizeof(Level));
+        if (!level) {
+            freeArena(&arena);
+            return -1;
+        }
+        level->arena = arena;
+    } else {
+        level = calloc(1, sizeof(Level));
+        if (!level) return -1;
+    }
+
+    int failed = initWorld(&level->world, width, height, (uint32_t)n * 7919u + 1, useArena ? &level->arena : NULL) < 0 ||
+                 updateWorld(&level->world, 1.5f, 1.5f) < 0 || buildMeshes(level, useArena) < 0;
+
+    /* Diagonally into the level, one chunk per step where the level has room, past the window's margin */
+    for (int step = 1; step <= WALK_STEPS && !failed; step++) {
+        float p = 1.5f + WORLD_WINDOW_MARGIN + step * WORLD_CHUNK_GRID;
+        int moved = updateWorld(&level->world, p, p);
+        failed = moved < 0 || (moved > 0 && buildMeshes(level, useArena) < 0);
+    }
+
+    long highWater = useArena ? (long)level->arena.highWater : 0;
+    if (useArena && level->arena.failures > 0) failed = 1;
+    freeLevel(level, useArena);
+    return failed ? -1 : highWater;
+}
+
+int main(int argc, char **argv)
+{
+    int levels = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--levels=", 9) == 0) levels = atoi(argv[i] + 9);
+    }
+    if (levels < 2 * SIZE_COUNT) levels = 2 * SIZE_COUNT;
+
+    printf("%d levels, %d walk steps each, arena %.1f KB (bound %d walls)%s\n", levels, WALK_STEPS,
+           LEVEL_ARENA_SIZE / 1024.0, WORLD_MAX_WALLS, memoryStatsAvailable() ? "" : ", no heap counters on this host");
+    printf("%-6s %10s %14s %12s %12s %12s %10s\n",
+           "path", "us/level", "heap/level", "held KB", "after KB", "peak KB", "arena KB");
+
+    int mismatches = 0;
+    for (int useArena = 0; useArena <= 1; useArena++) {
+        MemoryStats before, settled, after;
+        long highWater = 0;
+
+        /* One pass over every size first, so lazily allocated library state is already held */
+        for (int n = 0; n < SIZE_COUNT; n++) cycleLevel(n, useArena);
+        memoryStats(&settled);
+        resetMemoryPeak();
+
+        memoryStats(&before);
+        double t0 = nowSeconds();
+        for (int n = 0; n < levels; n++) {
+            long hw = cycleLevel(n, useArena);
+            if (hw < 0) {
+                printf("MISMATCH: level %d (%dx%d) could not be built%s\n", n, gSizes[n % SIZE_COUNT].width,
+                       gSizes[n % SIZE_COUNT].height, useArena ? " in its arena" : "");
+                mismatches++;
+                break;
+            }
+            if (hw > highWater) highWater = hw;
+        }
+        double elapsed = nowSeconds() - t0;
+        memoryStats(&after);
+
+        printf("%-6s %10.1f %14.1f %12.1f %12.1f %12.1f %10.1f\n", useArena ? "arena" : "heap",
+               elapsed * 1e6 / levels, (double)(after.allocations - before.allocations) / levels,
+               settled.bytes / 1024.0, after.bytes / 1024.0, after.peakBytes / 1024.0, highWater / 1024.0);
+
+        if (after.bytes != settled.bytes) {
+            printf("MISMATCH: the heap held %lld bytes more after %d %s levels\n", after.bytes - settled.bytes, levels,
+                   useArena ? "arena" : "heap");
+            mismatches++;
+        }
+    }
+
+    printf("most walls in one window: %d of %d, most runs: %d of %d\n", gMostWalls, WORLD_MAX_WALLS, gMostRuns,
+           LEVEL_MAX_RUNS);
+    if (gMostWalls > WORLD_MAX_WALLS) {
+        printf("MISMATCH: WORLD_MAX_WALLS is too small\n");
+        mismatches++;
+    }
+    if (gMostRuns > LEVEL_MAX_RUNS) {
+        printf("MISMATCH: LEVEL_MAX_RUNS is too small\n");
+        mismatches++;
+    }
+    return mismatches ? 1 : 0;
+}
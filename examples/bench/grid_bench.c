@@ -0,0 +1,328 @@
+/**
+ * Maze grid layout benchmark
+ *
+ * Compares the original maze3d grid (one int per cell, generated with a
+ * two-int MazeCell scratch array and an explicit backtracking stack) with
+ * the 2-bit packed grid in examples/maze3d/maze.c. For each maze size it
+ * reports the memory needed to generate and hold the grid, generation time
+ * and isWall/collision query throughput, and checks both layouts produce
+ * the same maze.
+ *
+ * Usage: grid_bench [--queries=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "maze.h"
+
+#define PLAYER_RADIUS 0.2f
+
+static const int gSizes[] = {64, 256, 1024, 2048};
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ============== Legacy layout (copied from the original maze3d) ============== */
+
+#define WALL_N 1
+#define WALL_E 2
+#define WALL_S 4
+#define WALL_W 8
+
+typedef struct {
+    int walls;
+    int visited;
+} MazeCell;
+
+typedef struct {
+    int *grid;
+    int gridWidth;
+    int gridHeight;
+    size_t scratchBytes;
+} LegacyMaze;
+
+static int legacyGenerate(LegacyMaze *maze, int width, int height, uint32_t seed)
+{
+    MazeCell *cells = malloc((size_t)width * height * sizeof(MazeCell));
+    if (!cells) return -1;
+
+    for (int i = 0; i < width * height; i++) {
+        cells[i].walls = WALL_N | WALL_E | WALL_S | WALL_W;
+        cells[i].visited = 0;
+    }
+
+    typedef struct { int x, y; } Pos;
+    Pos *stack = malloc((size_t)width * height * sizeof(Pos));
+    if (!stack) {
+        free(cells);
+        return -1;
+    }
+    int stackTop = 0;
+
+    /* Same generator as maze.c so both layouts carve the same maze */
+    uint32_t random = seed ? seed : 0x9E3779B9u;
+    int cx = 0, cy = 0;
+    cells[0].visited = 1;
+
+    int visited = 1;
+    int total = width * height;
+
+    while (visited < total) {
+        Pos neighbors[4];
+        int dirs[4];
+        int count = 0;
+
+        if (cy > 0 && !cells[(cy - 1) * width + cx].visited) {
+            neighbors[count] = (Pos){cx, cy - 1};
+            dirs[count++] = 0;
+        }
+        if (cx < width - 1 && !cells[cy * width + cx + 1].visited) {
+            neighbors[count] = (Pos){cx + 1, cy};
+            dirs[count++] = 1;
+        }
+        if (cy < height - 1 && !cells[(cy + 1) * width + cx].visited) {
+            neighbors[count] = (Pos){cx, cy + 1};
+            dirs[count++] = 2;
+        }
+        if (cx > 0 && !cells[cy * width + cx - 1].visited) {
+            neighbors[count] = (Pos){cx - 1, cy};
+            dirs[count++] = 3;
+        }
+
+        if (count > 0) {
+            int choice = mazeRandom(&random) % count;
+            Pos next = neighbors[choice];
+
+            switch (dirs[choice]) {
+                case 0:
+                    cells[cy * width + cx].walls &= ~WALL_N;
+                    cells[next.y * width + next.x].walls &= ~WALL_S;
+                    break;
+                case 1:
+                    cells[cy * width + cx].walls &= ~WALL_E;
+                    cells[next.y * width + next.x].walls &= ~WALL_W;
+                    break;
+                case 2:
+                    cells[cy * width + cx].walls &= ~WALL_S;
+                    cells[next.y * width + next.x].walls &= ~WALL_N;
+                    break;
+                case 3:
+                    cells[cy * width + cx].walls &= ~WALL_W;
+                    cells[next.y * width + next.x].walls &= ~WALL_E;
+                    break;
+            }
+
+            stack[stackTop++] = (Pos){cx, cy};
+            cx = next.x;
+            cy = next.y;
+            cells[cy * width + cx].visited = 1;
+            visited++;
+        } else {
+            stackTop--;
+            cx = stack[stackTop].x;
+            cy = stack[stackTop].y;
+        }
+    }
+
+    maze->gridWidth = width * 2 + 1;
+    maze->gridHeight = height * 2 + 1;
+    maze->scratchBytes = (size_t)width * height * (sizeof(MazeCell) + sizeof(Pos));
+
+    int gridCells = maze->gridWidth * maze->gridHeight;
+    maze->grid = malloc((size_t)gridCells * sizeof(int));
+    if (!maze->grid) {
+        free(cells);
+        free(stack);
+        return -1;
+    }
+
+    for (int i = 0; i < gridCells; i++) {
+        maze->grid[i] = CELL_WALL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int gx = x * 2 + 1;
+            int gy = y * 2 + 1;
+            int gw = maze->gridWidth;
+
+            if (x == width - 1 && y == height - 1) {
+                maze->grid[gy * gw + gx] = CELL_EXIT;
+            } else {
+                maze->grid[gy * gw + gx] = CELL_OPEN;
+            }
+
+            MazeCell *cell = &cells[y * width + x];
+            if (!(cell->walls & WALL_E) && x < width - 1) {
+                maze->grid[gy * gw + gx + 1] = CELL_OPEN;
+            }
+            if (!(cell->walls & WALL_S) && y < height - 1) {
+                maze->grid[(gy + 1) * gw + gx] = CELL_OPEN;
+            }
+        }
+    }
+
+    free(cells);
+    free(stack);
+    return 0;
+}
+
+static int legacyIsWall(const LegacyMaze *maze, int x, int y)
+{
+    if (x < 0 || x >= maze->gridWidth || y < 0 || y >= maze->gridHeight) return 1;
+    return maze->grid[y * maze->gridWidth + x] == CELL_WALL;
+}
+
+static int legacyCheckCollision(const LegacyMaze *maze, float x, float y, float radius)
+{
+    int minX = (int)(x - radius);
+    int maxX = (int)(x + radius);
+    int minY = (int)(y - radius);
+    int maxY = (int)(y + radius);
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            if (legacyIsWall(maze, cx, cy)) {
+                float closestX = fmaxf((float)cx, fminf(x, (float)(cx + 1)));
+                float closestY = fmaxf((float)cy, fminf(y, (float)(cy + 1)));
+                float dx = x - closestX;
+                float dy = y - closestY;
+                if (dx * dx + dy * dy < radius * radius) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* ============== Benchmark ============== */
+
+typedef struct {
+    int *cellX, *cellY;
+    float *posX, *posY;
+} Queries;
+
+static void makeQueries(Queries *q, int count, int gw, int gh)
+{
+    q->cellX = malloc(count * sizeof(int));
+    q->cellY = malloc(count * sizeof(int));
+    q->posX = malloc(count * sizeof(float));
+    q->posY = malloc(count * sizeof(float));
+
+    for (int i = 0; i < count; i++) {
+        q->cellX[i] = rand() % gw;
+        q->cellY[i] = rand() % gh;
+        q->posX[i] = q->cellX[i] + (rand() % 1000) / 1000.0f;
+        q->posY[i] = q->cellY[i] + (rand() % 1000) / 1000.0f;
+    }
+}
+
+static void freeQueries(Queries *q)
+{
+    free(q->cellX);
+    free(q->cellY);
+    free(q->posX);
+    free(q->posY);
+}
+
+int main(int argc, char **argv)
+{
+    int queries = 4000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--queries=", 10) == 0) queries = atoi(argv[i] + 10);
+    }
+    if (queries < 1) queries = 1;
+
+    srand(1234);
+
+    printf("%d queries per test, sizes in maze cells\n", queries);
+    printf("%-10s %-7s %10s %10s %9s %12s %12s\n",
+           "size", "layout", "grid KB", "peak KB", "gen ms", "isWall M/s", "collide M/s");
+
+    for (size_t s = 0; s < sizeof(gSizes) / sizeof(gSizes[0]); s++) {
+        int n = gSizes[s];
+        unsigned seed = 1234u + (unsigned)s;
+
+        LegacyMaze legacy = {0};
+        double t0 = nowSeconds();
+        if (legacyGenerate(&legacy, n, n, seed) < 0) {
+            fprintf(stderr, "legacy %dx%d: out of memory\n", n, n);
+            return 1;
+        }
+        double legacyGen = nowSeconds() - t0;
+
+        Maze packed = {0};
+        t0 = nowSeconds();
+        if (generateMazeGrid(&packed, n, n, seed) < 0) {
+            fprintf(stderr, "packed %dx%d: out of memory\n", n, n);
+            return 1;
+        }
+        double packedGen = nowSeconds() - t0;
+
+        int gw = packed.gridWidth;
+        int gh = packed.gridHeight;
+        int mismatches = 0;
+        for (int y = 0; y < gh; y++) {
+            for (int x = 0; x < gw; x++) {
+                if (legacy.grid[y * gw + x] != mazeCell(&packed, x, y)) mismatches++;
+            }
+        }
+
+        Queries q;
+        makeQueries(&q, queries, gw, gh);
+
+        /* Sums keep the compiler from dropping the query loops */
+        long legacyWalls = 0, packedWalls = 0;
+        long legacyHits = 0, packedHits = 0;
+
+        t0 = nowSeconds();
+        for (int i = 0; i < queries; i++) legacyWalls += legacyIsWall(&legacy, q.cellX[i], q.cellY[i]);
+        double legacyWallTime = nowSeconds() - t0;
+
+        t0 = nowSeconds();
+        for (int i = 0; i < queries; i++) packedWalls += mazeIsWall(&packed, q.cellX[i], q.cellY[i]);
+        double packedWallTime = nowSeconds() - t0;
+
+        t0 = nowSeconds();
+        for (int i = 0; i < queries; i++) legacyHits += legacyCheckCollision(&legacy, q.posX[i], q.posY[i], PLAYER_RADIUS);
+        double legacyCollideTime = nowSeconds() - t0;
+
+        t0 = nowSeconds();
+        for (int i = 0; i < queries; i++) packedHits += mazeCheckCollision(&packed, q.posX[i], q.posY[i], PLAYER_RADIUS);
+        double packedCollideTime = nowSeconds() - t0;
+
+        if (legacyWalls != packedWalls || legacyHits != packedHits) mismatches++;
+
+        size_t legacyGrid = (size_t)gw * gh * sizeof(int);
+        size_t packedGrid = (size_t)packed.wordsPerRow * gh * sizeof(uint32_t);
+        /* Both generators hold their scratch and the grid at the same time */
+        size_t legacyPeak = legacy.scratchBytes + legacyGrid;
+        size_t packedPeak = ((size_t)n * n + 3) / 4 + packedGrid;
+
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", n, n);
+        printf("%-10s %-7s %10zu %10zu %9.1f %12.1f %12.1f\n",
+               label, "int", legacyGrid / 1024, legacyPeak / 1024, legacyGen * 1000.0,
+               queries / legacyWallTime * 1e-6, queries / legacyCollideTime * 1e-6);
+        printf("%-10s %-7s %10zu %10zu %9.1f %12.1f %12.1f %s\n",
+               "", "packed", packedGrid / 1024, packedPeak / 1024, packedGen * 1000.0,
+               queries / packedWallTime * 1e-6, queries / packedCollideTime * 1e-6,
+               mismatches ? "MISMATCH" : "");
+
+        freeQueries(&q);
+        free(legacy.grid);
+        freeMaze(&packed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+/**
+ * Pad input benchmark
+ *
+ * Replays a recorded pad stream, one sample every 5.5 ms as the controller
+ * service takes them, into three readers running at a game's frame rate:
+ *
+ * - flag: one sample per frame and one debounce flag for the whole pad, the
+ *   first button of an if/else chain wins (what the examples used to do)
+ * - poll: one sample per frame, edges per button
+ * - input: examples/common/input.c reading every buffered sample
+ *
+ * The recording is scripted from a seed: taps of 5 to 170 ms on the face
+ * buttons, D-pad and shoulders, some of them chords, with pauses between.
+ * Each reader's presses are compared with the presses in the recording.
+ * Latency is from the sample where a button went down to the frame that
+ * saw it. Frame times jitter by 20%, and some runs add a long frame every
+ * few seconds like a level load.
+ *
+ * Usage: input_bench [--seconds=N] [--seed=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "input.h"
+
+#define MAX_BUTTONS 10
+
+static const unsigned int buttonBits[MAX_BUTTONS] = {
+    PSP_CTRL_CROSS, PSP_CTRL_CIRCLE, PSP_CTRL_SQUARE, PSP_CTRL_TRIANGLE, PSP_CTRL_UP,
+    PSP_CTRL_DOWN, PSP_CTRL_LEFT, PSP_CTRL_RIGHT, PSP_CTRL_LTRIGGER, PSP_CTRL_RTRIGGER};
+
+typedef struct
+{
+    const char *name;
+    double frameMs;
+    double hitchMs; // Extra time on every hitchEvery'th frame
+    int hitchEvery;
+} Scenario;
+
+typedef struct
+{
+    unsigned int button;
+    unsigned int time;
+} Press;
+
+typedef struct
+{
+    int presses;
+    int missed;
+    double totalMs;
+    double maxMs;
+} ReaderStats;
+
+static unsigned int gRandom = 0x2545F491u;
+
+static unsigned int nextRandom(void)
+{
+    gRandom ^= gRandom << 13;
+    gRandom ^= gRandom >> 17;
+    gRandom ^= gRandom << 5;
+    return gRandom;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int tapSamples(void)
+{
+    // A tenth are a single sample, shorter than any frame
+    if (nextRandom() % 10 == 0)
+        return 1;
+    return 2 + nextRandom() % 30;
+}
+
+static void recordStream(SceCtrlData *out, int count)
+{
+    int remaining[MAX_BUTTONS] = {0};
+    unsigned int held = 0;
+    int gap = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        for (int b = 0; b < MAX_BUTTONS; b++)
+        {
+            if (remaining[b] > 0 && --remaining[b] == 0)
+                held &= ~buttonBits[b];
+        }
+
+        if (held == 0 && gap-- <= 0)
+        {
+            int b = nextRandom() % MAX_BUTTONS;
+            remaining[b] = tapSamples();
+            held |= buttonBits[b];
+
+            // A quarter are chords with a second button
+            if (nextRandom() % 4 == 0)
+            {
+                int c = (b + 1 + nextRandom() % (MAX_BUTTONS - 1)) % MAX_BUTTONS;
+                remaining[c] = tapSamples();
+                held |= buttonBits[c];
+            }
+            gap = 2 + nextRandom() % 40;
+        }
+
+        memset(&out[i], 0, sizeof(out[i]));
+        out[i].TimeStamp = (unsigned int)(i + 1) * INPUT_SAMPLING_CYCLE;
+        out[i].Buttons = held;
+        out[i].Lx = 128;
+        out[i].Ly = 128;
+    }
+}
+
+// The recording's presses in the order the input module reports them: by sample, then lowest bit first
+static int listPresses(const SceCtrlData *stream, int count, Press *out)
+{
+    int n = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int down = stream[i].Buttons & ~(i ? stream[i - 1].Buttons : 0);
+        while (down)
+        {
+            out[n].button = down & -down;
+            out[n].time = stream[i].TimeStamp;
+            n++;
+            down &= down - 1;
+        }
+    }
+
+    return n;
+}
+
+static void addPress(ReaderStats *stats, double frameUs, unsigned int pressUs)
+{
+    double ms = (frameUs - pressUs) / 1000.0;
+
+    stats->presses++;
+    stats->totalMs += ms;
+    if (ms > stats->maxMs)
+        stats->maxMs = ms;
+}
+
+static void printReader(const char *name, const ReaderStats *stats, int overflows)
+{
+    printf("  %-6s %8d %8d %10.1f %10.1f", name, stats->presses, stats->missed,
+           stats->presses ? stats->totalMs / stats->presses : 0.0, stats->maxMs);
+    if (overflows >= 0)
+        printf(" %10d", overflows);
+    printf("\n");
+}
+
+// Returns 0 if the buffered reader saw exactly the recording's presses whenever its buffers kept up
+static int runScenario(const Scenario *scenario, const SceCtrlData *stream, int count, const Press *truth, int truthCount)
+{
+    static Input input;
+    ReaderStats flag = {0}, poll = {0}, buffered = {0};
+    unsigned int lastDown[MAX_BUTTONS] = {0};
+    unsigned int pollOld = 0;
+    int flagDown = 0;
+    int available = 0; // Samples taken by the frame time
+    int checked = 0;   // Recorded presses matched against the events so far
+    int frames = 0;
+    int failed = 0;
+    double longestMs = 0;
+    double updateSeconds = 0;
+    double time = 0; // Microseconds
+
+    // Started before the recording, as initInput and a first update are before any press
+    SceCtrlData idle = {0};
+    idle.Lx = 128;
+    idle.Ly = 128;
+    memset(&input, 0, sizeof(input));
+    feedInput(&input, &idle, 1);
+    gRandom = 0x9E3779B9u;
+
+    while (available < count)
+    {
+        double frameMs = scenario->frameMs * (0.8 + 0.4 * (nextRandom() % 1000) / 1000.0);
+        if (scenario->hitchEvery > 0 && frames % scenario->hitchEvery == scenario->hitchEvery - 1)
+            frameMs += scenario->hitchMs;
+        if (frameMs > longestMs)
+            longestMs = frameMs;
+        time += frameMs * 1000.0;
+        frames++;
+
+        while (available < count && stream[available].TimeStamp <= time)
+        {
+            unsigned int down = stream[available].Buttons & ~(available ? stream[available - 1].Buttons : 0);
+            for (int b = 0; b < MAX_BUTTONS; b++)
+            {
+                if (down & buttonBits[b])
+                    lastDown[b] = stream[available].TimeStamp;
+            }
+            available++;
+        }
+        if (available == 0)
+            continue;
+
+        const SceCtrlData *newest = &stream[available - 1];
+
+        // flag: any button sets the flag, the first in the chain is taken
+        if (newest->Buttons)
+        {
+            if (!flagDown)
+            {
+                for (int b = 0; b < MAX_BUTTONS; b++)
+                {
+                    if (newest->Buttons & buttonBits[b])
+                    {
+                        addPress(&flag, time, lastDown[b]);
+                        break;
+                    }
+                }
+                flagDown = 1;
+            }
+        }
+        else
+        {
+            flagDown = 0;
+        }
+
+        // poll: edges per button between frames
+        unsigned int pressed = newest->Buttons & ~pollOld;
+        for (int b = 0; b < MAX_BUTTONS; b++)
+        {
+            if (pressed & buttonBits[b])
+                addPress(&poll, time, lastDown[b]);
+        }
+        pollOld = newest->Buttons;
+
+        // input: the newest INPUT_BUFFERS samples, as sceCtrlReadBufferPositive returns them
+        int buffers = available < INPUT_BUFFERS ? available : INPUT_BUFFERS;
+        double start = nowSeconds();
+        feedInput(&input, &stream[available - buffers], buffers);
+        updateSeconds += nowSeconds() - start;
+
+        InputEvent event;
+        while (nextInputEvent(&input, &event))
+        {
+            if (!event.down)
+                continue;
+            addPress(&buffered, time, event.time);
+
+            // Each press must be the next one in the recording, at the sample it happened
+            if (input.overflows == 0 && !failed)
+            {
+                const Press *expected = checked < truthCount ? &truth[checked] : NULL;
+                if (!expected || expected->button != event.button || expected->time != event.time)
+                {
+                    printf("MISMATCH: %s press %d: button %#x at %u us, recording has %#x at %u us\n",
+                           scenario->name, checked, event.button, event.time,
+                           expected ? expected->button : 0, expected ? expected->time : 0);
+                    failed = 1;
+                }
+                checked++;
+            }
+        }
+    }
+
+    flag.missed = truthCount - flag.presses;
+    poll.missed = truthCount - poll.presses;
+    buffered.missed = truthCount - buffered.presses;
+
+    printf("%s: %d frames, longest %.0f ms, %.0f ns per input update\n", scenario->name, frames, longestMs,
+           updateSeconds * 1e9 / frames);
+    printf("  %-6s %8s %8s %10s %10s %10s\n", "reader", "presses", "missed", "mean ms", "max ms", "overflows");
+    printReader("flag", &flag, -1);
+    printReader("poll", &poll, -1);
+    printReader("input", &buffered, input.overflows);
+
+    // Buffers covering the longest frame must catch every press
+    if (longestMs * 1000.0 < (INPUT_BUFFERS - 1) * INPUT_SAMPLING_CYCLE && (input.overflows || buffered.missed))
+    {
+        printf("MISMATCH: %s: %d overflows, %d presses missed with %.0f ms of buffers\n", scenario->name,
+               input.overflows, buffered.missed, INPUT_BUFFERS * INPUT_SAMPLING_CYCLE / 1000.0);
+        failed = 1;
+    }
+
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = 600;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--seconds=", 10) == 0)
+            seconds = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--seed=", 7) == 0)
+            seed = (unsigned int)strtoul(argv[i] + 7, NULL, 10);
+    }
+    if (seconds < 1)
+        seconds = 1;
+
+    static const Scenario scenarios[] = {
+        {"60 fps", 16.7, 0, 0},
+        {"30 fps", 33.3, 0, 0},
+        {"20 fps", 50.0, 0, 0},
+        {"30 fps, 250 ms every 5 s", 33.3, 250, 150},
+        {"30 fps, 500 ms every 5 s", 33.3, 500, 150},
+    };
+
+    int count = (int)((long long)seconds * 1000000 / INPUT_SAMPLING_CYCLE);
+    SceCtrlData *stream = malloc(count * sizeof(SceCtrlData));
+    Press *truth = malloc(count * sizeof(Press) * 2);
+    if (!stream || !truth)
+        return 1;
+
+    gRandom ^= seed * 0x9E3779B9u;
+    if (gRandom == 0)
+        gRandom = 1;
+    recordStream(stream, count);
+    int truthCount = listPresses(stream, count, truth);
+    printf("recording: %d s, %d samples every %.1f ms, %d presses\n\n", seconds, count,
+           INPUT_SAMPLING_CYCLE / 1000.0, truthCount);
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        if (runScenario(&scenarios[i], stream, count, truth, truthCount) != 0)
+            failed = 1;
+        printf("\n");
+    }
+
+    free(stream);
+    free(truth);
+    return failed;
+}
@@ -0,0 +1,235 @@
+/**
+ * Trigonometry and vertex transform benchmark
+ *
+ * Checks the table-driven sin/cos and the composed rotation matrices in
+ * examples/common/fast_math.c against libm, then measures vertices
+ * transformed per second for the original cube3d path (rotateX, rotateY and
+ * rotateZ with sinf/cosf per vertex), the float matrix and the 16.16 matrix.
+ * Exits with 1 if any error exceeds its limit.
+ *
+ * Usage: math_bench [--vertices=N] [--frames=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "fast_math.h"
+
+#define SIN_LIMIT 1e-5
+#define MATRIX_LIMIT 1e-4   // Per unit of vertex distance from the origin
+#define FIXED_LIMIT 5e-4
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float randomFloat(unsigned int *state, float lo, float hi)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((*state >> 8) / 16777216.0f);
+}
+
+/* ============== Reference path (copied from cube3d) ============== */
+
+static Vec3 rotateX(Vec3 v, float angle)
+{
+    Vec3 result;
+    result.x = v.x;
+    result.y = v.y * cosf(angle) - v.z * sinf(angle);
+    result.z = v.y * sinf(angle) + v.z * cosf(angle);
+    return result;
+}
+
+static Vec3 rotateY(Vec3 v, float angle)
+{
+    Vec3 result;
+    result.x = v.x * cosf(angle) + v.z * sinf(angle);
+    result.y = v.y;
+    result.z = -v.x * sinf(angle) + v.z * cosf(angle);
+    return result;
+}
+
+static Vec3 rotateZ(Vec3 v, float angle)
+{
+    Vec3 result;
+    result.x = v.x * cosf(angle) - v.y * sinf(angle);
+    result.y = v.x * sinf(angle) + v.y * cosf(angle);
+    result.z = v.z;
+    return result;
+}
+
+/* ============== Accuracy ============== */
+
+static int checkTrig(void)
+{
+    unsigned int random = 1;
+    double sinErr = 0, cosErr = 0, fixedErr = 0;
+
+    for (int i = 0; i < 1000000; i++)
+    {
+        // Cover negative angles and the many turns a long-running spin accumulates
+        float a = randomFloat(&random, -100.0f, 100.0f);
+        double s = sin(a);
+        double c = cos(a);
+
+        sinErr = fmax(sinErr, fabs(fastSin(a) - s));
+        cosErr = fmax(cosErr, fabs(fastCos(a) - c));
+
+        uint32_t angle = fixedAngle(a);
+        fixedErr = fmax(fixedErr, fabs(fixedToFloat(fixedSin(angle)) - s));
+        fixedErr = fmax(fixedErr, fabs(fixedToFloat(fixedCos(angle)) - c));
+    }
+
+    int ok = sinErr < SIN_LIMIT && cosErr < SIN_LIMIT && fixedErr < FIXED_LIMIT;
+    printf("%-22s %12.3g\n", "fastSin max error", sinErr);
+    printf("%-22s %12.3g\n", "fastCos max error", cosErr);
+    printf("%-22s %12.3g\n", "fixed sin/cos error", fixedErr);
+    return ok;
+}
+
+static int checkMatrices(void)
+{
+    unsigned int random = 2;
+    double floatErr = 0, fixedErr = 0;
+
+    for (int i = 0; i < 100000; i++)
+    {
+        float ax = randomFloat(&random, -20.0f, 20.0f);
+        float ay = randomFloat(&random, -20.0f, 20.0f);
+        float az = randomFloat(&random, -20.0f, 20.0f);
+        Vec3 v = {randomFloat(&random, -1, 1), randomFloat(&random, -1, 1), randomFloat(&random, -1, 1)};
+
+        Vec3 expected = rotateZ(rotateY(rotateX(v, ax), ay), az);
+
+        Mat3 m;
+        mat3RotationXYZ(&m, ax, ay, az);
+        Vec3 got = mat3Transform(&m, v);
+        floatErr = fmax(floatErr, fabs(got.x - expected.x));
+        floatErr = fmax(floatErr, fabs(got.y - expected.y));
+        floatErr = fmax(floatErr, fabs(got.z - expected.z));
+
+        Mat3Fixed mf;
+        mat3FixedRotationXYZ(&mf, fixedAngle(ax), fixedAngle(ay), fixedAngle(az));
+        Vec3Fixed vf = {fixedFromFloat(v.x), fixedFromFloat(v.y), fixedFromFloat(v.z)};
+        Vec3Fixed gf = mat3FixedTransform(&mf, vf);
+        fixedErr = fmax(fixedErr, fabs(fixedToFloat(gf.x) - expected.x));
+        fixedErr = fmax(fixedErr, fabs(fixedToFloat(gf.y) - expected.y));
+        fixedErr = fmax(fixedErr, fabs(fixedToFloat(gf.z) - expected.z));
+    }
+
+    // The fixed path quantises the angle to 1/65536 of a turn on top of the table error
+    int ok = floatErr < MATRIX_LIMIT && fixedErr < FIXED_LIMIT * 8;
+    printf("%-22s %12.3g\n", "matrix max error", floatErr);
+    printf("%-22s %12.3g\n", "fixed matrix error", fixedErr);
+    return ok;
+}
+
+/* ============== Throughput ============== */
+
+typedef struct
+{
+    const char *name;
+    double seconds;
+    double checksum;
+} Timing;
+
+static void report(const Timing *t, long vertices, double baseline)
+{
+    double rate = vertices / t->seconds;
+    printf("%-22s %10.1f M/s %8.2fx   (checksum %.3f)\n", t->name, rate / 1e6, baseline / t->seconds, t->checksum);
+}
+
+int main(int argc, char **argv)
+{
+    int count = 8;
+    int frames = 200000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--vertices=", 11) == 0)
+            count = atoi(argv[i] + 11);
+        else if (strncmp(argv[i], "--frames=", 9) == 0)
+            frames = atoi(argv[i] + 9);
+    }
+    if (count < 1 || frames < 1)
+        return 1;
+
+    initFastMath();
+
+    printf("== accuracy vs libm\n");
+    int ok = checkTrig();
+    ok &= checkMatrices();
+
+    Vec3 *in = malloc(count * sizeof(Vec3));
+    Vec3Fixed *inFixed = malloc(count * sizeof(Vec3Fixed));
+    if (!in || !inFixed)
+        return 1;
+
+    unsigned int random = 3;
+    for (int i = 0; i < count; i++)
+    {
+        in[i] = (Vec3){randomFloat(&random, -50, 50), randomFloat(&random, -50, 50), randomFloat(&random, -50, 50)};
+        inFixed[i] = (Vec3Fixed){fixedFromFloat(in[i].x), fixedFromFloat(in[i].y), fixedFromFloat(in[i].z)};
+    }
+
+    long total = (long)count * frames;
+    printf("\n== %d vertices x %d frames\n", count, frames);
+
+    // Each frame advances the angles like cube3d does per tick; the checksum keeps the work alive
+    Timing reference = {"sinf/cosf per vertex", 0, 0};
+    double t0 = nowSeconds();
+    for (int f = 0; f < frames; f++)
+    {
+        float ax = f * 0.02f, ay = f * 0.025f, az = f * 0.015f;
+        for (int i = 0; i < count; i++)
+        {
+            Vec3 r = rotateZ(rotateY(rotateX(in[i], ax), ay), az);
+            reference.checksum += r.x;
+        }
+    }
+    reference.seconds = nowSeconds() - t0;
+
+    Timing matrix = {"table + Mat3", 0, 0};
+    t0 = nowSeconds();
+    for (int f = 0; f < frames; f++)
+    {
+        Mat3 m;
+        mat3RotationXYZ(&m, f * 0.02f, f * 0.025f, f * 0.015f);
+        for (int i = 0; i < count; i++)
+        {
+            Vec3 r = mat3Transform(&m, in[i]);
+            matrix.checksum += r.x;
+        }
+    }
+    matrix.seconds = nowSeconds() - t0;
+
+    Timing fixed = {"16.16 Mat3Fixed", 0, 0};
+    t0 = nowSeconds();
+    for (int f = 0; f < frames; f++)
+    {
+        Mat3Fixed m;
+        mat3FixedRotationXYZ(&m, fixedAngle(f * 0.02f), fixedAngle(f * 0.025f), fixedAngle(f * 0.015f));
+        int64_t sum = 0;
+        for (int i = 0; i < count; i++)
+            sum += mat3FixedTransform(&m, inFixed[i]).x;
+        fixed.checksum += (double)sum / FIXED_ONE;
+    }
+    fixed.seconds = nowSeconds() - t0;
+
+    double baseline = reference.seconds;
+    report(&reference, total, baseline);
+    report(&matrix, total, baseline);
+    report(&fixed, total, baseline);
+
+    free(in);
+    free(inFixed);
+
+    printf("\n%s\n", ok ? "accuracy OK" : "ACCURACY FAILURE");
+    return ok ? 0 : 1;
+}
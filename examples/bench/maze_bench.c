@@ -0,0 +1,156 @@
+/**
+ * Maze visibility culling benchmark
+ *
+ * Generates mazes of increasing size, drops the player at random open cells
+ * facing random directions and runs the maze3d ray-fan visibility pass.
+ * Reports walls submitted with and without culling, the cost of the pass,
+ * and how many walls a brute-force line-of-sight reference can see that the
+ * culled set left out.
+ *
+ * Usage: maze_bench [--views=N] [--rays=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "maze.h"
+
+/* Must match the constants in examples/maze3d/main.c */
+#define FOG_END 15.0f
+#define CULL_FOV 1.75f
+#define CULL_RAYS 240
+
+#define FACE_SAMPLES 9
+#define LOS_STEP 0.01f
+
+typedef struct {
+    int width, height;
+} MazeSize;
+
+static const MazeSize gSizes[] = {
+    {5, 5}, {8, 8}, {12, 10}, {32, 32}, {64, 64}, {128, 128}
+};
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Walks the segment in tiny steps; any wall cell on the way blocks the view */
+static int lineOfSight(const Maze *maze, float x0, float y0, float x1, float y1)
+{
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float len = sqrtf(dx * dx + dy * dy);
+    int steps = (int)(len / LOS_STEP);
+
+    for (int i = 1; i < steps; i++) {
+        float t = (float)i / steps;
+        if (mazeIsWall(maze, (int)floorf(x0 + dx * t), (int)floorf(y0 + dy * t))) return 0;
+    }
+    return 1;
+}
+
+static int referenceVisible(const Maze *maze, const Wall *w, float px, float py, float angle)
+{
+    /* Brick faces are seen from outside their cell, exit faces from inside theirs */
+    static const float normals[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    float nx = normals[w->side][0];
+    float ny = normals[w->side][1];
+    if (w->isExit) {
+        nx = -nx;
+        ny = -ny;
+    }
+
+    float viewX = cosf(angle);
+    float viewY = sinf(angle);
+    float halfFov = CULL_FOV * 0.5f;
+
+    for (int s = 0; s < FACE_SAMPLES; s++) {
+        float t = (s + 0.5f) / FACE_SAMPLES;
+        float sx = w->x1 + (w->x2 - w->x1) * t + nx * 1e-3f;
+        float sy = w->z1 + (w->z2 - w->z1) * t + ny * 1e-3f;
+        float dx = sx - px;
+        float dy = sy - py;
+        float depth = dx * viewX + dy * viewY;
+
+        if (depth <= 0 || depth > FOG_END) continue;
+        float offAxis = acosf(fminf(1.0f, depth / sqrtf(dx * dx + dy * dy)));
+        if (offAxis > halfFov) continue;
+        if (lineOfSight(maze, px, py, sx, sy)) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int views = 200;
+    int rays = CULL_RAYS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--views=", 8) == 0) views = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--rays=", 7) == 0) rays = atoi(argv[i] + 7);
+    }
+    if (views < 1) views = 1;
+
+    printf("%-9s %8s %10s %9s %10s %8s %8s\n",
+           "maze", "walls", "visible", "culled%", "us/pass", "missed", "extra");
+
+    for (size_t s = 0; s < sizeof(gSizes) / sizeof(gSizes[0]); s++) {
+        Maze maze;
+        Visibility vis;
+        memset(&maze, 0, sizeof(maze));
+        memset(&vis, 0, sizeof(vis));
+
+        srand(1234 + (unsigned int)s);
+        if (generateMaze(&maze, gSizes[s].width, gSizes[s].height, 1234 + (uint32_t)s) < 0 ||
+            initVisibility(&vis, &maze) < 0) {
+            fprintf(stderr, "out of memory at %dx%d\n", gSizes[s].width, gSizes[s].height);
+            return 1;
+        }
+
+        double passTime = 0;
+        long visibleTotal = 0;
+        long missed = 0;
+        long extra = 0;
+
+        for (int v = 0; v < views; v++) {
+            /* Random open cell, random heading */
+            float px, py;
+            do {
+                px = (float)(rand() % maze.gridWidth) + 0.5f;
+                py = (float)(rand() % maze.gridHeight) + 0.5f;
+            } while (mazeIsWall(&maze, (int)px, (int)py));
+            float angle = (float)rand() / RAND_MAX * 6.2831853f;
+
+            double t0 = nowSeconds();
+            computeVisibility(&vis, &maze, px, py, angle, CULL_FOV, FOG_END, rays);
+            passTime += nowSeconds() - t0;
+            visibleTotal += vis.count;
+
+            for (int i = 0; i < maze.wallCount; i++) {
+                int ref = referenceVisible(&maze, &maze.walls[i], px, py, angle);
+                if (ref && !vis.marked[i]) missed++;
+                if (!ref && vis.marked[i]) extra++;
+            }
+        }
+
+        char name[16];
+        snprintf(name, sizeof(name), "%dx%d", gSizes[s].width, gSizes[s].height);
+        double avgVisible = (double)visibleTotal / views;
+        printf("%-9s %8d %10.1f %8.1f%% %10.2f %8ld %8ld\n",
+               name, maze.wallCount, avgVisible,
+               100.0 * (1.0 - avgVisible / maze.wallCount),
+               passTime * 1e6 / views, missed, extra);
+
+        freeVisibility(&vis);
+        freeMaze(&maze);
+    }
+
+    return 0;
+}
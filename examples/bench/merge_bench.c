@@ -0,0 +1,272 @@
+/**
+ * Wall run merging benchmark
+ *
+ * Streams maze3d levels the way the game does and, for every window the
+ * walk passes through, compares the wall mesh built from unit faces (two
+ * triangles per cell side) with the one built from the merged runs
+ * buildMazeWalls now produces. Triangles are counted for the full window
+ * mesh and for the visible set of random views, where each visible face
+ * pulls in its whole run once.
+ *
+ * Every window is also checked for coverage: each unit of wall must be
+ * covered by exactly one run of the same side and kind, and every face
+ * must point at a run that contains it. Anything else is a MISMATCH.
+ *
+ * Usage: merge_bench [--views=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "world.h"
+
+/* Must match the constants in examples/maze3d/main.c */
+#define FOG_END 15.0f
+#define CULL_FOV 1.75f
+#define CULL_RAYS 240
+
+#define WALK_STEPS 6
+
+/* The game's three levels and two far bigger ones */
+static const struct { int width, height; } gSizes[] = {{5, 5}, {8, 8}, {12, 10}, {64, 64}, {1000, 1000}};
+
+#define SIZE_COUNT (int)(sizeof(gSizes) / sizeof(gSizes[0]))
+
+typedef struct {
+    int windows;
+    long faces;
+    long runs;
+    long longestRun;
+    long views;
+    long visibleFaces;
+    long visibleRuns;
+    int mostVisibleRuns;    /* Sizes VISIBLE_MAX_RUNS in maze3d/main.c */
+    double buildTime;
+} MergeTotals;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Unit segment a face or a run step occupies: N/S faces lie on the line
+ * z = const, W/E faces on x = const, and unit is the lower cell edge along it
+ */
+static int segmentIndex(const Maze *maze, int side, int line, int unit)
+{
+    int stride = (maze->gridWidth > maze->gridHeight ? maze->gridWidth : maze->gridHeight) + 1;
+    return (side * stride + line) * stride + unit;
+}
+
+/* Start of a wall along its line, its length in units and the direction from x1/z1 to x2/z2 */
+static void wallSpan(const Wall *w, int *line, int *start, int *length, int *direction)
+{
+    if (w->side <= FACE_SOUTH) {
+        *line = (int)w->z1;
+        *start = (int)fminf(w->x1, w->x2);
+        *length = (int)fabsf(w->x2 - w->x1);
+        *direction = w->x2 > w->x1 ? 1 : -1;
+    } else {
+        *line = (int)w->x1;
+        *start = (int)fminf(w->z1, w->z2);
+        *length = (int)fabsf(w->z2 - w->z1);
+        *direction = w->z2 > w->z1 ? 1 : -1;
+    }
+}
+
+/* Returns the number of problems found in the window's runs */
+static int checkCoverage(const Maze *maze, int *cover, signed char *kind)
+{
+    int stride = (maze->gridWidth > maze->gridHeight ? maze->gridWidth : maze->gridHeight) + 1;
+    int segments = 4 * stride * stride;
+    int problems = 0;
+
+    memset(cover, 0, segments * sizeof(int));
+    memset(kind, -1, segments);
+
+    for (int i = 0; i < maze->wallCount; i++) {
+        const Wall *w = &maze->walls[i];
+        int line, start, length, direction;
+        wallSpan(w, &line, &start, &length, &direction);
+
+        int s = segmentIndex(maze, w->side, line, start);
+        cover[s]++;
+        kind[s] = (signed char)w->isExit;
+
+        /* The face's run must hold it, facing the same way */
+        int r = maze->wallRuns[i];
+        int runLine, runStart, runLength, runDirection;
+        if (r < 0 || r >= maze->runCount) {
+            problems++;
+            continue;
+        }
+        const Wall *run = &maze->runs[r];
+        wallSpan(run, &runLine, &runStart, &runLength, &runDirection);
+        if (run->side != w->side || run->isExit != w->isExit || runLine != line || runDirection != direction ||
+            start < runStart || start >= runStart + runLength) {
+            problems++;
+        }
+    }
+
+    for (int r = 0; r < maze->runCount; r++) {
+        const Wall *run = &maze->runs[r];
+        int line, start, length, direction;
+        wallSpan(run, &line, &start, &length, &direction);
+
+        for (int u = start; u < start + length; u++) {
+            int s = segmentIndex(maze, run->side, line, u);
+            if (--cover[s] < 0 || kind[s] != run->isExit) problems++;
+        }
+    }
+
+    for (int s = 0; s < segments; s++) {
+        if (cover[s] != 0) problems++;
+    }
+    return problems;
+}
+
+/* Faces and distinct runs in the visible set of a random view in the window */
+static void sampleViews(const Maze *maze, Visibility *vis, unsigned char *runSeen, int views, MergeTotals *totals)
+{
+    for (int v = 0; v < views; v++) {
+        float px, py;
+        do {
+            px = (float)(rand() % maze->gridWidth) + 0.5f;
+            py = (float)(rand() % maze->gridHeight) + 0.5f;
+        } while (mazeIsWall(maze, (int)px, (int)py));
+        float angle = (float)rand() / RAND_MAX * 6.2831853f;
+
+        computeVisibility(vis, maze, px, py, angle, CULL_FOV, FOG_END, CULL_RAYS);
+        totals->visibleFaces += vis->count;
+        int runs = 0;
+        for (int i = 0; i < vis->count; i++) {
+            int run = maze->wallRuns[vis->walls[i]];
+            if (!runSeen[run]) runs++;
+            runSeen[run] = 1;
+        }
+        totals->visibleRuns += runs;
+        if (runs > totals->mostVisibleRuns) totals->mostVisibleRuns = runs;
+        for (int i = 0; i < vis->count; i++) runSeen[maze->wallRuns[vis->walls[i]]] = 0;
+        totals->views++;
+    }
+}
+
+/* Returns the number of problems, or -1 if the window could not be built */
+static int measureWindow(World *world, int views, MergeTotals *totals)
+{
+    const Maze *maze = &world->window;
+    int stride = (maze->gridWidth > maze->gridHeight ? maze->gridWidth : maze->gridHeight) + 1;
+    int *cover = malloc(4 * stride * stride * sizeof(int));
+    signed char *kind = malloc(4 * stride * stride);
+    unsigned char *runSeen = calloc(maze->runCount + 1, 1);
+    Visibility vis;
+    memset(&vis, 0, sizeof(vis));
+
+    if (!cover || !kind || !runSeen || initVisibility(&vis, maze) < 0) {
+        free(cover);
+        free(kind);
+        free(runSeen);
+        return -1;
+    }
+
+    /* Rebuild once more on its own, so the time is the wall list and the merge alone */
+    double t0 = nowSeconds();
+    int failed = buildMazeWalls(&world->window) < 0;
+    totals->buildTime += nowSeconds() - t0;
+
+    int problems = 0;
+    if (!failed) {
+        freeVisibility(&vis);
+        failed = initVisibility(&vis, maze) < 0;
+    }
+    if (!failed) {
+        problems = checkCoverage(maze, cover, kind);
+        sampleViews(maze, &vis, runSeen, views, totals);
+
+        totals->windows++;
+        totals->faces += maze->wallCount;
+        totals->runs += maze->runCount;
+        for (int r = 0; r < maze->runCount; r++) {
+            const Wall *run = &maze->runs[r];
+            long length = (long)(fabsf(run->x2 - run->x1) + fabsf(run->z2 - run->z1));
+            if (length > totals->longestRun) totals->longestRun = length;
+        }
+    }
+
+    freeVisibility(&vis);
+    free(cover);
+    free(kind);
+    free(runSeen);
+    return failed ? -1 : problems;
+}
+
+int main(int argc, char **argv)
+{
+    int views = 50;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--views=", 8) == 0) views = atoi(argv[i] + 8);
+    }
+    if (views < 1) views = 1;
+
+    printf("%d views per window, %d walk steps per level\n", views, WALK_STEPS);
+    printf("%-10s %8s %9s %9s %8s %7s %11s %11s %9s\n",
+           "level", "windows", "unit tris", "run tris", "saved%", "longest", "vis unit", "vis run", "us/build");
+
+    int mismatches = 0;
+    int mostVisibleRuns = 0;
+    for (int n = 0; n < SIZE_COUNT; n++) {
+        World world;
+        MergeTotals totals;
+        memset(&totals, 0, sizeof(totals));
+        srand(4321 + (unsigned int)n);
+
+        int failed = initWorld(&world, gSizes[n].width, gSizes[n].height, (uint32_t)n * 7919u + 1, NULL) < 0 ||
+                     updateWorld(&world, 1.5f, 1.5f) < 0;
+        int problems = failed ? 0 : measureWindow(&world, views, &totals);
+        failed = failed || problems < 0;
+
+        /* Diagonally into the level, one chunk per step where the level has room, past the window's margin */
+        for (int step = 1; step <= WALK_STEPS && !failed; step++) {
+            float p = 1.5f + WORLD_WINDOW_MARGIN + step * WORLD_CHUNK_GRID;
+            int moved = updateWorld(&world, p, p);
+            if (moved < 0) {
+                failed = 1;
+            } else if (moved > 0) {
+                int found = measureWindow(&world, views, &totals);
+                if (found < 0) failed = 1;
+                else problems += found;
+            }
+        }
+        freeWorld(&world);
+
+        if (failed) {
+            printf("MISMATCH: level %dx%d could not be built\n", gSizes[n].width, gSizes[n].height);
+            mismatches++;
+            continue;
+        }
+
+        char name[16];
+        snprintf(name, sizeof(name), "%dx%d", gSizes[n].width, gSizes[n].height);
+        double unitTris = 2.0 * totals.faces / totals.windows;
+        double runTris = 2.0 * totals.runs / totals.windows;
+        printf("%-10s %8d %9.0f %9.0f %7.1f%% %7ld %11.1f %11.1f %9.1f\n", name, totals.windows, unitTris, runTris,
+               100.0 * (1.0 - runTris / unitTris), totals.longestRun, 2.0 * totals.visibleFaces / totals.views,
+               2.0 * totals.visibleRuns / totals.views, totals.buildTime * 1e6 / totals.windows);
+
+        if (totals.mostVisibleRuns > mostVisibleRuns) mostVisibleRuns = totals.mostVisibleRuns;
+        if (problems > 0) {
+            printf("MISMATCH: %d wall segments of %s are not covered by exactly one matching run\n", problems, name);
+            mismatches++;
+        }
+    }
+
+    printf("most runs seen in one view: %d\n", mostVisibleRuns);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * Wireframe mesh loading benchmark
+ *
+ * Writes a torus as an OBJ file (quads with v//vn corners, as exporters
+ * emit them), then loads it three ways: parsing the text with edge
+ * deduplication, reading the binary cache into memory, and mapping the
+ * cache. Reports milliseconds per load and checks that all three give the
+ * same vertices, edges and triangles, and that every quad edge was kept
+ * exactly once.
+ *
+ * Usage: mesh_bench [--rings=N] [--runs=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "mesh.h"
+
+#define OBJ_PATH "mesh_bench.obj"
+#define CACHE_PATH "mesh_bench.obj.bin"
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// rings x rings grid wrapped both ways, so every vertex has exactly two edges of its own
+static int writeTorus(const char *path, int rings)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+
+    fprintf(f, "# mesh_bench torus, %d x %d\n", rings, rings);
+    for (int i = 0; i < rings; i++)
+    {
+        float u = 6.28318531f * i / rings;
+        for (int j = 0; j < rings; j++)
+        {
+            float v = 6.28318531f * j / rings;
+            float r = 2.0f + 0.75f * cosf(v);
+            fprintf(f, "v %.6f %.6f %.6f\n", r * cosf(u), 0.75f * sinf(v), r * sinf(u));
+        }
+    }
+    fprintf(f, "vn 0 1 0\n");
+
+    for (int i = 0; i < rings; i++)
+    {
+        for (int j = 0; j < rings; j++)
+        {
+            int a = i * rings + j + 1;
+            int b = i * rings + (j + 1) % rings + 1;
+            int c = ((i + 1) % rings) * rings + (j + 1) % rings + 1;
+            int d = ((i + 1) % rings) * rings + j + 1;
+            fprintf(f, "f %d//1 %d//1 %d//1 %d//1\n", a, b, c, d);
+        }
+    }
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// Bit for bit, edges in the same order
+static int sameMesh(const Mesh *a, const Mesh *b)
+{
+    int n = a->vertices.count;
+    if (n != b->vertices.count || a->edgeCount != b->edgeCount)
+        return 0;
+    if (memcmp(a->vertices.x, b->vertices.x, n * sizeof(float)) != 0 ||
+        memcmp(a->vertices.y, b->vertices.y, n * sizeof(float)) != 0 ||
+        memcmp(a->vertices.z, b->vertices.z, n * sizeof(float)) != 0)
+        return 0;
+    if (a->triangleCount != b->triangleCount)
+        return 0;
+    return memcmp(a->edges, b->edges, a->edgeCount * sizeof(Edge)) == 0 &&
+           memcmp(a->triangles, b->triangles, a->triangleCount * sizeof(Triangle)) == 0;
+}
+
+static void report(const char *name, double seconds, int runs, long bytes)
+{
+    double ms = seconds * 1000.0 / runs;
+    printf("%-12s %10.3f ms/load %10.1f MB/s\n", name, ms, bytes / (seconds / runs) / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    int rings = 300;
+    int runs = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--rings=", 8) == 0)
+            rings = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--runs=", 7) == 0)
+            runs = atoi(argv[i] + 7);
+    }
+    if (rings < 3 || runs < 1)
+        return 1;
+
+    struct stat objStat, cacheStat;
+    remove(CACHE_PATH);
+    if (writeTorus(OBJ_PATH, rings) < 0 || stat(OBJ_PATH, &objStat) != 0)
+    {
+        fprintf(stderr, "cannot write %s\n", OBJ_PATH);
+        return 1;
+    }
+
+    // First load parses and writes the cache, as cube3d's first start does
+    Mesh reference;
+    if (loadMesh(&reference, OBJ_PATH, CACHE_PATH) < 0 || stat(CACHE_PATH, &cacheStat) != 0)
+    {
+        fprintf(stderr, "cannot load %s\n", OBJ_PATH);
+        return 1;
+    }
+
+    int failures = 0;
+    double parseTime = 0, cacheTime = 0, mapTime = 0;
+    for (int r = 0; r < runs; r++)
+    {
+        Mesh mesh;
+
+        double t0 = nowSeconds();
+        int ok = loadObjMesh(&mesh, OBJ_PATH) == 0;
+        parseTime += nowSeconds() - t0;
+        failures += !ok || !sameMesh(&reference, &mesh);
+        freeMesh(&mesh);
+
+        t0 = nowSeconds();
+        ok = loadMeshCache(&mesh, CACHE_PATH, 0, 0) == 0;
+        cacheTime += nowSeconds() - t0;
+        failures += !ok || !sameMesh(&reference, &mesh);
+        freeMesh(&mesh);
+
+#ifdef MESH_HAVE_MMAP
+        t0 = nowSeconds();
+        ok = loadMeshCacheMapped(&mesh, CACHE_PATH) == 0;
+        mapTime += nowSeconds() - t0;
+        failures += !ok || !sameMesh(&reference, &mesh);
+        freeMesh(&mesh);
+#endif
+    }
+
+    int expectedEdges = 2 * rings * rings;
+    printf("%d vertices, %d faces, %d edges (%d corners before dedup), %d triangles\n",
+           reference.vertices.count, rings * rings, reference.edgeCount, 4 * rings * rings, reference.triangleCount);
+    printf("OBJ %ld KB, cache %ld KB, %d runs\n", (long)objStat.st_size / 1024, (long)cacheStat.st_size / 1024, runs);
+    report("text parse", parseTime, runs, objStat.st_size);
+    report("cache read", cacheTime, runs, cacheStat.st_size);
+#ifdef MESH_HAVE_MMAP
+    // Only the edge indices are read here, to validate them; vertex pages load when first drawn
+    report("cache mmap", mapTime, runs, cacheStat.st_size);
+#endif
+    printf("cache read %.1fx faster than parsing\n", parseTime / cacheTime);
+
+    // A stale cache must be rejected and rebuilt
+    Mesh stale;
+    int staleAccepted = loadMeshCache(&stale, CACHE_PATH, (uint32_t)objStat.st_size + 1, (uint32_t)objStat.st_mtime) == 0;
+    if (staleAccepted)
+        freeMesh(&stale);
+
+    failures += reference.edgeCount != expectedEdges || reference.triangleCount != 2 * rings * rings;
+    freeMesh(&reference);
+    remove(OBJ_PATH);
+    remove(CACHE_PATH);
+
+    if (failures || staleAccepted)
+    {
+        printf("MISMATCH\n");
+        return 1;
+    }
+    return 0;
+}
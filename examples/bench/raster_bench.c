@@ -0,0 +1,230 @@
+/**
+ * Software rasterizer benchmark
+ *
+ * Spins two intersecting spheres at the PSP resolution and fills them with
+ * the tiled rasterizer, once on one thread and once on every core (at
+ * least four threads, so a single-core host still runs the pool). Reports
+ * milliseconds per frame, triangles and pixels per second, and checks that
+ * the threaded frames are identical to the single-threaded ones and that
+ * drawing the triangles in reverse order gives the same picture (the depth
+ * buffer, not submission order, decides what is in front).
+ *
+ * Usage: raster_bench [--frames=N] [--threads=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <SDL2/SDL.h>
+
+#include "raster.h"
+#include "transform.h"
+
+#define SCENES 3
+
+typedef struct
+{
+    Vec3Array vertices;
+    Triangle *triangles;
+    uint32_t *colors;
+    int triangleCount;
+} Scene;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Adds a UV sphere at (cx, 0, cz); triangles are wound counter-clockwise seen from outside
+static void addSphere(Scene *s, int *vertex, int rings, float radius, float cx, float cz)
+{
+    int segments = rings * 2;
+    int base = *vertex;
+
+    for (int r = 0; r <= rings; r++)
+    {
+        float lat = 3.14159265f * r / rings;
+        for (int k = 0; k < segments; k++)
+        {
+            float lon = 6.28318531f * k / segments;
+            s->vertices.x[*vertex] = cx + radius * fastSin(lat) * fastCos(lon);
+            s->vertices.y[*vertex] = radius * fastCos(lat);
+            s->vertices.z[*vertex] = cz + radius * fastSin(lat) * fastSin(lon);
+            (*vertex)++;
+        }
+    }
+
+    for (int r = 0; r < rings; r++)
+    {
+        for (int k = 0; k < segments; k++)
+        {
+            int a = base + r * segments + k;
+            int b = base + r * segments + (k + 1) % segments;
+            int c = a + segments;
+            int d = b + segments;
+            s->triangles[s->triangleCount++] = (Triangle){a, b, d};
+            s->triangles[s->triangleCount++] = (Triangle){a, d, c};
+        }
+    }
+}
+
+static int buildScene(Scene *s, int rings)
+{
+    int perSphere = (rings + 1) * rings * 2;
+    int triangles = 2 * rings * rings * 2;
+
+    s->triangleCount = 0;
+    s->triangles = malloc(2 * triangles * sizeof(Triangle));
+    s->colors = malloc(2 * triangles * sizeof(uint32_t));
+    if (!s->triangles || !s->colors || allocVec3Array(&s->vertices, 2 * perSphere) < 0)
+        return -1;
+
+    int vertex = 0;
+    addSphere(s, &vertex, rings, 90.0f, -50.0f, 0.0f);
+    addSphere(s, &vertex, rings, 70.0f, 60.0f, -20.0f);
+
+    for (int i = 0; i < s->triangleCount; i++)
+        s->colors[i] = 0xFF000000u | ((i * 2654435761u) >> 8);
+    return 0;
+}
+
+static void freeScene(Scene *s)
+{
+    freeVec3Array(&s->vertices);
+    free(s->triangles);
+    free(s->colors);
+}
+
+typedef struct
+{
+    double seconds;
+    long triangles; // Submitted
+    long drawn;
+    long pixels;
+} Result;
+
+static Result run(Raster *r, const Scene *s, Vec3Array *screen, int first, int frames, uint32_t *lastFrame)
+{
+    Projection projection = {400.0f, RASTER_WIDTH / 2, RASTER_HEIGHT / 2};
+    Result result = {0, 0, 0, 0};
+
+    for (int f = first; f < first + frames; f++)
+    {
+        Mat3 m;
+        mat3RotationXYZ(&m, f * 0.02f, f * 0.025f, f * 0.015f);
+        transformProject(&m, &projection, &s->vertices, screen);
+
+        double t0 = nowSeconds();
+        rasterBegin(r, 0xFF000000u);
+        rasterMesh(r, screen, s->triangles, s->triangleCount, s->colors);
+        rasterEnd(r);
+        result.seconds += nowSeconds() - t0;
+
+        result.triangles += r->stats.submitted;
+        result.drawn += r->stats.submitted - r->stats.culled;
+        result.pixels += r->stats.pixels;
+    }
+
+    memcpy(lastFrame, r->color, RASTER_WIDTH * RASTER_HEIGHT * sizeof(uint32_t));
+    return result;
+}
+
+static void report(const char *name, int threads, Result r, int frames)
+{
+    printf("%-10s %7d %10.3f %12.2f %12.2f %12.1f\n", name, threads, r.seconds * 1000.0 / frames,
+           r.triangles / r.seconds / 1e6, r.drawn / r.seconds / 1e6, r.pixels / r.seconds / 1e6);
+}
+
+static long differentPixels(const uint32_t *a, const uint32_t *b)
+{
+    long count = 0;
+    for (int i = 0; i < RASTER_WIDTH * RASTER_HEIGHT; i++)
+        count += a[i] != b[i];
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 300;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--frames=", 9) == 0)
+            frames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            threads = atoi(argv[i] + 10);
+    }
+    if (frames < 1)
+        return 1;
+
+    // The threaded-versus-serial check is only worth something if the pool really runs
+    if (threads <= 0)
+        threads = SDL_GetCPUCount() > 4 ? SDL_GetCPUCount() : 4;
+
+    static const int sceneRings[SCENES] = {8, 24, 64};
+    static uint32_t single[RASTER_WIDTH * RASTER_HEIGHT], threaded[RASTER_WIDTH * RASTER_HEIGHT];
+    int failures = 0;
+
+    printf("%d frames at %dx%d, %d tiles of %dx%d\n", frames, RASTER_WIDTH, RASTER_HEIGHT, RASTER_TILES,
+           RASTER_TILE_WIDTH, RASTER_TILE_HEIGHT);
+    printf("%-10s %7s %10s %12s %12s %12s\n", "triangles", "threads", "ms/frame", "M tris/s", "M drawn/s", "M pixels/s");
+
+    for (int n = 0; n < SCENES; n++)
+    {
+        Scene scene;
+        Vec3Array screen;
+        Raster serial, parallel;
+        if (buildScene(&scene, sceneRings[n]) < 0 || allocVec3Array(&screen, scene.vertices.count) < 0 ||
+            initRaster(&serial, scene.triangleCount, 1) < 0 || initRaster(&parallel, scene.triangleCount, threads) < 0)
+            return 1;
+        serial.nearDepth = parallel.nearDepth = 100.0f;
+
+        char name[16];
+        snprintf(name, sizeof(name), "%d", scene.triangleCount);
+
+        Result a = run(&serial, &scene, &screen, 0, frames, single);
+        Result b = run(&parallel, &scene, &screen, 0, frames, threaded);
+        report(name, serial.threads, a, frames);
+        report("", parallel.threads, b, frames);
+
+        long threadDiff = differentPixels(single, threaded);
+
+        // Same last frame with the triangles reversed
+        for (int i = 0, j = scene.triangleCount - 1; i < j; i++, j--)
+        {
+            Triangle t = scene.triangles[i];
+            uint32_t c = scene.colors[i];
+            scene.triangles[i] = scene.triangles[j];
+            scene.colors[i] = scene.colors[j];
+            scene.triangles[j] = t;
+            scene.colors[j] = c;
+        }
+        run(&serial, &scene, &screen, frames - 1, 1, threaded);
+        long orderDiff = differentPixels(single, threaded);
+
+        if (parallel.threads < 2 && threads > 1)
+        {
+            printf("MISMATCH: no worker threads could be started\n");
+            failures++;
+        }
+
+        // Ties along the intersection may go either way; anything more is a depth bug
+        if (threadDiff != 0 || orderDiff > serial.stats.pixels / 200)
+        {
+            printf("MISMATCH: %ld pixels differ between thread counts, %ld between submission orders\n",
+                   threadDiff, orderDiff);
+            failures++;
+        }
+
+        freeRaster(&serial);
+        freeRaster(&parallel);
+        freeVec3Array(&screen);
+        freeScene(&scene);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * Entity broad phase benchmark
+ *
+ * Scatters 10, 100 and 1000 moving circles over the open cells of a maze3d
+ * window and runs them for a number of ticks. Each tick every entity is
+ * swept against the walls with worldSweepCircle and bounces where it hits
+ * one, the spatial hash is rebuilt, and every entity asks it for the others
+ * it overlaps. The same question is answered by testing every pair.
+ *
+ * The hash must report exactly the pairs the brute-force test finds, and no
+ * entity may ever end a move inside a wall; either failure is a MISMATCH.
+ *
+ * Usage: spatial_bench [--ticks=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "spatial.h"
+#include "world.h"
+
+#define ENTITY_RADIUS 0.25f     /* The player's */
+#define MIN_SPEED 0.02f
+#define MAX_SPEED 0.15f         /* Per tick; the player moves 0.08 */
+#define WALL_TOLERANCE 1e-3f
+
+static const int gCounts[] = {10, 100, 1000};
+
+#define COUNT_COUNT (int)(sizeof(gCounts) / sizeof(gCounts[0]))
+
+typedef struct {
+    double buildTime;
+    double hashTime;
+    double bruteTime;
+    double sweepTime;
+    long queries;
+    long sweeps;
+    long hits;
+    long neighbours;
+    long pairMismatches;
+    long wallMismatches;
+    int dropped;
+} SpatialTotals;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)rand() / RAND_MAX;
+}
+
+static void randomVelocity(float *vx, float *vy)
+{
+    float angle = randomRange(0, 6.2831853f);
+    float speed = randomRange(MIN_SPEED, MAX_SPEED);
+    *vx = cosf(angle) * speed;
+    *vy = sinf(angle) * speed;
+}
+
+static int compareInts(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/* Sweeps every entity against the walls, turning it round at whatever it hits */
+static void moveEntities(const World *world, SpatialEntity *entities, float *velocities, int count,
+                         SpatialTotals *totals)
+{
+    double t0 = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        SpatialEntity *e = &entities[i];
+        float *v = &velocities[i * 2];
+        float t;
+
+        if (worldSweepCircle(world, e->x, e->y, v[0], v[1], e->radius, &t)) {
+            e->x += v[0] * t;
+            e->y += v[1] * t;
+            float speed = sqrtf(v[0] * v[0] + v[1] * v[1]);
+            float angle = atan2f(-v[1], -v[0]) + randomRange(-1.0f, 1.0f);
+            v[0] = cosf(angle) * speed;
+            v[1] = sinf(angle) * speed;
+            totals->hits++;
+        } else {
+            e->x += v[0];
+            e->y += v[1];
+        }
+    }
+    totals->sweepTime += nowSeconds() - t0;
+    totals->sweeps += count;
+
+    for (int i = 0; i < count; i++) {
+        if (worldCheckCollision(world, entities[i].x, entities[i].y, entities[i].radius - WALL_TOLERANCE)) {
+            totals->wallMismatches++;
+        }
+    }
+}
+
+/* Neighbours of every entity from the hash, then from every pair, which must agree */
+static void queryEntities(SpatialHash *hash, const SpatialEntity *entities, int count, int **found, int *foundCount,
+                          int **expected, int *expectedCount, SpatialTotals *totals)
+{
+    double t0 = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        const SpatialEntity *e = &entities[i];
+        foundCount[i] = querySpatialHash(hash, e->x, e->y, e->radius, i, found[i], count);
+    }
+    totals->hashTime += nowSeconds() - t0;
+    totals->queries += count;
+
+    t0 = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        expectedCount[i] = 0;
+        for (int j = 0; j < count; j++) {
+            float dx = entities[j].x - entities[i].x;
+            float dy = entities[j].y - entities[i].y;
+            float reach = entities[j].radius + entities[i].radius;
+            if (j != i && dx * dx + dy * dy < reach * reach) expected[i][expectedCount[i]++] = j;
+        }
+    }
+    totals->bruteTime += nowSeconds() - t0;
+
+    for (int i = 0; i < count; i++) {
+        totals->neighbours += foundCount[i];
+        qsort(found[i], foundCount[i], sizeof(int), compareInts);
+        if (foundCount[i] != expectedCount[i] || memcmp(found[i], expected[i], expectedCount[i] * sizeof(int)) != 0) {
+            totals->pairMismatches++;
+        }
+    }
+}
+
+static int runEntities(const World *world, SpatialHash *hash, int count, int ticks, SpatialTotals *totals)
+{
+    SpatialEntity *entities = malloc(count * sizeof(SpatialEntity));
+    float *velocities = malloc(count * 2 * sizeof(float));
+    int **found = malloc(count * 2 * sizeof(int *));
+    int *foundStorage = malloc((size_t)count * count * 2 * sizeof(int));
+    int *foundCount = malloc(count * 2 * sizeof(int));
+    int failed = !entities || !velocities || !found || !foundStorage || !foundCount;
+
+    if (!failed) {
+        const Maze *window = &world->window;
+        for (int i = 0; i < count; i++) {
+            int cx, cy;
+            do {
+                cx = rand() % window->gridWidth;
+                cy = rand() % window->gridHeight;
+            } while (mazeIsWall(window, cx, cy));
+
+            entities[i] = (SpatialEntity){world->originX + cx + 0.5f, world->originY + cy + 0.5f, ENTITY_RADIUS};
+            randomVelocity(&velocities[i * 2], &velocities[i * 2 + 1]);
+            found[i] = &foundStorage[(size_t)i * count];
+            found[count + i] = &foundStorage[(size_t)(count + i) * count];
+        }
+
+        for (int tick = 0; tick < ticks; tick++) {
+            moveEntities(world, entities, velocities, count, totals);
+
+            double t0 = nowSeconds();
+            buildSpatialHash(hash, entities, count);
+            totals->buildTime += nowSeconds() - t0;
+            if (hash->dropped > totals->dropped) totals->dropped = hash->dropped;
+
+            /* The second half of each array holds the pairwise answers */
+            queryEntities(hash, entities, count, found, foundCount, found + count, foundCount + count, totals);
+        }
+    }
+
+    free(entities);
+    free(velocities);
+    free(found);
+    free(foundStorage);
+    free(foundCount);
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    int ticks = 600;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ticks=", 8) == 0) ticks = atoi(argv[i] + 8);
+    }
+    if (ticks < 1) ticks = 1;
+
+    World world;
+    static SpatialHash hash;
+    initSpatialHash(&hash);
+    if (initWorld(&world, 64, 64, 1, NULL) < 0 || updateWorld(&world, 1.5f, 1.5f) < 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("%d ticks in a %dx%d window, radius %.2f\n", ticks, world.window.gridWidth, world.window.gridHeight,
+           ENTITY_RADIUS);
+    printf("%-9s %10s %12s %12s %9s %12s %9s %11s\n",
+           "entities", "build us", "hash q/s", "brute q/s", "speedup", "sweeps/s", "hits%", "neighbours");
+
+    int mismatches = 0;
+    for (int n = 0; n < COUNT_COUNT; n++) {
+        SpatialTotals totals;
+        memset(&totals, 0, sizeof(totals));
+        srand(2024 + (unsigned int)n);
+
+        if (runEntities(&world, &hash, gCounts[n], ticks, &totals) < 0) {
+            fprintf(stderr, "out of memory at %d entities\n", gCounts[n]);
+            freeWorld(&world);
+            return 1;
+        }
+
+        printf("%-9d %10.2f %12.0f %12.0f %8.1fx %12.0f %8.1f%% %11.2f\n", gCounts[n],
+               totals.buildTime * 1e6 / ticks, totals.queries / totals.hashTime, totals.queries / totals.bruteTime,
+               totals.bruteTime / totals.hashTime, totals.sweeps / totals.sweepTime,
+               100.0 * totals.hits / totals.sweeps, (double)totals.neighbours / totals.queries);
+
+        if (totals.pairMismatches > 0) {
+            printf("MISMATCH: %ld queries at %d entities disagreed with the pairwise test\n", totals.pairMismatches,
+                   gCounts[n]);
+            mismatches++;
+        }
+        if (totals.wallMismatches > 0) {
+            printf("MISMATCH: %ld moves at %d entities ended inside a wall\n", totals.wallMismatches, gCounts[n]);
+            mismatches++;
+        }
+        if (totals.dropped > 0) {
+            printf("MISMATCH: %d entries at %d entities did not fit in the hash\n", totals.dropped, gCounts[n]);
+            mismatches++;
+        }
+    }
+
+    freeWorld(&world);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+/**
+ * Streaming synthesizer benchmark
+ *
+ * Checks the step sequencer in examples/common/sequencer.c against the
+ * double-precision sin() renderer it replaced: the maze3d melody must come
+ * out within a few sample values of the old pre-rendered buffer, and the
+ * output must not depend on how big the audio callback's blocks are. Then
+ * mixes 1 to 8 looping voices at 44.1 kHz stereo in callback-sized blocks,
+ * with the wavetable and with per-sample sin(), and reports voices mixed per
+ * millisecond: milliseconds of voice audio produced per millisecond of CPU,
+ * so the number of voices that would keep up in real time.
+ *
+ * Usage: synth_bench [--seconds=N] [--block=N]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sequencer.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MELODY_RATE 22050
+#define SAMPLE_LIMIT 4 // Largest allowed difference from the sin() render
+#define MAX_VOICES 8
+
+// The maze3d melody, as data and as the loop that used to render it
+static const SynthNote melodyNotes[] = {
+    {262, 1}, {294, 1}, {330, 1}, {349, 1}, {392, 1}, {349, 1}, {330, 1}, {294, 1}};
+static const SynthPattern melody = {melodyNotes, 8, 500, 15000, 50, 50, 1};
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void renderReferenceMelody(Sint16 *out)
+{
+    int samplesPerNote = MELODY_RATE * 4 / 8;
+    int fadeLen = MELODY_RATE / 20;
+
+    for (int n = 0; n < 8; n++)
+    {
+        for (int i = 0; i < samplesPerNote; i++)
+        {
+            double t = (double)i / MELODY_RATE;
+            double envelope = 1.0;
+            if (i < fadeLen)
+                envelope = (double)i / fadeLen;
+            else if (i > samplesPerNote - fadeLen)
+                envelope = (double)(samplesPerNote - i) / fadeLen;
+            out[n * samplesPerNote + i] = (Sint16)(15000 * envelope * sin(2.0 * M_PI * melodyNotes[n].frequency * t));
+        }
+    }
+}
+
+static int checkMelody(void)
+{
+    int samples = patternSamples(&melody, MELODY_RATE);
+    Sint16 *reference = malloc(samples * sizeof(Sint16));
+    Sint16 *streamed = calloc(samples, sizeof(Sint16));
+    if (!reference || !streamed)
+        return -1;
+
+    renderReferenceMelody(reference);
+
+    Sequencer s;
+    initSequencer(&s, MELODY_RATE, 1);
+    playVoice(&s, 0, &melody);
+    mixSequencer(&s, streamed, samples);
+
+    int worst = 0;
+    for (int i = 0; i < samples; i++)
+    {
+        int d = abs(reference[i] - streamed[i]);
+        if (d > worst)
+            worst = d;
+    }
+
+    printf("melody: %d samples, largest difference from sin() %d\n", samples, worst);
+    printf("memory: %d KB pre-rendered, %d bytes of sequencer state however long it plays\n",
+           (int)(samples * sizeof(Sint16) / 1024), (int)sizeof(Sequencer));
+
+    free(reference);
+    free(streamed);
+    return worst <= SAMPLE_LIMIT ? 0 : -1;
+}
+
+// Loops of different lengths and pitches so the voices drift against each other
+static SynthNote voiceNotes[MAX_VOICES][4];
+static SynthPattern voicePatterns[MAX_VOICES];
+
+static void buildVoices(void)
+{
+    for (int v = 0; v < MAX_VOICES; v++)
+    {
+        for (int n = 0; n < 4; n++)
+            voiceNotes[v][n] = (SynthNote){(Uint16)(220 + 55 * v + 37 * n), (Uint16)(1 + (v + n) % 3)};
+        voicePatterns[v] = (SynthPattern){voiceNotes[v], 4, 90 + 10 * v, 3000, 5, 20, 1};
+    }
+}
+
+static void render(Sequencer *s, Sint16 *out, int frames, int block, int channels)
+{
+    for (int done = 0; done < frames; done += block)
+    {
+        int n = frames - done < block ? frames - done : block;
+        memset(out + done * channels, 0, n * channels * sizeof(Sint16));
+        sequencerHook(s, (Uint8 *)(out + done * channels), n * channels * (int)sizeof(Sint16));
+    }
+}
+
+static int checkBlocks(int rate)
+{
+    int frames = rate * 3;
+    Sint16 *a = malloc(frames * 2 * sizeof(Sint16));
+    Sint16 *b = malloc(frames * 2 * sizeof(Sint16));
+    if (!a || !b)
+        return -1;
+
+    Sequencer s;
+    initSequencer(&s, rate, 2);
+    for (int v = 0; v < 4; v++)
+        playVoice(&s, v, &voicePatterns[v]);
+    render(&s, a, frames, 64, 2);
+
+    initSequencer(&s, rate, 2);
+    for (int v = 0; v < 4; v++)
+        playVoice(&s, v, &voicePatterns[v]);
+    render(&s, b, frames, 4096, 2);
+
+    int same = memcmp(a, b, frames * 2 * sizeof(Sint16)) == 0;
+    free(a);
+    free(b);
+    return same ? 0 : -1;
+}
+
+// The old way: double sin() per sample per voice, same notes and envelopes
+typedef struct
+{
+    int note;
+    int position;
+    int length;
+} ReferenceVoice;
+
+static void renderSin(ReferenceVoice *voices, int count, int rate, Sint16 *out, int frames, int channels)
+{
+    static int acc[4096];
+    memset(acc, 0, frames * sizeof(int));
+
+    for (int v = 0; v < count; v++)
+    {
+        const SynthPattern *p = &voicePatterns[v];
+        ReferenceVoice *r = &voices[v];
+        int attack = p->attackMs * rate / 1000;
+        int release = p->releaseMs * rate / 1000;
+
+        for (int i = 0; i < frames; i++)
+        {
+            if (r->position == r->length)
+            {
+                r->note = (r->note + 1) % p->count;
+                r->position = 0;
+                r->length = p->notes[r->note].steps * p->stepMs * rate / 1000;
+            }
+
+            double envelope = 1.0;
+            if (r->position < attack)
+                envelope = (double)r->position / attack;
+            else if (r->length - r->position < release)
+                envelope = (double)(r->length - r->position) / release;
+
+            double t = (double)r->position / rate;
+            acc[i] += (int)(p->amplitude * envelope * sin(2.0 * M_PI * p->notes[r->note].frequency * t));
+            r->position++;
+        }
+    }
+
+    for (int i = 0; i < frames; i++)
+    {
+        int sample = acc[i] > 32767 ? 32767 : (acc[i] < -32768 ? -32768 : acc[i]);
+        for (int c = 0; c < channels; c++)
+            out[i * channels + c] = (Sint16)sample;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = 60;
+    int block = 1024;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--seconds=", 10) == 0)
+            seconds = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--block=", 8) == 0)
+            block = atoi(argv[i] + 8);
+    }
+    if (seconds < 1 || block < 1 || block > 4096)
+        return 1;
+
+    const int rate = 44100, channels = 2;
+    int failures = 0;
+
+    buildVoices();
+
+    if (checkMelody() < 0)
+    {
+        printf("MISMATCH: the streamed melody differs from the sin() render by more than %d\n", SAMPLE_LIMIT);
+        failures++;
+    }
+    if (checkBlocks(rate) < 0)
+    {
+        printf("MISMATCH: output depends on the callback block size\n");
+        failures++;
+    }
+
+    Sint16 *out = malloc(block * channels * sizeof(Sint16));
+    if (!out)
+        return 1;
+    int frames = rate * seconds;
+
+    printf("\n%d s at %d Hz stereo in blocks of %d frames\n", seconds, rate, block);
+    printf("%-8s %-10s %12s %14s\n", "voices", "path", "ms/s audio", "voices/ms");
+
+    static const int voiceCounts[] = {1, 4, 8};
+    for (int k = 0; k < 3; k++)
+    {
+        int count = voiceCounts[k];
+
+        Sequencer s;
+        initSequencer(&s, rate, channels);
+        for (int v = 0; v < count; v++)
+            playVoice(&s, v, &voicePatterns[v]);
+
+        double t0 = nowSeconds();
+        for (int done = 0; done < frames; done += block)
+            render(&s, out, block, block, channels);
+        double table = nowSeconds() - t0;
+
+        ReferenceVoice voices[MAX_VOICES];
+        for (int v = 0; v < count; v++)
+            voices[v] = (ReferenceVoice){-1, 0, 0};
+
+        t0 = nowSeconds();
+        for (int done = 0; done < frames; done += block)
+            renderSin(voices, count, rate, out, block, channels);
+        double reference = nowSeconds() - t0;
+
+        // Milliseconds of voice audio per millisecond of CPU
+        printf("%-8d %-10s %12.3f %14.1f\n", count, "wavetable", table * 1000.0 / seconds, count * seconds / table);
+        printf("%-8s %-10s %12.3f %14.1f\n", "", "sin()", reference * 1000.0 / seconds, count * seconds / reference);
+    }
+
+    free(out);
+    return failures ? 1 : 0;
+}
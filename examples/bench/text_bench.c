@@ -0,0 +1,266 @@
+/**
+ * Text rendering benchmark
+ *
+ * Draws a screen's worth of HUD text per frame, with one line changing every
+ * frame, through the old per-string createText path and through the glyph
+ * atlas. Runs headless on SDL's dummy video driver with the software renderer
+ * and reports glyphs per second and SDL heap allocations per frame.
+ *
+ * Usage: text_bench [--frames=N] [font.ttf]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "text_atlas.h"
+
+#define SCREEN_WIDTH 480
+#define SCREEN_HEIGHT 272
+#define LINE_COUNT 6
+
+#ifndef FONT_PATH
+#define FONT_PATH "Orbitron-Regular.ttf"
+#endif
+
+/* ============== Allocation counting ============== */
+
+static SDL_malloc_func sysMalloc;
+static SDL_calloc_func sysCalloc;
+static SDL_realloc_func sysRealloc;
+static SDL_free_func sysFree;
+static Uint64 gAllocations = 0;
+
+static void *countingMalloc(size_t size)
+{
+    gAllocations++;
+    return sysMalloc(size);
+}
+
+static void *countingCalloc(size_t n, size_t size)
+{
+    gAllocations++;
+    return sysCalloc(n, size);
+}
+
+static void *countingRealloc(void *p, size_t size)
+{
+    gAllocations++;
+    return sysRealloc(p, size);
+}
+
+/* ============== Legacy path (copied from the examples) ============== */
+
+typedef struct
+{
+    SDL_Texture *texture;
+    int w;
+    int h;
+} Text;
+
+static Text createText(SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *text)
+{
+    Text t = {NULL, 0, 0};
+
+    SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
+    if (!surface)
+        return t;
+
+    t.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    t.w = surface->w;
+    t.h = surface->h;
+    SDL_FreeSurface(surface);
+
+    return t;
+}
+
+static void drawText(SDL_Renderer *renderer, Text *text, int x, int y)
+{
+    if (!text->texture)
+        return;
+
+    SDL_Rect dst = {x, y, text->w, text->h};
+    SDL_RenderCopy(renderer, text->texture, NULL, &dst);
+}
+
+static void freeText(Text *text)
+{
+    if (text->texture)
+        SDL_DestroyTexture(text->texture);
+    text->texture = NULL;
+}
+
+/* ============== Benchmark ============== */
+
+typedef struct
+{
+    double seconds;
+    Uint64 glyphs;
+    Uint64 allocations;
+} Result;
+
+static void formatLines(char lines[LINE_COUNT][64], int frame)
+{
+    snprintf(lines[0], 64, "PSP Audio Demo");
+    snprintf(lines[1], 64, "X - Play Beep 1 (440 Hz)");
+    snprintf(lines[2], 64, "O - Play Beep 2 (880 Hz)");
+    snprintf(lines[3], 64, "L/R - Volume Down/Up");
+    snprintf(lines[4], 64, "Clicks: %d", frame / 7);
+    snprintf(lines[5], 64, "Music: Playing | Frame: %d", frame);
+}
+
+static Uint64 countGlyphs(const char *text)
+{
+    Uint64 n = 0;
+    for (; *text; text++)
+    {
+        if (*text != ' ')
+            n++;
+    }
+    return n;
+}
+
+static Result runLegacy(SDL_Renderer *renderer, TTF_Font *font, int frames)
+{
+    SDL_Color white = {255, 255, 255, 255};
+    char lines[LINE_COUNT][64];
+    Result r = {0, 0, 0};
+
+    Uint64 allocStart = gAllocations;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int f = 0; f < frames; f++)
+    {
+        formatLines(lines, f);
+        SDL_RenderClear(renderer);
+        for (int i = 0; i < LINE_COUNT; i++)
+        {
+            // Same pattern as the old audio demo: rebuild every frame
+            Text t = createText(renderer, font, white, lines[i]);
+            drawText(renderer, &t, 10, 10 + i * 25);
+            freeText(&t);
+            r.glyphs += countGlyphs(lines[i]);
+        }
+        SDL_RenderPresent(renderer);
+    }
+
+    r.seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    r.allocations = gAllocations - allocStart;
+    return r;
+}
+
+static Result runAtlas(SDL_Renderer *renderer, TextAtlas *atlas, int frames)
+{
+    SDL_Color white = {255, 255, 255, 255};
+    char lines[LINE_COUNT][64];
+    Result r = {0, 0, 0};
+
+    Uint64 allocStart = gAllocations;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int f = 0; f < frames; f++)
+    {
+        formatLines(lines, f);
+        SDL_RenderClear(renderer);
+        for (int i = 0; i < LINE_COUNT; i++)
+            r.glyphs += drawAtlasText(renderer, atlas, white, lines[i], 10, 10 + i * 25);
+        SDL_RenderPresent(renderer);
+    }
+
+    r.seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    r.allocations = gAllocations - allocStart;
+    return r;
+}
+
+static void report(const char *name, Result r, int frames)
+{
+    printf("%-12s %10.0f glyphs/s %8.3f ms/frame %8.2f allocs/frame\n",
+           name,
+           r.glyphs / r.seconds,
+           r.seconds * 1000.0 / frames,
+           (double)r.allocations / frames);
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 600;
+    const char *fontPath = FONT_PATH;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--frames=", 9) == 0)
+            frames = atoi(argv[i] + 9);
+        else
+            fontPath = argv[i];
+    }
+    if (frames < 1)
+        frames = 1;
+
+    // Must be installed before SDL allocates anything
+    SDL_GetMemoryFunctions(&sysMalloc, &sysCalloc, &sysRealloc, &sysFree);
+    SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, sysFree);
+
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (TTF_Init() < 0)
+    {
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Window *win = SDL_CreateWindow("text_bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                       SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    SDL_Renderer *renderer = win ? SDL_CreateRenderer(win, -1, SDL_RENDERER_SOFTWARE) : NULL;
+    TTF_Font *font = TTF_OpenFont(fontPath, 18);
+
+    if (!win || !renderer || !font)
+    {
+        fprintf(stderr, "setup failed: %s\n", SDL_GetError());
+        if (font)
+            TTF_CloseFont(font);
+        if (renderer)
+            SDL_DestroyRenderer(renderer);
+        if (win)
+            SDL_DestroyWindow(win);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    static TextAtlas atlas;
+    Uint64 buildStart = SDL_GetPerformanceCounter();
+    if (createTextAtlas(&atlas, renderer, font) < 0)
+    {
+        fprintf(stderr, "createTextAtlas failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    double buildMs = (double)(SDL_GetPerformanceCounter() - buildStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    // Warm up both paths so one-time renderer allocations are not counted
+    runLegacy(renderer, font, 10);
+    runAtlas(renderer, &atlas, 10);
+
+    Result legacy = runLegacy(renderer, font, frames);
+    Result batched = runAtlas(renderer, &atlas, frames);
+
+    printf("%d frames, %d lines per frame, atlas %dx%d built in %.2f ms\n",
+           frames, LINE_COUNT, atlas.w, atlas.h, buildMs);
+    report("createText", legacy, frames);
+    report("atlas", batched, frames);
+
+    freeTextAtlas(&atlas);
+    TTF_CloseFont(font);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(win);
+    TTF_Quit();
+    SDL_Quit();
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * Texture format conversion benchmark
+ *
+ * Generates the maze3d textures with their mip chains at sizes from 64 to
+ * 1024 and packs them into each upload format. Reports texture memory,
+ * conversion throughput in millions of texels per second (all mip levels
+ * counted) and the per-channel error after unpacking again. Checks that
+ * RGBA8888 is lossless, that RGB565 and RGBA4444 stay within half a step of
+ * their channel depth, that a palette is exact whenever the texture has 256
+ * colours or fewer, and that packing the same image twice gives the same
+ * bytes. The maze textures all fit a palette exactly, so a random-noise
+ * image (one level) is added at each size to time the median cut.
+ *
+ * Usage: texture_bench [--reps=N] [--max-size=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "textures.h"
+
+#define LEVELS TEXTURE_MAX_LEVELS   /* Clamped to each size's full chain */
+
+static const uint32_t gSeeds[TEXTURE_KIND_COUNT] = {0x0001B21Cu, 0x00E817u, 0x00F100Du, 0x00CE111Au};
+static const char *gKindNames[TEXTURE_KIND_COUNT + 1] = {"brick", "exit", "floor", "ceiling", "noise"};
+
+/* Largest allowed error per channel (R, G, B, A) after a round trip */
+static const int gLimits[TEXTURE_FORMAT_COUNT][4] = {
+    {0, 0, 0, 0},
+    {5, 3, 5, 255},   /* Alpha is dropped */
+    {9, 9, 9, 9},
+    {255, 255, 255, 255}
+};
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Every texel its own random colour: far more colours than a palette holds */
+static int noiseImage(TextureImage *image, int size)
+{
+    uint32_t state = 0x2545F491u;
+
+    image->size = size;
+    image->levels = 1;
+    image->pixels = malloc((size_t)size * size * sizeof(unsigned int));
+    if (!image->pixels) return -1;
+
+    for (int i = 0; i < size * size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        image->pixels[i] = 0xFF000000u | (state & 0xFFFFFF);
+    }
+    return 0;
+}
+
+static size_t imageTexels(const TextureImage *image)
+{
+    return textureLevel(image, image->levels) - image->pixels;
+}
+
+static int countColors(const TextureImage *image, int limit)
+{
+    static unsigned int seen[TEXTURE_PALETTE_SIZE + 1];
+    int count = 0;
+
+    for (size_t i = 0; i < imageTexels(image) && count <= limit; i++) {
+        int found = 0;
+        for (int k = 0; k < count && !found; k++) found = seen[k] == image->pixels[i];
+        if (!found) seen[count++] = image->pixels[i];
+    }
+    return count;
+}
+
+typedef struct {
+    int maxError[4];
+    double meanError;
+} Error;
+
+static Error measureError(const TextureImage *image, const unsigned int *unpacked)
+{
+    Error e = {{0, 0, 0, 0}, 0};
+    size_t texels = imageTexels(image);
+    double sum = 0;
+
+    for (size_t i = 0; i < texels; i++) {
+        for (int k = 0; k < 4; k++) {
+            int a = (image->pixels[i] >> (k * 8)) & 0xFF;
+            int b = (unpacked[i] >> (k * 8)) & 0xFF;
+            int d = a > b ? a - b : b - a;
+            if (d > e.maxError[k]) e.maxError[k] = d;
+            if (k < 3) sum += d;
+        }
+    }
+    e.meanError = sum / (texels * 3);
+    return e;
+}
+
+int main(int argc, char **argv)
+{
+    int reps = 5;
+    int maxSize = 1024;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--reps=", 7) == 0) reps = atoi(argv[i] + 7);
+        else if (strncmp(argv[i], "--max-size=", 11) == 0) maxSize = atoi(argv[i] + 11);
+    }
+    if (reps < 1 || maxSize < 64 || maxSize > TEXTURE_MAX_SIZE) return 1;
+
+    int failures = 0;
+
+    printf("%-8s %5s %-9s %9s %12s %15s %8s\n", "texture", "size", "format", "KB", "M texels/s", "max err RGBA",
+           "mean");
+
+    for (int size = 64; size <= maxSize; size *= 2) {
+        for (int kind = 0; kind <= TEXTURE_KIND_COUNT; kind++) {
+            TextureImage image;
+            if (kind == TEXTURE_KIND_COUNT) {
+                if (noiseImage(&image, size) < 0) return 1;
+            } else {
+                TextureParams params = {(TextureKind)kind, size, gSeeds[kind], LEVELS};
+                if (generateTexture(&params, &image) < 0) return 1;
+            }
+
+            size_t texels = imageTexels(&image);
+            unsigned int *unpacked = malloc(texels * sizeof(unsigned int));
+            if (!unpacked) return 1;
+            int colors = countColors(&image, TEXTURE_PALETTE_SIZE);
+
+            for (int format = 0; format < TEXTURE_FORMAT_COUNT; format++) {
+                PackedTexture packed, again;
+                double seconds = 0;
+
+                for (int r = 0; r < reps; r++) {
+                    double t0 = nowSeconds();
+                    int result = packTexture(&image, (TextureFormat)format, &packed);
+                    seconds += nowSeconds() - t0;
+                    if (result < 0) return 1;
+                    if (r < reps - 1) freePackedTexture(&packed);
+                }
+
+                unpackTexture(&packed, unpacked);
+                Error e = measureError(&image, unpacked);
+
+                int bad = 0;
+                for (int k = 0; k < 4; k++) bad |= e.maxError[k] > gLimits[format][k];
+                if (format == TEXTURE_CLUT8 && colors <= TEXTURE_PALETTE_SIZE) {
+                    bad |= e.maxError[0] || e.maxError[1] || e.maxError[2] || e.maxError[3];
+                }
+
+                if (packTexture(&image, (TextureFormat)format, &again) < 0) return 1;
+                size_t bytes = texels * textureFormatBytes((TextureFormat)format);
+                bad |= memcmp(packed.texels, again.texels, bytes) != 0;
+                bad |= memcmp(packed.palette, again.palette, sizeof(packed.palette)) != 0;
+
+                char errors[32];
+                snprintf(errors, sizeof(errors), "%d/%d/%d/%d", e.maxError[0], e.maxError[1], e.maxError[2],
+                         e.maxError[3]);
+                printf("%-8s %5d %-9s %9.1f %12.1f %15s %8.2f\n", format == 0 ? gKindNames[kind] : "",
+                       size, textureFormatName((TextureFormat)format), packedTextureBytes(&packed) / 1024.0,
+                       texels * reps / seconds / 1e6, errors, e.meanError);
+
+                if (bad) {
+                    printf("MISMATCH: %s %d as %s (%d colours)\n", gKindNames[kind], size,
+                           textureFormatName((TextureFormat)format), colors);
+                    failures++;
+                }
+
+                freePackedTexture(&packed);
+                freePackedTexture(&again);
+            }
+
+            free(unpacked);
+            freeTextureImage(&image);
+        }
+    }
+
+    return failures ? 1 : 0;
+}
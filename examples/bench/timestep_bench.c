@@ -0,0 +1,152 @@
+/**
+ * Fixed timestep benchmark
+ *
+ * Replays the same scripted 2000-tick walk through a maze3d world while
+ * "rendering" at different frame rates, including a jittery one, and checks
+ * that the fixed-timestep loop always ends in the same place. For contrast,
+ * the old per-frame update is run for the same wall-clock time at each rate.
+ *
+ * Usage: timestep_bench [--ticks=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "fixed_step.h"
+#include "player.h"
+
+#define MAX_TICKS_PER_FRAME 5
+#define WORLD_SEED 2024u
+#define WORLD_CELLS 64
+
+/* Same script for every run: keep walking, with a short turn either way every 1.5 seconds */
+static void scriptedInput(unsigned long tick, PlayerInput *input)
+{
+    uint32_t phase = (uint32_t)(tick / 90) * 2654435761u;
+    input->forward = 1.0f;
+    input->turn = tick % 90 < 20 ? ((phase >> 28) & 1 ? 1.0f : -1.0f) : 0.0f;
+    input->strafe = (phase >> 20) & 1 ? 0.5f : 0.0f;
+}
+
+typedef struct {
+    Player player;
+    int frames;
+    unsigned long ticks;
+} RunResult;
+
+static int startWorld(World *world, Player *player)
+{
+    if (initWorld(world, WORLD_CELLS, WORLD_CELLS, WORLD_SEED, NULL) < 0) return -1;
+    player->x = 1.5f;
+    player->y = 1.5f;
+    player->angle = 0;
+    return updateWorld(world, player->x, player->y) < 0 ? -1 : 0;
+}
+
+/* Frame durations for a nominal rate; jitter > 0 varies them pseudo-randomly by up to that fraction */
+static double frameTime(double fps, double jitter, uint32_t *random)
+{
+    double dt = 1.0 / fps;
+    if (jitter > 0) dt *= 1.0 + jitter * ((mazeRandom(random) % 2001) / 1000.0 - 1.0);
+    return dt;
+}
+
+static RunResult runFixed(double fps, double jitter, unsigned long totalTicks)
+{
+    World world;
+    RunResult r;
+    FixedStep clock;
+    uint32_t random = 77;
+
+    memset(&r, 0, sizeof(r));
+    if (startWorld(&world, &r.player) < 0) return r;
+    initFixedStep(&clock, PLAYER_TICK_RATE, MAX_TICKS_PER_FRAME);
+
+    while (r.ticks < totalTicks) {
+        int ticks = advanceFixedStep(&clock, frameTime(fps, jitter, &random));
+        for (int i = 0; i < ticks && r.ticks < totalTicks; i++) {
+            PlayerInput input;
+            scriptedInput(r.ticks, &input);
+            stepPlayer(&r.player, &world, &input);
+            updateWorld(&world, r.player.x, r.player.y);
+            r.ticks++;
+        }
+        r.frames++;
+    }
+
+    freeWorld(&world);
+    return r;
+}
+
+/* The old loop: one update per rendered frame for the time the fixed run covers */
+static RunResult runPerFrame(double fps, unsigned long totalTicks)
+{
+    World world;
+    RunResult r;
+
+    memset(&r, 0, sizeof(r));
+    if (startWorld(&world, &r.player) < 0) return r;
+
+    double duration = (double)totalTicks / PLAYER_TICK_RATE;
+    double elapsed = 0;
+    while (elapsed < duration) {
+        PlayerInput input;
+        /* Input follows wall-clock time so both loops see the same script */
+        scriptedInput((unsigned long)(elapsed * PLAYER_TICK_RATE), &input);
+        stepPlayer(&r.player, &world, &input);
+        updateWorld(&world, r.player.x, r.player.y);
+        elapsed += 1.0 / fps;
+        r.frames++;
+        r.ticks++;
+    }
+
+    freeWorld(&world);
+    return r;
+}
+
+static int samePlayer(const Player *a, const Player *b)
+{
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long totalTicks = 2000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ticks=", 8) == 0) totalTicks = strtoul(argv[i] + 8, NULL, 10);
+    }
+    if (totalTicks < 1) totalTicks = 1;
+
+    static const double rates[] = {5, 15, 24, 30, 60, 144};
+    RunResult reference = runFixed(60, 0, totalTicks);
+
+    printf("%lu ticks at %d Hz, maze %dx%d\n", totalTicks, PLAYER_TICK_RATE, WORLD_CELLS, WORLD_CELLS);
+    printf("%-16s %8s %10s %10s %10s %s\n", "render", "frames", "x", "y", "angle", "match");
+
+    int failures = 0;
+    for (size_t i = 0; i <= sizeof(rates) / sizeof(rates[0]); i++) {
+        int jittery = i == sizeof(rates) / sizeof(rates[0]);
+        double fps = jittery ? 40 : rates[i];
+        RunResult r = runFixed(fps, jittery ? 0.8 : 0, totalTicks);
+        int match = samePlayer(&r.player, &reference.player);
+        failures += !match;
+
+        char label[32];
+        snprintf(label, sizeof(label), jittery ? "fixed 40 +-80%%" : "fixed %.0f fps", fps);
+        printf("%-16s %8d %10.4f %10.4f %10.4f %s\n", label, r.frames,
+               r.player.x, r.player.y, r.player.angle, match ? "yes" : "NO");
+    }
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        RunResult r = runPerFrame(rates[i], totalTicks);
+        char label[32];
+        snprintf(label, sizeof(label), "per-frame %.0f", rates[i]);
+        printf("%-16s %8d %10.4f %10.4f %10.4f %s\n", label, r.frames,
+               r.player.x, r.player.y, r.player.angle, samePlayer(&r.player, &reference.player) ? "yes" : "no");
+    }
+
+    return failures ? 1 : 0;
+}
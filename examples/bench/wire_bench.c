@@ -0,0 +1,206 @@
+/**
+ * Wireframe drawing benchmark
+ *
+ * Spins a UV sphere with thousands of edges and draws it every frame, once
+ * with one SDL_RenderDrawLineF per edge (cube3d's old path) and once with
+ * the batched SoA transform and drawEdges. Runs headless on SDL's dummy
+ * video driver with the software renderer at the PSP resolution and reports
+ * frame time and edges per second.
+ *
+ * Usage: wire_bench [--frames=N] [--rings=N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "line_batch.h"
+#include "transform.h"
+
+#define SCREEN_WIDTH 480
+#define SCREEN_HEIGHT 272
+#define RADIUS 110.0f
+
+typedef struct
+{
+    Vec3Array vertices;
+    Edge *edges;
+    int edgeCount;
+} Wireframe;
+
+// rings x (2 * rings) grid of latitude/longitude lines; each vertex links east and south
+static int buildSphere(Wireframe *w, int rings)
+{
+    int segments = rings * 2;
+    int count = (rings + 1) * segments;
+
+    if (allocVec3Array(&w->vertices, count) < 0)
+        return -1;
+    w->edges = malloc(2 * count * sizeof(Edge));
+    if (!w->edges)
+        return -1;
+
+    w->edgeCount = 0;
+    for (int r = 0; r <= rings; r++)
+    {
+        float lat = 3.14159265f * r / rings;
+        for (int s = 0; s < segments; s++)
+        {
+            float lon = 6.28318531f * s / segments;
+            int i = r * segments + s;
+            w->vertices.x[i] = RADIUS * fastSin(lat) * fastCos(lon);
+            w->vertices.y[i] = RADIUS * fastCos(lat);
+            w->vertices.z[i] = RADIUS * fastSin(lat) * fastSin(lon);
+
+            if (r > 0 && r < rings)
+                w->edges[w->edgeCount++] = (Edge){i, r * segments + (s + 1) % segments};
+            if (r < rings)
+                w->edges[w->edgeCount++] = (Edge){i, i + segments};
+        }
+    }
+
+    return 0;
+}
+
+typedef struct
+{
+    double seconds;
+    int geometryCalls;
+} Result;
+
+static Result runPerEdge(SDL_Renderer *renderer, const Wireframe *w, Vec3Array *screen, int frames)
+{
+    Projection projection = {400.0f, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2};
+    Result r = {0, 0};
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int f = 0; f < frames; f++)
+    {
+        Mat3 m;
+        mat3RotationXYZ(&m, f * 0.02f, f * 0.025f, f * 0.015f);
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        // One Vec3 at a time, one draw call per edge
+        SDL_SetRenderDrawColor(renderer, 0, 200, 255, 255);
+        for (int i = 0; i < w->vertices.count; i++)
+        {
+            Vec3 v = {w->vertices.x[i], w->vertices.y[i], w->vertices.z[i]};
+            Vec3 t = mat3Transform(&m, v);
+            float factor = projection.distance / (projection.distance + t.z);
+            screen->x[i] = t.x * factor + projection.centerX;
+            screen->y[i] = t.y * factor + projection.centerY;
+        }
+        for (int e = 0; e < w->edgeCount; e++)
+        {
+            const Edge *edge = &w->edges[e];
+            SDL_RenderDrawLineF(renderer, screen->x[edge->a], screen->y[edge->a], screen->x[edge->b], screen->y[edge->b]);
+        }
+
+        SDL_RenderPresent(renderer);
+    }
+
+    r.seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    return r;
+}
+
+static Result runBatched(SDL_Renderer *renderer, LineBatch *lines, const Wireframe *w, Vec3Array *screen, int frames)
+{
+    Projection projection = {400.0f, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2};
+    Result r = {0, 0};
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int f = 0; f < frames; f++)
+    {
+        Mat3 m;
+        mat3RotationXYZ(&m, f * 0.02f, f * 0.025f, f * 0.015f);
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        transformProject(&m, &projection, &w->vertices, screen);
+        r.geometryCalls += drawEdges(renderer, lines, screen->x, screen->y, w->edges, w->edgeCount,
+                                     (SDL_Color){0, 200, 255, 255});
+
+        SDL_RenderPresent(renderer);
+    }
+
+    r.seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    return r;
+}
+
+static void report(const char *name, Result r, int frames, int edges)
+{
+    double ms = r.seconds * 1000.0 / frames;
+    printf("%-12s %8.3f ms/frame %10.2f M edges/s %8.1f calls/frame %s\n",
+           name, ms, (double)edges * frames / r.seconds / 1e6,
+           r.geometryCalls ? (double)r.geometryCalls / frames : (double)edges,
+           ms <= 16.7 ? "" : "(over 60 FPS budget)");
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 300;
+    int rings = 32;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--frames=", 9) == 0)
+            frames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--rings=", 8) == 0)
+            rings = atoi(argv[i] + 8);
+    }
+    if (frames < 1 || rings < 2)
+        return 1;
+
+    Wireframe sphere;
+    Vec3Array screen;
+    if (buildSphere(&sphere, rings) < 0 || allocVec3Array(&screen, sphere.vertices.count) < 0)
+        return 1;
+
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_Window *win = SDL_CreateWindow("wire_bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                       SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    SDL_Renderer *renderer = win ? SDL_CreateRenderer(win, -1, SDL_RENDERER_SOFTWARE) : NULL;
+    if (!renderer)
+    {
+        fprintf(stderr, "setup failed: %s\n", SDL_GetError());
+        if (win)
+            SDL_DestroyWindow(win);
+        SDL_Quit();
+        return 1;
+    }
+
+    static LineBatch lines;
+    initLineBatch(&lines);
+
+    // Warm up both paths so one-time renderer allocations are not counted
+    runPerEdge(renderer, &sphere, &screen, 5);
+    runBatched(renderer, &lines, &sphere, &screen, 5);
+
+    Result perEdge = runPerEdge(renderer, &sphere, &screen, frames);
+    Result batched = runBatched(renderer, &lines, &sphere, &screen, frames);
+
+    printf("%d frames, %d vertices, %d edges at %dx%d\n",
+           frames, sphere.vertices.count, sphere.edgeCount, SCREEN_WIDTH, SCREEN_HEIGHT);
+    report("per edge", perEdge, frames, sphere.edgeCount);
+    report("batched", batched, frames, sphere.edgeCount);
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(win);
+    SDL_Quit();
+
+    freeVec3Array(&sphere.vertices);
+    freeVec3Array(&screen);
+    free(sphere.edges);
+
+    return 0;
+}
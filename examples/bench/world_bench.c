@@ -0,0 +1,205 @@
+/**
+ * Streaming world benchmark
+ *
+ * Walks a player diagonally across chunked maze3d worlds from 64x64 up to
+ * 65536x65536 maze cells and reports how many chunks were generated and
+ * evicted, the cost of a window update and the memory the world holds, which
+ * should not grow with the level. It also checks that evicted chunks come
+ * back bit-identical and that a small world stitched together from its
+ * chunks is still a perfect maze, and that pacing back and forth across a
+ * chunk seam moves the window only once.
+ *
+ * Usage: world_bench [--step=UNITS]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "world.h"
+
+static const int gSizes[] = {64, 1024, 16384, 65536};
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t residentBytes(const World *world)
+{
+    const Maze *w = &world->window;
+    return sizeof(*world)
+         + (size_t)w->wordsPerRow * w->gridHeight * sizeof(uint32_t)
+         + (size_t)w->wallCount * (sizeof(Wall) + sizeof(int))
+         + (size_t)w->runCount * sizeof(Wall)
+         + (size_t)(w->gridHeight + 1) * sizeof(int);
+}
+
+/* Chunks regenerated by a fresh world must match the ones streamed in earlier */
+static int checkDeterminism(World *world, int samples)
+{
+    World fresh;
+    int mismatches = 0;
+
+    if (initWorld(&fresh, world->mazeWidth, world->mazeHeight, world->seed, NULL) < 0) return -1;
+
+    for (int i = 0; i < samples; i++) {
+        int cx = rand() % world->chunksX;
+        int cy = rand() % world->chunksY;
+        uint32_t rows[WORLD_CHUNK_GRID];
+
+        memcpy(rows, acquireWorldChunk(world, cx, cy)->rows, sizeof(rows));
+        if (memcmp(rows, acquireWorldChunk(&fresh, cx, cy)->rows, sizeof(rows)) != 0) mismatches++;
+    }
+
+    freeWorld(&fresh);
+    return mismatches;
+}
+
+/* Flood fills the whole stitched level: a perfect maze reaches every cell with exactly cells - 1 passages */
+static int checkPerfect(int width, int height, uint32_t seed)
+{
+    World world;
+    if (initWorld(&world, width, height, seed, NULL) < 0) return 0;
+
+    int gw = width * 2 + 1;
+    int gh = height * 2 + 1;
+    unsigned char *open = calloc((size_t)gw * gh, 1);
+    int *queue = malloc((size_t)width * height * sizeof(int));
+
+    for (int cy = 0; cy < world.chunksY; cy++) {
+        for (int cx = 0; cx < world.chunksX; cx++) {
+            const WorldChunk *chunk = acquireWorldChunk(&world, cx, cy);
+            for (int y = 0; y < WORLD_CHUNK_GRID; y++) {
+                for (int x = 0; x < WORLD_CHUNK_GRID; x++) {
+                    int gx = cx * WORLD_CHUNK_GRID + x;
+                    int gy = cy * WORLD_CHUNK_GRID + y;
+                    if (gx >= gw || gy >= gh) continue;
+                    open[gy * gw + gx] = ((chunk->rows[y] >> (x * CELL_BITS)) & 3) != CELL_WALL;
+                }
+            }
+        }
+    }
+
+    long passages = 0;
+    for (int y = 0; y < gh; y++) {
+        for (int x = 0; x < gw; x++) {
+            if (open[y * gw + x] && ((x % 2 == 0) != (y % 2 == 0))) passages++;
+        }
+    }
+
+    int head = 0, tail = 0, reached = 1;
+    unsigned char *seen = calloc((size_t)width * height, 1);
+    seen[0] = 1;
+    queue[tail++] = 0;
+    while (head < tail) {
+        int c = queue[head++];
+        int mx = c % width, my = c / width;
+        static const int dx[4] = {0, 1, 0, -1};
+        static const int dy[4] = {-1, 0, 1, 0};
+        for (int d = 0; d < 4; d++) {
+            int nx = mx + dx[d], ny = my + dy[d];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+            if (!open[(my * 2 + 1 + dy[d]) * gw + mx * 2 + 1 + dx[d]] || seen[ny * width + nx]) continue;
+            seen[ny * width + nx] = 1;
+            queue[tail++] = ny * width + nx;
+            reached++;
+        }
+    }
+
+    int perfect = reached == width * height && passages == (long)width * height - 1;
+    free(open);
+    free(queue);
+    free(seen);
+    freeWorld(&world);
+    return perfect;
+}
+
+/* Recentres while pacing across the seam between the first two chunk columns, one margin either side */
+static int countSeamRecentres(void)
+{
+    World world;
+    if (initWorld(&world, 64, 64, 5, NULL) < 0 || updateWorld(&world, 1.5f, 1.5f) < 0) return -1;
+
+    int recentres = 0;
+    float seam = 2 * WORLD_CHUNK_GRID;
+    for (int pass = 0; pass < 100; pass++) {
+        for (float d = -WORLD_WINDOW_MARGIN; d <= WORLD_WINDOW_MARGIN; d += 0.25f) {
+            int moved = updateWorld(&world, seam + (pass & 1 ? -d : d), 1.5f);
+            if (moved < 0) {
+                freeWorld(&world);
+                return -1;
+            }
+            recentres += moved;
+        }
+    }
+    freeWorld(&world);
+    return recentres;
+}
+
+int main(int argc, char **argv)
+{
+    float step = 0.5f;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--step=", 7) == 0) step = (float)atof(argv[i] + 7);
+    }
+    if (step <= 0) step = 0.5f;
+
+    srand(1234);
+    printf("%-12s %10s %10s %9s %12s %12s %10s\n",
+           "world", "updates", "generated", "evicted", "us/update", "max us", "held KB");
+
+    for (size_t s = 0; s < sizeof(gSizes) / sizeof(gSizes[0]); s++) {
+        int n = gSizes[s];
+        World world;
+        if (initWorld(&world, n, n, 99u + (uint32_t)s, NULL) < 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+
+        /* Walk straight through walls from one corner towards the other, capped so big worlds finish */
+        float end = (float)(n * 2);
+        if (end > 20000.0f) end = 20000.0f;
+        int updates = 0;
+        double total = 0, worst = 0;
+        size_t held = 0;
+
+        for (float p = 1.5f; p < end; p += step) {
+            double t0 = nowSeconds();
+            int moved = updateWorld(&world, p, p * 0.75f);
+            double dt = nowSeconds() - t0;
+            if (moved < 0) {
+                fprintf(stderr, "window rebuild failed\n");
+                return 1;
+            }
+            if (moved) {
+                updates++;
+                total += dt;
+                if (dt > worst) worst = dt;
+            }
+            size_t bytes = residentBytes(&world);
+            if (bytes > held) held = bytes;
+        }
+
+        int mismatches = checkDeterminism(&world, 64);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", n, n);
+        printf("%-12s %10d %10d %9d %12.1f %12.1f %10zu %s\n",
+               label, updates, world.chunksGenerated, world.chunksEvicted,
+               updates ? total * 1e6 / updates : 0.0, worst * 1e6, held / 1024,
+               mismatches ? "NONDETERMINISTIC" : "");
+        freeWorld(&world);
+    }
+
+    printf("stitched 5x5, 12x10, 37x29, 100x100 perfect: %s\n",
+           checkPerfect(5, 5, 1) && checkPerfect(12, 10, 2) && checkPerfect(37, 29, 3) &&
+           checkPerfect(100, 100, 4) ? "yes" : "NO");
+
+    printf("pacing a chunk seam 100 times recentres once: %s\n", countSeamRecentres() == 1 ? "yes" : "NO");
+    return 0;
+}
@@ -1,59 +1,29 @@
-#include <pspkernel.h>
-#include <pspctrl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "input.h"
+#include "platform.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "replay.h"
+#include "text_atlas.h"
+
 #define SCREEN_WIDTH 480
 #define SCREEN_HEIGHT 272
 
-typedef struct
-{
-    SDL_Texture *texture;
-    int w;
-    int h;
-} Text;
-
-Text createText(SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *text)
-{
-    Text t = {NULL, 0, 0};
-
-    SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
-    if (!surface)
-        return t;
-
-    t.texture = SDL_CreateTextureFromSurface(renderer, surface);
-    t.w = surface->w;
-    t.h = surface->h;
-    SDL_FreeSurface(surface);
-
-    return t;
-}
-
-void drawText(SDL_Renderer *renderer, Text *text, int x, int y)
-{
-    if (!text->texture)
-        return;
-
-    SDL_Rect dst = {x, y, text->w, text->h};
-    SDL_RenderCopy(renderer, text->texture, NULL, &dst);
-}
-
-void freeText(Text *text)
-{
-    if (text->texture)
-        SDL_DestroyTexture(text->texture);
-    text->texture = NULL;
-}
-
 int main(int argc, char **argv)
 {
-    (void)argc;
-    (void)argv;
+    platformInit(argc, argv);
+
+    // Headless runs click every 10 frames
+    static const AutopilotStep autopilot[] = {{9, 0}, {1, PSP_CTRL_CROSS}};
+    platformSetAutopilot(autopilot, (int)(sizeof(autopilot) / sizeof(autopilot[0])), 0);
 
     // Initialize PSP controls
-    sceCtrlSetSamplingCycle(0);
+    static Input input;
+    initInput(&input);
     sceCtrlSetSamplingMode(PSP_CTRL_MODE_DIGITAL);
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -99,54 +69,91 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    Text welcome = createText(renderer, font, (SDL_Color){0, 0, 0, 255}, "Welcome to PSP clicker!");
-    
+    // All glyphs live in one texture, so the click counter never re-renders
+    static TextAtlas atlas;
+    if (createTextAtlas(&atlas, renderer, font) < 0)
+    {
+        TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(win);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    static ProfilerOverlay overlay;
+    initProfilerOverlay(&overlay, renderer, "Orbitron-Regular.ttf");
+
+    SDL_Color black = {0, 0, 0, 255};
     int clicks = 0;
-    int wasPressed = 0;
     char buffer[32];
     snprintf(buffer, sizeof(buffer), "Clicks: %d", clicks);
-    Text click_count = createText(renderer, font, (SDL_Color){0, 0, 0, 255}, buffer);
 
-    SceCtrlData pad;
     int running = 1;
 
-    while (running)
+    while (running && platformRunning())
     {
-        sceCtrlReadBufferPositive(&pad, 1);
+        profilerBeginFrame();
 
-        if (pad.Buttons & PSP_CTRL_START)
+        profileBegin("input");
+        updateInput(&input);
+
+        if (input.held & PSP_CTRL_START)
             running = 0;
 
-        if (pad.Buttons & PSP_CTRL_CROSS)
+        // Every tap counts, even several between two frames
+        InputEvent event;
+        while (nextInputEvent(&input, &event))
         {
-            if (!wasPressed)
+            if (event.down && event.button == PSP_CTRL_CROSS)
             {
                 clicks++;
-                freeText(&click_count);
                 snprintf(buffer, sizeof(buffer), "Clicks: %d", clicks);
-                click_count = createText(renderer, font, (SDL_Color){0, 0, 0, 255}, buffer);
-                wasPressed = 1;
             }
         }
-        else
-        {
-            wasPressed = 0;
-        }
 
+        // SELECT toggles the profiler overlay
+        if (input.pressed & PSP_CTRL_SELECT)
+            overlay.visible = !overlay.visible;
+        profileEnd();
+
+        profileBegin("render");
         SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
         SDL_RenderClear(renderer);
-        drawText(renderer, &welcome, 0, 0);
-        drawText(renderer, &click_count, 0, 32);
+        drawAtlasText(renderer, &atlas, black, "Welcome to PSP clicker!", 0, 0);
+        drawAtlasText(renderer, &atlas, black, buffer, 0, 32);
+        profileEnd();
+
+        profileBegin("hud");
+        drawProfilerOverlay(renderer, &overlay, SCREEN_WIDTH - 250, SCREEN_HEIGHT - 110);
+        profileEnd();
+
+        profileBegin("present");
         SDL_RenderPresent(renderer);
+        profileEnd();
+
+        profilerEndFrame();
+    }
+
+    if (platformProfileDumps())
+    {
+        profilerWriteCsv("profile.csv");
+        profilerWriteTrace("profile.json");
+    }
+    if (platformHeadless())
+    {
+        profilerPrintSummary(stdout);
+        platformPrintSummary(stdout);
     }
 
-    freeText(&welcome);
-    freeText(&click_count);
+    freeProfilerOverlay(&overlay);
+    freeTextAtlas(&atlas);
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
     TTF_Quit();
     SDL_Quit();
+    stopReplay();
     sceKernelExitGame();
 
     return 0;
@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+int initArena(Arena *arena, size_t capacity)
+{
+    memset(arena, 0, sizeof(*arena));
+
+    // malloc only promises alignment for the largest scalar, so round the base up
+    arena->base = malloc(capacity + ARENA_ALIGN);
+    if (!arena->base)
+        return -1;
+
+    arena->capacity = capacity;
+    return 0;
+}
+
+void freeArena(Arena *arena)
+{
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+static unsigned char *alignedBase(const Arena *arena)
+{
+    return (unsigned char *)(((size_t)arena->base + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+}
+
+void *arenaAlloc(Arena *arena, size_t size)
+{
+    size_t offset = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (!arena->base || size > arena->capacity || offset > arena->capacity - size)
+    {
+        arena->failures++;
+        return NULL;
+    }
+
+    arena->used = offset + size;
+    if (arena->used > arena->highWater)
+        arena->highWater = arena->used;
+    return alignedBase(arena) + offset;
+}
+
+void *arenaCalloc(Arena *arena, size_t count, size_t size)
+{
+    if (size && count > (size_t)-1 / size)
+    {
+        arena->failures++;
+        return NULL;
+    }
+
+    void *p = arenaAlloc(arena, count * size);
+    if (p)
+        memset(p, 0, count * size);
+    return p;
+}
+
+size_t arenaMark(const Arena *arena)
+{
+    return arena->used;
+}
+
+void rewindArena(Arena *arena, size_t mark)
+{
+    if (mark < arena->used)
+        arena->used = mark;
+}
+
+void resetArena(Arena *arena)
+{
+    arena->used = 0;
+}
+
+void arenaPrintSummary(const Arena *arena, const char *name, FILE *out)
+{
+    fprintf(out, "%s arena: %.1f KB in use, %.1f KB at most, of %.1f KB", name, arena->used / 1024.0,
+            arena->highWater / 1024.0, arena->capacity / 1024.0);
+    if (arena->failures > 0)
+        fprintf(out, ", %d requests did not fit", arena->failures);
+    fputc('\n', out);
+}
@@ -0,0 +1,54 @@
+/**
+ * Linear arena allocator
+ *
+ * One block is taken from the heap up front and handed out by bumping an
+ * offset; nothing is freed on its own. Whatever was built in the arena is
+ * dropped at once with resetArena, or back to a mark with rewindArena, so
+ * setup code that runs again and again (a level, a frame's scratch) costs
+ * the heap a single block of the same size every time and cannot leave it
+ * fragmented.
+ *
+ * Allocations are aligned to ARENA_ALIGN. A request that does not fit
+ * returns NULL and is counted; the arena is never grown. highWater records
+ * the most the arena has held, so its capacity can be sized from real runs.
+ *
+ * Pure C with no SDL dependency. Not thread-safe: an arena belongs to one
+ * thread at a time.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define ARENA_ALIGN 16 // Enough for any scalar and for the PSP's VFPU vectors
+
+typedef struct
+{
+    unsigned char *base;
+    size_t capacity;
+    size_t used;
+    size_t highWater; // Most of capacity ever in use at once
+    int failures;     // Requests that did not fit
+} Arena;
+
+// Returns 0 on success, -1 if the block could not be allocated
+int initArena(Arena *arena, size_t capacity);
+void freeArena(Arena *arena);
+
+// size bytes aligned to ARENA_ALIGN, or NULL if they do not fit
+void *arenaAlloc(Arena *arena, size_t size);
+
+// The same, zero-filled
+void *arenaCalloc(Arena *arena, size_t count, size_t size);
+
+// Everything allocated after arenaMark returned mark is released by rewindArena
+size_t arenaMark(const Arena *arena);
+void rewindArena(Arena *arena, size_t mark);
+void resetArena(Arena *arena);
+
+// One line: in use now, high-water mark and capacity in KB, plus any failed requests
+void arenaPrintSummary(const Arena *arena, const char *name, FILE *out);
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL_mixer.h>
+
+#include "audio_monitor.h"
+
+static const AudioProfile gProfiles[AUDIO_PROFILE_COUNT] = {
+    {"safe", 4096},   // 186 ms at 22050 Hz; what both examples used to open with
+    {"normal", 1024}, // 46 ms
+    {"low", 512},     // 23 ms
+    {"lowest", 256},  // 12 ms; needs the mixer to finish every pass well inside that
+};
+
+const AudioProfile *audioProfile(int profile)
+{
+    if (profile < 0 || profile >= AUDIO_PROFILE_COUNT)
+        profile = AUDIO_PROFILE_DEFAULT;
+    return &gProfiles[profile];
+}
+
+int parseAudioProfile(const char *name)
+{
+    for (int i = 0; i < AUDIO_PROFILE_COUNT; i++)
+    {
+        if (strcmp(name, gProfiles[i].name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int ticksToMicroseconds(AudioMonitor *m, Uint64 ticks)
+{
+    Uint64 us = ticks * 1000000 / m->frequency;
+    return us > 0x7fffffff ? 0x7fffffff : (int)us;
+}
+
+// Music hook: runs first in every mixer callback, before the channels are mixed
+static void monitorHook(void *userdata, Uint8 *stream, int len)
+{
+    AudioMonitor *m = (AudioMonitor *)userdata;
+
+    m->callbackStart = SDL_GetPerformanceCounter();
+    if (m->hook)
+        m->hook(m->hookData, stream, len);
+}
+
+// Post-mix effect: runs last, once the buffer holds everything that will be heard from it
+static void monitorPostMix(void *userdata, Uint8 *stream, int len)
+{
+    AudioMonitor *m = (AudioMonitor *)userdata;
+    Uint64 now = SDL_GetPerformanceCounter();
+    int frames = len / m->frameBytes;
+
+    (void)stream;
+    SDL_AtomicSet(&m->bufferFrames, frames);
+    SDL_AtomicAdd(&m->callbacks, 1);
+
+    // The device asks for the next buffer as the last one starts playing,
+    // so a gap of well over one buffer means it played silence meanwhile
+    if (m->lastCallback)
+    {
+        Uint64 gap = now - m->lastCallback;
+        Uint64 period = (Uint64)frames * m->frequency / m->rate;
+        int gapUs = ticksToMicroseconds(m, gap);
+
+        if (gap > period + period / 2)
+            SDL_AtomicAdd(&m->underruns, 1);
+        if (gapUs > SDL_AtomicGet(&m->worstGap))
+            SDL_AtomicSet(&m->worstGap, gapUs);
+    }
+    m->lastCallback = now;
+
+    // Sounds started before this callback began are in this buffer; a press
+    // stamped while it was already running waits for the next one
+    if (SDL_AtomicGet(&m->triggerPending) && m->triggerTime <= m->callbackStart)
+    {
+        int count = SDL_AtomicGet(&m->latencyCount);
+        SDL_AtomicSet(&m->latencies[count % AUDIO_LATENCY_HISTORY], ticksToMicroseconds(m, now - m->triggerTime));
+        SDL_AtomicSet(&m->latencyCount, count + 1);
+        SDL_AtomicSet(&m->triggerPending, 0);
+    }
+}
+
+int openAudioMonitor(AudioMonitor *m, int profile, int rate)
+{
+    SDL_memset(m, 0, sizeof(*m));
+    m->profile = profile < 0 || profile >= AUDIO_PROFILE_COUNT ? AUDIO_PROFILE_DEFAULT : profile;
+    m->frequency = SDL_GetPerformanceFrequency();
+
+    int result = Mix_OpenAudio(rate, MIX_DEFAULT_FORMAT, 2, gProfiles[m->profile].samples);
+    if (result < 0)
+        return result;
+
+    // The device may not give us the rate or layout we asked for
+    Uint16 format;
+    int channels;
+    if (!Mix_QuerySpec(&m->rate, &format, &channels))
+    {
+        m->rate = rate;
+        format = MIX_DEFAULT_FORMAT;
+        channels = 2;
+    }
+    m->frameBytes = SDL_AUDIO_BITSIZE(format) / 8 * channels;
+
+    Mix_HookMusic(monitorHook, m);
+    Mix_SetPostMix(monitorPostMix, m);
+    return result;
+}
+
+void hookAudioMonitor(AudioMonitor *m, void (*hook)(void *, Uint8 *, int), void *userdata)
+{
+    // Mix_HookMusic takes the audio lock, so once it returns no callback is using the old hook
+    Mix_HookMusic(NULL, NULL);
+    m->hook = hook;
+    m->hookData = userdata;
+    Mix_HookMusic(monitorHook, m);
+}
+
+void closeAudioMonitor(AudioMonitor *m)
+{
+    Mix_SetPostMix(NULL, NULL);
+    Mix_HookMusic(NULL, NULL);
+    m->hook = NULL;
+    Mix_CloseAudio();
+}
+
+void markAudioTrigger(AudioMonitor *m)
+{
+    if (SDL_AtomicGet(&m->triggerPending))
+        return;
+
+    m->triggerTime = SDL_GetPerformanceCounter();
+    SDL_AtomicSet(&m->triggerPending, 1);
+}
+
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+void audioMonitorStats(AudioMonitor *m, AudioStats *out)
+{
+    int samples[AUDIO_LATENCY_HISTORY];
+
+    SDL_memset(out, 0, sizeof(*out));
+    out->bufferFrames = SDL_AtomicGet(&m->bufferFrames);
+    if (!out->bufferFrames)
+        out->bufferFrames = gProfiles[m->profile].samples; // No callback yet
+    out->callbacks = SDL_AtomicGet(&m->callbacks);
+    out->underruns = SDL_AtomicGet(&m->underruns);
+    out->presses = SDL_AtomicGet(&m->latencyCount);
+    out->periodMs = m->rate > 0 ? out->bufferFrames * 1000.0f / m->rate : 0.0f;
+    out->worstGapMs = SDL_AtomicGet(&m->worstGap) / 1000.0f;
+
+    int count = out->presses < AUDIO_LATENCY_HISTORY ? out->presses : AUDIO_LATENCY_HISTORY;
+    if (count == 0)
+        return;
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        samples[i] = SDL_AtomicGet(&m->latencies[i]);
+        sum += samples[i];
+    }
+    qsort(samples, count, sizeof(int), compareInts);
+
+    out->meanMs = (float)(sum / count / 1000.0);
+    out->p50Ms = samples[(count - 1) * 50 / 100] / 1000.0f;
+    out->maxMs = samples[count - 1] / 1000.0f;
+}
+
+void audioMonitorPrintSummary(AudioMonitor *m, FILE *out)
+{
+    AudioStats stats;
+
+    audioMonitorStats(m, &stats);
+    fprintf(out, "audio %s: %d frames (%.1f ms), %d callbacks, %d underruns, worst gap %.1f ms\n",
+            gProfiles[m->profile].name, stats.bufferFrames, stats.periodMs,
+            stats.callbacks, stats.underruns, stats.worstGapMs);
+
+    // Once mixed, a buffer waits about one more period behind the one playing before it is heard
+    if (stats.presses > 0)
+        fprintf(out, "press to mixed: mean %.1f p50 %.1f max %.1f ms over %d presses, + %.1f ms queued before heard\n",
+                stats.meanMs, stats.p50Ms, stats.maxMs, stats.presses, stats.periodMs);
+}
@@ -0,0 +1,99 @@
+/**
+ * Audio latency profiles and monitor
+ *
+ * Opens SDL_mixer with one of a few named buffer sizes and watches the
+ * audio thread while it runs. The buffer size sets the floor on latency:
+ * 4096 frames at 22050 Hz is 186 ms between a button press and the sound,
+ * 512 frames is 23 ms, but a smaller buffer leaves the mixer less slack
+ * before the device runs dry.
+ *
+ * The monitor runs at both ends of every mixer callback: as the music hook
+ * (wrapping the program's own) it stamps when the callback started, and
+ * as the post-mix effect it checks the gap since the last callback. A gap
+ * well past one buffer's worth of time means the device was starved and
+ * counts as an underrun. markAudioTrigger stamps a button press before the
+ * sound is started; the first callback that starts after the stamp is the
+ * one that mixes the sound's first samples, and the time from press to the
+ * end of that callback is recorded as the press's latency.
+ */
+
+#ifndef AUDIO_MONITOR_H
+#define AUDIO_MONITOR_H
+
+#include <stdio.h>
+#include <SDL2/SDL.h>
+
+#define AUDIO_PROFILE_COUNT 4
+#define AUDIO_PROFILE_DEFAULT 1 // "normal"
+#define AUDIO_LATENCY_HISTORY 64 // Presses kept for the statistics
+
+typedef struct
+{
+    const char *name;
+    int samples; // Frames per mixer callback
+} AudioProfile;
+
+typedef struct
+{
+    int profile;
+    int rate;
+    int frameBytes;
+    Uint64 frequency; // Performance counter ticks per second
+
+    void (*hook)(void *userdata, Uint8 *stream, int len);
+    void *hookData;
+
+    // Main thread to audio thread
+    Uint64 triggerTime;
+    SDL_atomic_t triggerPending;
+
+    // Audio thread only
+    Uint64 callbackStart;
+    Uint64 lastCallback;
+
+    // Written by the audio thread, read by audioMonitorStats
+    SDL_atomic_t bufferFrames; // As the device asks for them, which can differ from the profile
+    SDL_atomic_t callbacks;
+    SDL_atomic_t underruns;
+    SDL_atomic_t worstGap;  // Microseconds
+    SDL_atomic_t latencyCount;
+    SDL_atomic_t latencies[AUDIO_LATENCY_HISTORY]; // Microseconds, newest overwrite oldest
+} AudioMonitor;
+
+typedef struct
+{
+    int bufferFrames;
+    int callbacks;
+    int underruns;
+    int presses;     // Latencies measured so far
+    float periodMs;  // One buffer's worth of time
+    float worstGapMs;
+    float meanMs;    // Press to the end of the callback that mixed it, over the last presses
+    float p50Ms;
+    float maxMs;
+} AudioStats;
+
+const AudioProfile *audioProfile(int profile);
+
+// Parses a name from audioProfile. Returns -1 if unknown.
+int parseAudioProfile(const char *name);
+
+// Mix_OpenAudio with the profile's buffer size, then installs the monitor's
+// music hook and post-mix effect. Returns Mix_OpenAudio's result.
+int openAudioMonitor(AudioMonitor *m, int profile, int rate);
+
+// Runs hook (sequencerHook, say) as the music hook inside the monitor's
+// own; use it instead of Mix_HookMusic. NULL removes it.
+void hookAudioMonitor(AudioMonitor *m, void (*hook)(void *, Uint8 *, int), void *userdata);
+
+// Removes the hooks and closes the mixer
+void closeAudioMonitor(AudioMonitor *m);
+
+// Call just before starting the sound the press triggers. A press while
+// an earlier one is still waiting for its callback is not measured.
+void markAudioTrigger(AudioMonitor *m);
+
+void audioMonitorStats(AudioMonitor *m, AudioStats *out);
+void audioMonitorPrintSummary(AudioMonitor *m, FILE *out);
+
+#endif
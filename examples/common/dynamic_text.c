@@ -0,0 +1,111 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dynamic_text.h"
+
+static int allocateTexture(DynamicText *label, int w, int h)
+{
+    if (label->texture)
+        SDL_DestroyTexture(label->texture);
+
+    label->texture = SDL_CreateTexture(label->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                       SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (!label->texture)
+    {
+        label->capacityW = 0;
+        label->capacityH = 0;
+        return -1;
+    }
+
+    SDL_SetTextureBlendMode(label->texture, SDL_BLENDMODE_BLEND);
+    label->capacityW = w;
+    label->capacityH = h;
+    return 0;
+}
+
+int createDynamicText(DynamicText *label, SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *widest)
+{
+    SDL_memset(label, 0, sizeof(*label));
+    label->renderer = renderer;
+    label->font = font;
+    label->color = color;
+
+    int w = 1;
+    int h = TTF_FontHeight(font);
+    if (widest)
+        TTF_SizeText(font, widest, &w, &h);
+
+    return allocateTexture(label, w, h);
+}
+
+int setDynamicText(DynamicText *label, const char *fmt, ...)
+{
+    char buffer[DYNAMIC_TEXT_MAX];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+
+    if (label->renders > 0 && strcmp(buffer, label->contents) == 0)
+        return 0;
+
+    // Blank until the texture holds the new contents, so a failed render is retried by the next call
+    label->contents[0] = '\0';
+    label->w = 0;
+    label->h = 0;
+
+    if (buffer[0] == '\0')
+    {
+        label->renders++;
+        return 1;
+    }
+
+    SDL_Surface *surface = TTF_RenderText_Blended(label->font, buffer, label->color);
+    if (!surface)
+        return -1;
+
+    // Only reallocate when a value is wider than anything seen so far
+    if (surface->w > label->capacityW || surface->h > label->capacityH)
+    {
+        int w = surface->w > label->capacityW ? surface->w : label->capacityW;
+        int h = surface->h > label->capacityH ? surface->h : label->capacityH;
+        if (allocateTexture(label, w, h) < 0)
+        {
+            SDL_FreeSurface(surface);
+            return -1;
+        }
+    }
+
+    SDL_Rect area = {0, 0, surface->w, surface->h};
+    if (SDL_UpdateTexture(label->texture, &area, surface->pixels, surface->pitch) < 0)
+    {
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    memcpy(label->contents, buffer, sizeof(buffer));
+    label->w = surface->w;
+    label->h = surface->h;
+    label->renders++;
+    SDL_FreeSurface(surface);
+
+    return 1;
+}
+
+void drawDynamicText(SDL_Renderer *renderer, DynamicText *label, int x, int y)
+{
+    if (!label->texture || label->w == 0)
+        return;
+
+    SDL_Rect src = {0, 0, label->w, label->h};
+    SDL_Rect dst = {x, y, label->w, label->h};
+    SDL_RenderCopy(renderer, label->texture, &src, &dst);
+}
+
+void freeDynamicText(DynamicText *label)
+{
+    if (label->texture)
+        SDL_DestroyTexture(label->texture);
+    label->texture = NULL;
+}
@@ -0,0 +1,44 @@
+/**
+ * Retained text label for values that change at runtime
+ *
+ * Keeps one streaming texture sized for the widest expected value and only
+ * re-rasterizes when the formatted contents actually change. Unchanged
+ * frames cost a string compare instead of a TTF render, a surface malloc
+ * and a texture create/destroy.
+ */
+
+#ifndef DYNAMIC_TEXT_H
+#define DYNAMIC_TEXT_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define DYNAMIC_TEXT_MAX 128
+
+typedef struct
+{
+    SDL_Renderer *renderer;
+    TTF_Font *font;
+    SDL_Color color;
+    SDL_Texture *texture;
+    int capacityW; // Texture size, fits the widest value seen so far
+    int capacityH;
+    int w; // Size of the current contents
+    int h;
+    int renders; // Number of times the contents were rasterized
+    char contents[DYNAMIC_TEXT_MAX];
+} DynamicText;
+
+// widest is a sample of the widest value the label is expected to show.
+// Returns 0 on success, -1 if the texture could not be created.
+int createDynamicText(DynamicText *label, SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *widest);
+
+// printf-style update. Returns 1 if the label was re-rasterized, 0 if the
+// contents were unchanged, -1 on error (the label is then blank until a later call succeeds).
+int setDynamicText(DynamicText *label, const char *fmt, ...);
+
+void drawDynamicText(SDL_Renderer *renderer, DynamicText *label, int x, int y);
+
+void freeDynamicText(DynamicText *label);
+
+#endif
@@ -0,0 +1,121 @@
+#include <math.h>
+
+#include "fast_math.h"
+
+#define TWO_PI 6.28318530717958647692
+
+// One guard entry so interpolation never wraps inside the loop
+static float gSinTable[TRIG_TABLE_SIZE + 1];
+static Fixed gFixedSinTable[TRIG_TABLE_SIZE + 1];
+static int gReady = 0;
+
+void initFastMath(void)
+{
+    if (gReady)
+        return;
+
+    for (int i = 0; i <= TRIG_TABLE_SIZE; i++)
+    {
+        double s = sin(TWO_PI * i / TRIG_TABLE_SIZE);
+        gSinTable[i] = (float)s;
+        gFixedSinTable[i] = (Fixed)floor(s * FIXED_ONE + 0.5);
+    }
+
+    gReady = 1;
+}
+
+// Table position of an angle, split into entry and fraction. The quarter-turn offset gives cos.
+static inline float lookup(float radians, int quarter)
+{
+    float turns = radians * (float)(1.0 / TWO_PI);
+    turns -= floorf(turns);
+
+    float pos = turns * TRIG_TABLE_SIZE + quarter * (TRIG_TABLE_SIZE / 4);
+    int i = (int)pos;
+    float frac = pos - (float)i;
+    i &= TRIG_TABLE_SIZE - 1;
+
+    return gSinTable[i] + (gSinTable[i + 1] - gSinTable[i]) * frac;
+}
+
+float fastSin(float radians)
+{
+    initFastMath();
+    return lookup(radians, 0);
+}
+
+float fastCos(float radians)
+{
+    initFastMath();
+    return lookup(radians, 1);
+}
+
+void fastSinCos(float radians, float *s, float *c)
+{
+    initFastMath();
+    *s = lookup(radians, 0);
+    *c = lookup(radians, 1);
+}
+
+void mat3RotationXYZ(Mat3 *out, float ax, float ay, float az)
+{
+    float sx, cx, sy, cy, sz, cz;
+    fastSinCos(ax, &sx, &cx);
+    fastSinCos(ay, &sy, &cy);
+    fastSinCos(az, &sz, &cz);
+
+    // Rz * Ry * Rx
+    out->m[0] = cz * cy;
+    out->m[1] = cz * sy * sx - sz * cx;
+    out->m[2] = cz * sy * cx + sz * sx;
+    out->m[3] = sz * cy;
+    out->m[4] = sz * sy * sx + cz * cx;
+    out->m[5] = sz * sy * cx - cz * sx;
+    out->m[6] = -sy;
+    out->m[7] = cy * sx;
+    out->m[8] = cy * cx;
+}
+
+/* ============== 16.16 fixed point ============== */
+
+uint32_t fixedAngle(float radians)
+{
+    float turns = radians * (float)(1.0 / TWO_PI);
+    turns -= floorf(turns);
+    return (uint32_t)(turns * FIXED_TURN) & (FIXED_TURN - 1);
+}
+
+Fixed fixedSin(uint32_t angle)
+{
+    initFastMath();
+
+    // Top bits pick the entry, the rest interpolate
+    const int fracBits = 16 - TRIG_TABLE_BITS;
+    angle &= FIXED_TURN - 1;
+    int i = (int)(angle >> fracBits);
+    Fixed frac = (Fixed)(angle & ((1u << fracBits) - 1));
+
+    return gFixedSinTable[i] + (((gFixedSinTable[i + 1] - gFixedSinTable[i]) * frac) >> fracBits);
+}
+
+Fixed fixedCos(uint32_t angle)
+{
+    return fixedSin(angle + FIXED_TURN / 4);
+}
+
+void mat3FixedRotationXYZ(Mat3Fixed *out, uint32_t ax, uint32_t ay, uint32_t az)
+{
+    Fixed sx = fixedSin(ax), cx = fixedCos(ax);
+    Fixed sy = fixedSin(ay), cy = fixedCos(ay);
+    Fixed sz = fixedSin(az), cz = fixedCos(az);
+
+    out->m[0] = fixedMul(cz, cy);
+    out->m[1] = fixedMul(fixedMul(cz, sy), sx) - fixedMul(sz, cx);
+    out->m[2] = fixedMul(fixedMul(cz, sy), cx) + fixedMul(sz, sx);
+    out->m[3] = fixedMul(sz, cy);
+    out->m[4] = fixedMul(fixedMul(sz, sy), sx) + fixedMul(cz, cx);
+    out->m[5] = fixedMul(fixedMul(sz, sy), cx) - fixedMul(cz, sx);
+    out->m[6] = -sy;
+    out->m[7] = fixedMul(cy, sx);
+    out->m[8] = fixedMul(cy, cx);
+}
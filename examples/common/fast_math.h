@@ -0,0 +1,105 @@
+/**
+ * Table-driven trigonometry and 3x3 rotations
+ *
+ * sin/cos come from one precomputed table of a full turn with linear
+ * interpolation between entries (error about 3e-7, plus float rounding of
+ * large angles), so a frame's worth of angles costs a few table reads
+ * instead of libm calls. A rotation is composed into a Mat3 once per frame
+ * and then applied to every vertex with nine multiplies.
+ *
+ * The 16.16 fixed-point versions are for integer-only inner loops: angles
+ * are binary angles (FIXED_TURN per revolution) and every operation is
+ * integer multiplies and shifts.
+ *
+ * Pure C; initFastMath is called lazily by the first lookup.
+ */
+
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <stdint.h>
+
+#define TRIG_TABLE_BITS 12
+#define TRIG_TABLE_SIZE (1 << TRIG_TABLE_BITS) // Entries per full turn
+
+typedef struct
+{
+    float x, y, z;
+} Vec3;
+
+// Row-major: out = m * v
+typedef struct
+{
+    float m[9];
+} Mat3;
+
+// Fills the tables. Safe to call more than once.
+void initFastMath(void);
+
+float fastSin(float radians);
+float fastCos(float radians);
+void fastSinCos(float radians, float *s, float *c);
+
+// Same rotation as applying rotateX(ax), then rotateY(ay), then rotateZ(az)
+void mat3RotationXYZ(Mat3 *out, float ax, float ay, float az);
+
+static inline Vec3 mat3Transform(const Mat3 *m, Vec3 v)
+{
+    Vec3 r;
+    r.x = m->m[0] * v.x + m->m[1] * v.y + m->m[2] * v.z;
+    r.y = m->m[3] * v.x + m->m[4] * v.y + m->m[5] * v.z;
+    r.z = m->m[6] * v.x + m->m[7] * v.y + m->m[8] * v.z;
+    return r;
+}
+
+/* ============== 16.16 fixed point ============== */
+
+typedef int32_t Fixed;
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+#define FIXED_TURN 0x10000u // Binary angle units per revolution
+
+typedef struct
+{
+    Fixed x, y, z;
+} Vec3Fixed;
+
+typedef struct
+{
+    Fixed m[9];
+} Mat3Fixed;
+
+static inline Fixed fixedFromFloat(float f)
+{
+    return (Fixed)(f * FIXED_ONE + (f >= 0 ? 0.5f : -0.5f));
+}
+
+static inline float fixedToFloat(Fixed f)
+{
+    return f * (1.0f / FIXED_ONE);
+}
+
+static inline Fixed fixedMul(Fixed a, Fixed b)
+{
+    return (Fixed)(((int64_t)a * b) >> FIXED_SHIFT);
+}
+
+// Radians to binary angle, wrapped to one turn
+uint32_t fixedAngle(float radians);
+
+Fixed fixedSin(uint32_t angle);
+Fixed fixedCos(uint32_t angle);
+
+void mat3FixedRotationXYZ(Mat3Fixed *out, uint32_t ax, uint32_t ay, uint32_t az);
+
+static inline Vec3Fixed mat3FixedTransform(const Mat3Fixed *m, Vec3Fixed v)
+{
+    Vec3Fixed r;
+    r.x = (Fixed)(((int64_t)m->m[0] * v.x + (int64_t)m->m[1] * v.y + (int64_t)m->m[2] * v.z) >> FIXED_SHIFT);
+    r.y = (Fixed)(((int64_t)m->m[3] * v.x + (int64_t)m->m[4] * v.y + (int64_t)m->m[5] * v.z) >> FIXED_SHIFT);
+    r.z = (Fixed)(((int64_t)m->m[6] * v.x + (int64_t)m->m[7] * v.y + (int64_t)m->m[8] * v.z) >> FIXED_SHIFT);
+    return r;
+}
+
+#endif
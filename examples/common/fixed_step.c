@@ -0,0 +1,36 @@
+#include <math.h>
+
+#include "fixed_step.h"
+
+void initFixedStep(FixedStep *clock, int ticksPerSecond, int maxTicks)
+{
+    clock->step = 1.0 / ticksPerSecond;
+    clock->accumulator = 0;
+    clock->maxTicks = maxTicks;
+    clock->ticks = 0;
+}
+
+int advanceFixedStep(FixedStep *clock, double elapsed)
+{
+    if (elapsed > 0)
+        clock->accumulator += elapsed;
+
+    int count = 0;
+    while (clock->accumulator >= clock->step && count < clock->maxTicks)
+    {
+        clock->accumulator -= clock->step;
+        count++;
+    }
+
+    // Drop whole ticks that did not fit, keep the fraction for interpolation
+    if (clock->accumulator >= clock->step)
+        clock->accumulator = fmod(clock->accumulator, clock->step);
+
+    clock->ticks += count;
+    return count;
+}
+
+float fixedStepAlpha(const FixedStep *clock)
+{
+    return (float)(clock->accumulator / clock->step);
+}
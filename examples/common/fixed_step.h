@@ -0,0 +1,32 @@
+/**
+ * Fixed-timestep clock
+ *
+ * Turns measured frame times into a whole number of simulation ticks at a
+ * constant rate, carrying the remainder over in an accumulator. Rendering
+ * then interpolates between the last two ticks with fixedStepAlpha, so the
+ * simulation runs at the same speed whatever the frame rate and slow frames
+ * are dropped instead of slowing the game down.
+ *
+ * Pure C with no SDL dependency; callers measure time themselves.
+ */
+
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+typedef struct
+{
+    double step;        // Seconds per tick
+    double accumulator; // Unsimulated time, always less than one step after advanceFixedStep
+    int maxTicks;       // Per call; time beyond this is dropped so a stall cannot snowball
+    unsigned long ticks;
+} FixedStep;
+
+void initFixedStep(FixedStep *clock, int ticksPerSecond, int maxTicks);
+
+// Adds elapsed seconds and returns how many ticks to simulate now
+int advanceFixedStep(FixedStep *clock, double elapsed);
+
+// How far rendering sits between the previous tick (0) and the latest one (1)
+float fixedStepAlpha(const FixedStep *clock);
+
+#endif
@@ -0,0 +1,160 @@
+#include <string.h>
+
+#include "input.h"
+#include "replay.h"
+
+void initInput(Input *in)
+{
+    memset(in, 0, sizeof(*in));
+    in->pad.Lx = 128;
+    in->pad.Ly = 128;
+    sceCtrlSetSamplingCycle(INPUT_SAMPLING_CYCLE);
+}
+
+static void queueEvent(Input *in, unsigned int time, unsigned int button, int down)
+{
+    if (in->eventCount == INPUT_QUEUE)
+    {
+        in->dropped++;
+        return;
+    }
+
+    InputEvent *event = &in->events[in->eventCount++];
+    event->time = time;
+    event->button = button;
+    event->down = down;
+}
+
+void feedInput(Input *in, const SceCtrlData *samples, int count)
+{
+    in->pressed = 0;
+    in->released = 0;
+    in->samples = 0;
+    in->eventCount = 0;
+    in->eventNext = 0;
+
+    // Samples come oldest first; skip the ones an earlier update took. The
+    // stamps wrap after 71 minutes, hence the signed difference. The first
+    // update only takes the newest, not whatever was pressed before startup.
+    int first = 0;
+    if (in->primed)
+    {
+        while (first < count && (int)(samples[first].TimeStamp - in->lastTime) <= 0)
+            first++;
+        if (first == 0 && count == INPUT_BUFFERS)
+            in->overflows++;
+    }
+    else if (count > 0)
+    {
+        first = count - 1;
+    }
+
+    for (int i = first; i < count; i++)
+    {
+        unsigned int changed = samples[i].Buttons ^ in->held;
+
+        // One event per button, lowest bit first
+        while (changed)
+        {
+            unsigned int button = changed & -changed;
+            int down = (samples[i].Buttons & button) != 0;
+
+            if (down)
+                in->pressed |= button;
+            else
+                in->released |= button;
+            queueEvent(in, samples[i].TimeStamp, button, down);
+            changed &= ~button;
+        }
+
+        in->held = samples[i].Buttons;
+        in->lastTime = samples[i].TimeStamp;
+        in->primed = 1;
+        in->samples++;
+    }
+
+    if (count > 0)
+        in->pad = samples[count - 1];
+}
+
+// A replayed update: the recording keeps the edges but not the sample times,
+// so each update counts as one sampling cycle after the last
+static void applyReplayPad(Input *in, const ReplayPad *pad)
+{
+    unsigned int time = in->lastTime + INPUT_SAMPLING_CYCLE;
+    unsigned int changed = pad->pressed | pad->released;
+
+    in->pressed = pad->pressed;
+    in->released = pad->released;
+    in->samples = 1;
+    in->eventCount = 0;
+    in->eventNext = 0;
+
+    while (changed)
+    {
+        unsigned int button = changed & -changed;
+
+        // Both ways in one update: down and up again, or up and down again if still held
+        if ((pad->pressed & pad->released & button) && (pad->held & button))
+        {
+            queueEvent(in, time, button, 0);
+            queueEvent(in, time, button, 1);
+        }
+        else if (pad->pressed & pad->released & button)
+        {
+            queueEvent(in, time, button, 1);
+            queueEvent(in, time, button, 0);
+        }
+        else
+        {
+            queueEvent(in, time, button, (pad->pressed & button) != 0);
+        }
+        changed &= ~button;
+    }
+
+    in->held = pad->held;
+    in->pad.TimeStamp = time;
+    in->pad.Buttons = pad->held;
+    in->pad.Lx = pad->lx;
+    in->pad.Ly = pad->ly;
+    in->lastTime = time;
+    in->primed = 1;
+}
+
+void updateInput(Input *in)
+{
+    SceCtrlData samples[INPUT_BUFFERS];
+    ReplayPad pad;
+
+    // A replay stands in for the pad; past its end nothing is held
+    if (replaying())
+    {
+        if (!replayPad(&pad))
+        {
+            memset(&pad, 0, sizeof(pad));
+            pad.lx = 128;
+            pad.ly = 128;
+        }
+        applyReplayPad(in, &pad);
+        return;
+    }
+
+    int count = sceCtrlReadBufferPositive(samples, INPUT_BUFFERS);
+    feedInput(in, samples, count > 0 ? count : 0);
+
+    pad.held = in->held;
+    pad.pressed = in->pressed;
+    pad.released = in->released;
+    pad.lx = in->pad.Lx;
+    pad.ly = in->pad.Ly;
+    recordPad(&pad);
+}
+
+int nextInputEvent(Input *in, InputEvent *event)
+{
+    if (in->eventNext >= in->eventCount)
+        return 0;
+
+    *event = in->events[in->eventNext++];
+    return 1;
+}
@@ -0,0 +1,67 @@
+/**
+ * Edge-triggered pad input
+ *
+ * The controller service samples the pad on its own (every 5.5 ms once
+ * initInput has set the cycle) and keeps the last 64 samples. Each
+ * updateInput reads all of them and walks the ones it has not seen yet, so
+ * a tap that starts and ends between two frames still shows up, and two
+ * buttons pressed in the same frame are both reported.
+ *
+ * After an update, pressed and released hold the buttons that changed
+ * during it and held the newest state. The same changes are also queued as
+ * press/release events stamped with the time of the sample that showed
+ * them, oldest first, for code that cares about order or counts every tap.
+ * Events not taken by the next update are dropped.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "platform.h"
+
+#define INPUT_SAMPLING_CYCLE 5555 // Microseconds between pad samples, the PSP's fastest
+#define INPUT_BUFFERS 64          // Samples read per update, all the controller service keeps
+#define INPUT_QUEUE 64            // Events kept per update
+
+typedef struct
+{
+    unsigned int time;   // TimeStamp of the sample that showed the change, microseconds
+    unsigned int button; // A single PSP_CTRL_* bit
+    int down;            // 1 for a press, 0 for a release
+} InputEvent;
+
+typedef struct
+{
+    SceCtrlData pad;       // Newest sample, for the analog nub
+    unsigned int held;     // Buttons down in the newest sample
+    unsigned int pressed;  // Went down during the last update, even if already up again
+    unsigned int released; // Went up during the last update
+    int samples;           // New samples the last update walked
+
+    // Since initInput
+    int overflows; // Updates where every buffer was new, so older samples may have been missed
+    int dropped;   // Events lost to a full queue
+
+    InputEvent events[INPUT_QUEUE];
+    int eventCount;
+    int eventNext;
+
+    unsigned int lastTime; // TimeStamp of the newest sample walked
+    int primed;
+} Input;
+
+// Sets the sampling cycle and clears the state; the sampling mode (digital
+// or analog) is left to the caller
+void initInput(Input *in);
+
+// Reads the pad's buffers and takes in the samples newer than last time.
+// While recording the result is logged; while replaying it comes from the file instead.
+void updateInput(Input *in);
+
+// The same from samples already read, oldest first (a stream captured elsewhere, say)
+void feedInput(Input *in, const SceCtrlData *samples, int count);
+
+// Takes the oldest event of the last update. Returns 0 once there are none.
+int nextInputEvent(Input *in, InputEvent *event);
+
+#endif
@@ -0,0 +1,80 @@
+#include "job.h"
+
+static int runJob(void *data)
+{
+    Job *job = (Job *)data;
+
+    void *result = job->function(job, job->arg);
+    SDL_AtomicSetPtr(&job->result, result);
+    SDL_AtomicSet(&job->done, 1);
+    return 0;
+}
+
+int startJob(Job *job, const char *name, JobFunction function, JobDiscard discard, void *arg)
+{
+    if (jobPending(job))
+        return -1;
+
+    job->function = function;
+    job->discard = discard;
+    job->arg = arg;
+    job->result = NULL;
+    SDL_AtomicSet(&job->done, 0);
+    SDL_AtomicSet(&job->cancelled, 0);
+
+    job->thread = SDL_CreateThread(runJob, name, job);
+    if (!job->thread)
+        runJob(job); // No threads available: do the work now, the result is collected the same way
+
+    return 0;
+}
+
+int jobPending(const Job *job)
+{
+    return job->function != NULL;
+}
+
+static void *collect(Job *job)
+{
+    if (job->thread)
+        SDL_WaitThread(job->thread, NULL);
+    job->thread = NULL;
+    job->function = NULL;
+
+    // The single pointer swap that hands the result over
+    return SDL_AtomicSetPtr(&job->result, NULL);
+}
+
+void *pollJob(Job *job)
+{
+    if (!jobPending(job) || !SDL_AtomicGet(&job->done))
+        return NULL;
+
+    return collect(job);
+}
+
+void *finishJob(Job *job)
+{
+    if (!jobPending(job))
+        return NULL;
+
+    return collect(job);
+}
+
+void cancelJob(Job *job)
+{
+    if (!jobPending(job))
+        return;
+
+    JobDiscard discard = job->discard;
+    SDL_AtomicSet(&job->cancelled, 1);
+
+    void *result = collect(job);
+    if (result && discard)
+        discard(result);
+}
+
+int jobCancelled(Job *job)
+{
+    return SDL_AtomicGet(&job->cancelled);
+}
@@ -0,0 +1,55 @@
+/**
+ * Background jobs on SDL threads
+ *
+ * Runs one function on a worker thread and hands its result back to the
+ * caller. The worker publishes the finished result with a single atomic
+ * pointer store, so the main thread either sees nothing yet or the whole
+ * result, never a half-built one. Works wherever SDL has threads (PSP and
+ * desktop); if a thread cannot be created the job runs inline instead.
+ */
+
+#ifndef JOB_H
+#define JOB_H
+
+#include <SDL2/SDL.h>
+
+typedef struct Job Job;
+
+// Does the work and returns the result, or NULL on failure or cancellation.
+// Long jobs should check jobCancelled between stages.
+typedef void *(*JobFunction)(Job *job, void *arg);
+
+// Frees a result nobody collected
+typedef void (*JobDiscard)(void *result);
+
+struct Job
+{
+    SDL_Thread *thread;
+    JobFunction function;
+    JobDiscard discard;
+    void *arg;
+    void *result;       // Published by the worker with SDL_AtomicSetPtr
+    SDL_atomic_t done;
+    SDL_atomic_t cancelled;
+};
+
+// Returns 0 once the job is running (or has already run inline), -1 if another job is still outstanding
+int startJob(Job *job, const char *name, JobFunction function, JobDiscard discard, void *arg);
+
+// 1 while a started job has not been collected or cancelled
+int jobPending(const Job *job);
+
+// Non-blocking: returns the result and releases the job once it has finished, NULL otherwise.
+// A job that failed is released with a NULL result, so check jobPending to tell the two apart.
+void *pollJob(Job *job);
+
+// Blocks until the job finishes and returns its result
+void *finishJob(Job *job);
+
+// Asks the worker to stop, waits for it and discards whatever it produced
+void cancelJob(Job *job);
+
+// For use inside a JobFunction
+int jobCancelled(Job *job);
+
+#endif
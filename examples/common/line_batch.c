@@ -0,0 +1,59 @@
+#include "line_batch.h"
+
+void initLineBatch(LineBatch *batch)
+{
+    // Every quad uses the same two-triangle pattern, so build indices once
+    for (int q = 0; q < LINE_BATCH_LINES; q++)
+    {
+        int *idx = &batch->indices[q * 6];
+        int v = q * 4;
+        idx[0] = v;
+        idx[1] = v + 1;
+        idx[2] = v + 2;
+        idx[3] = v;
+        idx[4] = v + 2;
+        idx[5] = v + 3;
+    }
+}
+
+int drawEdges(SDL_Renderer *renderer, LineBatch *batch, const float *x, const float *y,
+              const Edge *edges, int edgeCount, SDL_Color color)
+{
+    int quads = 0;
+    int calls = 0;
+
+    for (int e = 0; e < edgeCount; e++)
+    {
+        float x0 = x[edges[e].a], y0 = y[edges[e].a];
+        float x1 = x[edges[e].b], y1 = y[edges[e].b];
+
+        // Widen across the minor axis, as a one-pixel line rasteriser would step
+        float dx = x1 - x0, dy = y1 - y0;
+        float ox = 0, oy = 0;
+        if ((dx < 0 ? -dx : dx) >= (dy < 0 ? -dy : dy))
+            oy = 0.5f;
+        else
+            ox = 0.5f;
+
+        SDL_Vertex *v = &batch->vertices[quads * 4];
+        v[0] = (SDL_Vertex){{x0 - ox, y0 - oy}, color, {0, 0}};
+        v[1] = (SDL_Vertex){{x1 - ox, y1 - oy}, color, {0, 0}};
+        v[2] = (SDL_Vertex){{x1 + ox, y1 + oy}, color, {0, 0}};
+        v[3] = (SDL_Vertex){{x0 + ox, y0 + oy}, color, {0, 0}};
+
+        if (++quads == LINE_BATCH_LINES)
+        {
+            SDL_RenderGeometry(renderer, NULL, batch->vertices, quads * 4, batch->indices, quads * 6);
+            calls++;
+            quads = 0;
+        }
+    }
+
+    if (quads > 0)
+    {
+        SDL_RenderGeometry(renderer, NULL, batch->vertices, quads * 4, batch->indices, quads * 6);
+        calls++;
+    }
+
+    return calls;
+}
@@ -0,0 +1,31 @@
+/**
+ * Batched wireframe line drawing
+ *
+ * Turns mesh edges into one-pixel-wide quads and submits them with a single
+ * SDL_RenderGeometry call per LINE_BATCH_LINES edges, instead of one
+ * SDL_RenderDrawLine call (and one renderer command) per edge. Storage is
+ * preallocated, so drawing never allocates.
+ */
+
+#ifndef LINE_BATCH_H
+#define LINE_BATCH_H
+
+#include <SDL2/SDL.h>
+
+#include "transform.h"
+
+#define LINE_BATCH_LINES 1024
+
+typedef struct
+{
+    SDL_Vertex vertices[LINE_BATCH_LINES * 4];
+    int indices[LINE_BATCH_LINES * 6];
+} LineBatch;
+
+void initLineBatch(LineBatch *batch);
+
+// Draws edges between the points (x[i], y[i]). Returns the number of SDL_RenderGeometry calls made.
+int drawEdges(SDL_Renderer *renderer, LineBatch *batch, const float *x, const float *y,
+              const Edge *edges, int edgeCount, SDL_Color color);
+
+#endif
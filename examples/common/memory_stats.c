@@ -0,0 +1,149 @@
+#include <string.h>
+
+#include "memory_stats.h"
+
+#if defined(MEMORY_STATS_HOOKS) && defined(__GLIBC__) && !defined(__PSP__)
+
+#include <errno.h>
+#include <malloc.h>
+#include <unistd.h>
+
+// glibc's allocator under its internal names, so the wrappers below can call through
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *p);
+
+static long long gAllocations;
+static long long gFrees;
+static long long gBytes;
+static long long gPeakBytes;
+
+static void countAllocation(void *p)
+{
+    if (!p)
+        return;
+
+    __atomic_add_fetch(&gAllocations, 1, __ATOMIC_RELAXED);
+    long long bytes = __atomic_add_fetch(&gBytes, (long long)malloc_usable_size(p), __ATOMIC_RELAXED);
+    long long peak = __atomic_load_n(&gPeakBytes, __ATOMIC_RELAXED);
+    while (bytes > peak && !__atomic_compare_exchange_n(&gPeakBytes, &peak, bytes, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void countFree(void *p)
+{
+    if (!p)
+        return;
+
+    __atomic_add_fetch(&gFrees, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&gBytes, (long long)malloc_usable_size(p), __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size)
+{
+    void *p = __libc_malloc(size);
+    countAllocation(p);
+    return p;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *p = __libc_calloc(count, size);
+    countAllocation(p);
+    return p;
+}
+
+// Counted as a free of the old block and an allocation of the new one
+void *realloc(void *p, size_t size)
+{
+    size_t old = p ? malloc_usable_size(p) : 0;
+    void *q = __libc_realloc(p, size);
+
+    if (p && (q || size == 0))
+    {
+        __atomic_add_fetch(&gFrees, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&gBytes, (long long)old, __ATOMIC_RELAXED);
+    }
+    countAllocation(q);
+    return q;
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    void *p = __libc_memalign(alignment, size);
+    countAllocation(p);
+    return p;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+// Page-aligned, as glibc's own: every block must come from a counted entry point or free would drift
+void *valloc(size_t size)
+{
+    return memalign((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+void *pvalloc(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return memalign(page, (size + page - 1) & ~(page - 1));
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)))
+        return EINVAL;
+
+    void *p = memalign(alignment, size);
+    if (!p)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void *p)
+{
+    countFree(p);
+    __libc_free(p);
+}
+
+int memoryStatsAvailable(void)
+{
+    return 1;
+}
+
+void memoryStats(MemoryStats *out)
+{
+    out->allocations = __atomic_load_n(&gAllocations, __ATOMIC_RELAXED);
+    out->frees = __atomic_load_n(&gFrees, __ATOMIC_RELAXED);
+    out->bytes = __atomic_load_n(&gBytes, __ATOMIC_RELAXED);
+    out->peakBytes = __atomic_load_n(&gPeakBytes, __ATOMIC_RELAXED);
+}
+
+void resetMemoryPeak(void)
+{
+    __atomic_store_n(&gPeakBytes, __atomic_load_n(&gBytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+#else
+
+int memoryStatsAvailable(void)
+{
+    return 0;
+}
+
+void memoryStats(MemoryStats *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+void resetMemoryPeak(void)
+{
+}
+
+#endif
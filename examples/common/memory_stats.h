@@ -0,0 +1,31 @@
+/**
+ * Heap allocation counters
+ *
+ * Built with MEMORY_STATS_HOOKS on a glibc host, this file replaces every
+ * allocator entry point (malloc, calloc, realloc, free, and the aligned and
+ * page-aligned variants) with thin wrappers around glibc's own. They count
+ * calls and the bytes held, as malloc_usable_size reports them, for the
+ * whole process, SDL and drivers included. Only targets that report heap
+ * use define it: arena_bench always, the examples when configured with
+ * HEAP_STATS. Everywhere else, the PSP among them, the allocator is left
+ * alone, the counters stay at zero and memoryStatsAvailable says so.
+ */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+typedef struct
+{
+    long long allocations;
+    long long frees;
+    long long bytes;     // Held now
+    long long peakBytes; // Most held at once since the last resetMemoryPeak
+} MemoryStats;
+
+int memoryStatsAvailable(void);
+void memoryStats(MemoryStats *out);
+
+// Starts peakBytes again from what is held now
+void resetMemoryPeak(void);
+
+#endif
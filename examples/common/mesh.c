@@ -0,0 +1,436 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "mesh.h"
+
+#ifdef MESH_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static void clearMesh(Mesh *mesh)
+{
+    memset(mesh, 0, sizeof(*mesh));
+}
+
+static char *readFile(const char *path, long *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *text = *size >= 0 ? malloc(*size + 1) : NULL;
+    if (text && fread(text, 1, *size, f) != (size_t)*size)
+    {
+        free(text);
+        text = NULL;
+    }
+    fclose(f);
+
+    if (text)
+        text[*size] = '\0';
+    return text;
+}
+
+static const char *skipSpaces(const char *s)
+{
+    while (*s == ' ' || *s == '\t')
+        s++;
+    return s;
+}
+
+static const char *nextLine(const char *s)
+{
+    while (*s && *s != '\n')
+        s++;
+    return *s ? s + 1 : s;
+}
+
+// Open-addressing set of edges, keyed by the sorted vertex pair; 0 marks an empty slot
+typedef struct
+{
+    uint64_t *keys;
+    unsigned int mask;
+} EdgeSet;
+
+static int initEdgeSet(EdgeSet *set, int maxEdges)
+{
+    unsigned int capacity = 16;
+    while (capacity < (unsigned int)maxEdges * 2)
+        capacity *= 2;
+
+    set->keys = calloc(capacity, sizeof(uint64_t));
+    set->mask = capacity - 1;
+    return set->keys ? 0 : -1;
+}
+
+// Returns 1 if the edge was new
+static int insertEdge(EdgeSet *set, int a, int b)
+{
+    uint32_t lo = a < b ? a : b;
+    uint32_t hi = a < b ? b : a;
+    uint64_t key = ((uint64_t)lo << 32 | hi) + 1;
+    unsigned int slot = (unsigned int)((key * 0x9E3779B97F4A7C15ull) >> 32) & set->mask;
+
+    while (set->keys[slot])
+    {
+        if (set->keys[slot] == key)
+            return 0;
+        slot = (slot + 1) & set->mask;
+    }
+
+    set->keys[slot] = key;
+    return 1;
+}
+
+// Face corner "v", "v/vt", "v//vn" or "v/vt/vn"; negative indices count back from the last vertex
+static const char *parseCorner(const char *s, int vertexCount, int *index)
+{
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s)
+        return NULL;
+
+    while (*end && *end != ' ' && *end != '\t' && *end != '\r' && *end != '\n')
+        end++;
+
+    *index = v < 0 ? vertexCount + (int)v : (int)v - 1;
+    return end;
+}
+
+int loadObjMesh(Mesh *mesh, const char *path)
+{
+    clearMesh(mesh);
+
+    long size;
+    char *text = readFile(path, &size);
+    if (!text)
+        return -1;
+
+    // First pass: sizes, so everything is allocated once
+    int vertexCount = 0, cornerCount = 0;
+    for (const char *s = text; *s; s = nextLine(s))
+    {
+        s = skipSpaces(s);
+        if (s[0] == 'v' && (s[1] == ' ' || s[1] == '\t'))
+            vertexCount++;
+        else if (s[0] == 'f' && (s[1] == ' ' || s[1] == '\t'))
+        {
+            for (s = skipSpaces(s + 1); *s && *s != '\n' && *s != '\r'; s = skipSpaces(s))
+            {
+                while (*s && *s != ' ' && *s != '\t' && *s != '\n' && *s != '\r')
+                    s++;
+                cornerCount++;
+            }
+        }
+    }
+
+    // A face of n corners has n edges at most and n - 2 triangles
+    EdgeSet set = {NULL, 0};
+    if (vertexCount == 0 || allocVec3Array(&mesh->vertices, vertexCount) < 0 ||
+        initEdgeSet(&set, cornerCount) < 0 ||
+        !(mesh->edges = malloc((cornerCount ? cornerCount : 1) * sizeof(Edge))) ||
+        !(mesh->triangles = malloc((cornerCount ? cornerCount : 1) * sizeof(Triangle))))
+    {
+        free(set.keys);
+        free(text);
+        freeMesh(mesh);
+        return -1;
+    }
+
+    // Second pass: positions, then face outlines as they come
+    int v = 0;
+    for (const char *s = text; *s; s = nextLine(s))
+    {
+        s = skipSpaces(s);
+        if (s[0] == 'v' && (s[1] == ' ' || s[1] == '\t'))
+        {
+            char *end;
+            mesh->vertices.x[v] = strtof(s + 2, &end);
+            mesh->vertices.y[v] = strtof(end, &end);
+            mesh->vertices.z[v] = strtof(end, &end);
+            v++;
+        }
+        else if (s[0] == 'f' && (s[1] == ' ' || s[1] == '\t'))
+        {
+            int first = -1, previous = -1, index, corners = 0;
+            const char *c = skipSpaces(s + 1);
+
+            while (*c && *c != '\n' && *c != '\r' && (c = parseCorner(c, v, &index)))
+            {
+                if (index < 0 || index >= vertexCount)
+                    break;
+                if (previous < 0)
+                    first = index;
+                else if (insertEdge(&set, previous, index))
+                    mesh->edges[mesh->edgeCount++] = (Edge){previous, index};
+
+                // Fan from the first corner
+                if (++corners >= 3)
+                    mesh->triangles[mesh->triangleCount++] = (Triangle){first, previous, index};
+                previous = index;
+                c = skipSpaces(c);
+            }
+
+            // Close the outline
+            if (first >= 0 && previous != first && insertEdge(&set, previous, first))
+                mesh->edges[mesh->edgeCount++] = (Edge){previous, first};
+        }
+    }
+
+    free(set.keys);
+    free(text);
+    return 0;
+}
+
+int saveMeshCache(const Mesh *mesh, const char *path, uint32_t sourceSize, uint32_t sourceTime)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return -1;
+
+    MeshCacheHeader header = {MESH_CACHE_MAGIC, MESH_CACHE_VERSION, mesh->vertices.count, mesh->edgeCount,
+                              sourceSize, sourceTime, mesh->triangleCount, 0};
+    size_t n = mesh->vertices.count;
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(mesh->vertices.x, sizeof(float), n, f) == n &&
+             fwrite(mesh->vertices.y, sizeof(float), n, f) == n &&
+             fwrite(mesh->vertices.z, sizeof(float), n, f) == n &&
+             fwrite(mesh->edges, sizeof(Edge), mesh->edgeCount, f) == (size_t)mesh->edgeCount &&
+             fwrite(mesh->triangles, sizeof(Triangle), mesh->triangleCount, f) == (size_t)mesh->triangleCount;
+
+    if (fclose(f) != 0 || !ok)
+    {
+        remove(path);
+        return -1;
+    }
+    return 0;
+}
+
+static int validHeader(const MeshCacheHeader *header, size_t fileSize)
+{
+    if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION || header->vertexCount == 0)
+        return 0;
+
+    size_t expected = sizeof(*header) + (size_t)header->vertexCount * 3 * sizeof(float) +
+                      (size_t)header->edgeCount * sizeof(Edge) + (size_t)header->triangleCount * sizeof(Triangle);
+    return fileSize == expected;
+}
+
+// Indices come from a file, so check them once instead of on every draw
+static int validIndices(const Mesh *mesh)
+{
+    unsigned int n = mesh->vertices.count;
+
+    for (int i = 0; i < mesh->edgeCount; i++)
+    {
+        const Edge *e = &mesh->edges[i];
+        if ((unsigned int)e->a >= n || (unsigned int)e->b >= n)
+            return 0;
+    }
+    for (int i = 0; i < mesh->triangleCount; i++)
+    {
+        const Triangle *t = &mesh->triangles[i];
+        if ((unsigned int)t->a >= n || (unsigned int)t->b >= n || (unsigned int)t->c >= n)
+            return 0;
+    }
+    return 1;
+}
+
+int loadMeshCache(Mesh *mesh, const char *path, uint32_t sourceSize, uint32_t sourceTime)
+{
+    clearMesh(mesh);
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return -1;
+
+    MeshCacheHeader header;
+    fseek(f, 0, SEEK_END);
+    long fileSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (fileSize < 0 || fread(&header, sizeof(header), 1, f) != 1 || !validHeader(&header, fileSize) ||
+        (sourceSize && (header.sourceSize != sourceSize || header.sourceTime != sourceTime)))
+    {
+        fclose(f);
+        return -1;
+    }
+
+    size_t n = header.vertexCount;
+    int ok = allocVec3Array(&mesh->vertices, header.vertexCount) == 0 &&
+             (mesh->edges = malloc((header.edgeCount ? header.edgeCount : 1) * sizeof(Edge))) != NULL &&
+             (mesh->triangles = malloc((header.triangleCount ? header.triangleCount : 1) * sizeof(Triangle))) != NULL &&
+             fread(mesh->vertices.x, sizeof(float), n, f) == n &&
+             fread(mesh->vertices.y, sizeof(float), n, f) == n &&
+             fread(mesh->vertices.z, sizeof(float), n, f) == n &&
+             fread(mesh->edges, sizeof(Edge), header.edgeCount, f) == header.edgeCount &&
+             fread(mesh->triangles, sizeof(Triangle), header.triangleCount, f) == header.triangleCount;
+    fclose(f);
+
+    mesh->edgeCount = header.edgeCount;
+    mesh->triangleCount = header.triangleCount;
+    if (!ok || !validIndices(mesh))
+    {
+        freeMesh(mesh);
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef MESH_HAVE_MMAP
+
+int loadMeshCacheMapped(Mesh *mesh, const char *path)
+{
+    clearMesh(mesh);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(MeshCacheHeader))
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return -1;
+
+    // Private mapping: normalizeMesh may scale the vertices without touching the file
+    const MeshCacheHeader *header = map;
+    if (!validHeader(header, st.st_size))
+    {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    float *x = (float *)(header + 1);
+    mesh->vertices.x = x;
+    mesh->vertices.y = x + header->vertexCount;
+    mesh->vertices.z = x + 2 * header->vertexCount;
+    mesh->vertices.count = header->vertexCount;
+    mesh->edges = (Edge *)(x + 3 * header->vertexCount);
+    mesh->edgeCount = header->edgeCount;
+    mesh->triangles = (Triangle *)(mesh->edges + header->edgeCount);
+    mesh->triangleCount = header->triangleCount;
+    mesh->mapping = map;
+    mesh->mappingSize = st.st_size;
+
+    if (!validIndices(mesh))
+    {
+        freeMesh(mesh);
+        return -1;
+    }
+    return 0;
+}
+
+#endif
+
+int loadMesh(Mesh *mesh, const char *objPath, const char *cachePath)
+{
+    struct stat st;
+    if (stat(objPath, &st) != 0)
+        return loadMeshCache(mesh, cachePath, 0, 0);
+
+    // A size of 0 would skip the staleness check, so an empty OBJ never matches
+    uint32_t size = (uint32_t)st.st_size ? (uint32_t)st.st_size : 1;
+    uint32_t time = (uint32_t)st.st_mtime;
+
+    if (loadMeshCache(mesh, cachePath, size, time) == 0)
+        return 0;
+
+    if (loadObjMesh(mesh, objPath) < 0)
+        return -1;
+
+    // A read-only Memory Stick just means parsing again next time
+    saveMeshCache(mesh, cachePath, size, time);
+    return 0;
+}
+
+void normalizeMesh(Mesh *mesh, float radius)
+{
+    Vec3Array *v = &mesh->vertices;
+    if (v->count == 0)
+        return;
+
+    float min[3] = {v->x[0], v->y[0], v->z[0]};
+    float max[3] = {v->x[0], v->y[0], v->z[0]};
+    for (int i = 1; i < v->count; i++)
+    {
+        float p[3] = {v->x[i], v->y[i], v->z[i]};
+        for (int k = 0; k < 3; k++)
+        {
+            if (p[k] < min[k])
+                min[k] = p[k];
+            if (p[k] > max[k])
+                max[k] = p[k];
+        }
+    }
+
+    float cx = (min[0] + max[0]) * 0.5f;
+    float cy = (min[1] + max[1]) * 0.5f;
+    float cz = (min[2] + max[2]) * 0.5f;
+    float farthest = 0;
+    for (int i = 0; i < v->count; i++)
+    {
+        float dx = v->x[i] - cx, dy = v->y[i] - cy, dz = v->z[i] - cz;
+        float d = dx * dx + dy * dy + dz * dz;
+        if (d > farthest)
+            farthest = d;
+    }
+
+    float scale = farthest > 0 ? radius / sqrtf(farthest) : 1.0f;
+    for (int i = 0; i < v->count; i++)
+    {
+        v->x[i] = (v->x[i] - cx) * scale;
+        v->y[i] = (v->y[i] - cy) * scale;
+        v->z[i] = (v->z[i] - cz) * scale;
+    }
+}
+
+void computeFaceNormals(const Mesh *mesh, Vec3Array *normals)
+{
+    const Vec3Array *v = &mesh->vertices;
+
+    for (int i = 0; i < mesh->triangleCount; i++)
+    {
+        const Triangle *t = &mesh->triangles[i];
+        float ux = v->x[t->b] - v->x[t->a], uy = v->y[t->b] - v->y[t->a], uz = v->z[t->b] - v->z[t->a];
+        float wx = v->x[t->c] - v->x[t->a], wy = v->y[t->c] - v->y[t->a], wz = v->z[t->c] - v->z[t->a];
+        float nx = uy * wz - uz * wy;
+        float ny = uz * wx - ux * wz;
+        float nz = ux * wy - uy * wx;
+
+        float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        float scale = length > 0 ? 1.0f / length : 0;
+        normals->x[i] = nx * scale;
+        normals->y[i] = ny * scale;
+        normals->z[i] = nz * scale;
+    }
+}
+
+void freeMesh(Mesh *mesh)
+{
+#ifdef MESH_HAVE_MMAP
+    if (mesh->mapping)
+    {
+        munmap(mesh->mapping, mesh->mappingSize);
+        clearMesh(mesh);
+        return;
+    }
+#endif
+
+    freeVec3Array(&mesh->vertices);
+    free(mesh->edges);
+    free(mesh->triangles);
+    clearMesh(mesh);
+}
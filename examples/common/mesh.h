@@ -0,0 +1,81 @@
+/**
+ * Wireframe meshes from OBJ files
+ *
+ * Reads the vertices and faces of a Wavefront OBJ file and turns the face
+ * outlines into a list of unique edges (an edge shared by two faces is kept
+ * once, whichever way round the faces list it). Faces are also split into a
+ * fan of triangles for filled drawing, keeping the file's winding. The result is saved as a
+ * small binary cache next to the OBJ, so later starts read plain arrays
+ * instead of parsing text, which matters on the PSP's Memory Stick.
+ *
+ * Cache layout (little-endian, as on both the PSP and x86):
+ *   MeshCacheHeader, x[vertexCount], y[vertexCount], z[vertexCount],
+ *   edges[edgeCount] as pairs of int32 vertex indices,
+ *   triangles[triangleCount] as triples of int32 vertex indices
+ */
+
+#ifndef MESH_H
+#define MESH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "transform.h"
+
+#define MESH_CACHE_MAGIC 0x48534D57u // "WMSH"
+#define MESH_CACHE_VERSION 2
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t edgeCount;
+    uint32_t sourceSize; // Size and modification time of the OBJ the cache was built from
+    uint32_t sourceTime;
+    uint32_t triangleCount;
+    uint32_t reserved;
+} MeshCacheHeader;
+
+typedef struct
+{
+    Vec3Array vertices;
+    Edge *edges;
+    int edgeCount;
+    Triangle *triangles;
+    int triangleCount;
+
+    // Set when the mesh points into a memory-mapped cache file
+    void *mapping;
+    size_t mappingSize;
+} Mesh;
+
+// Parses v and f lines; every face contributes its outline and its triangles.
+// Returns 0 on success, -1 on failure.
+int loadObjMesh(Mesh *mesh, const char *path);
+
+int saveMeshCache(const Mesh *mesh, const char *path, uint32_t sourceSize, uint32_t sourceTime);
+
+// Reads the cache into memory. If sourceSize is not 0, the cache must have been built from
+// an OBJ of that size and time. Returns 0 on success, -1 if missing, stale or invalid.
+int loadMeshCache(Mesh *mesh, const char *path, uint32_t sourceSize, uint32_t sourceTime);
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MESH_HAVE_MMAP 1
+// Host only: maps the cache copy-on-write and points the mesh into it, without copying
+int loadMeshCacheMapped(Mesh *mesh, const char *path);
+#endif
+
+// Loads objPath through the cache at cachePath, rebuilding the cache when the OBJ changed.
+// If the OBJ is missing, the cache is used as is.
+int loadMesh(Mesh *mesh, const char *objPath, const char *cachePath);
+
+// Centres the mesh on the origin and scales it so its farthest vertex is at radius
+void normalizeMesh(Mesh *mesh, float radius);
+
+// Unit normal of every triangle, from its winding. normals must hold triangleCount entries.
+void computeFaceNormals(const Mesh *mesh, Vec3Array *normals);
+
+void freeMesh(Mesh *mesh);
+
+#endif
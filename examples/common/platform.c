@@ -0,0 +1,387 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "memory_stats.h"
+#include "platform.h"
+#include "replay.h"
+
+typedef struct
+{
+    int headless;
+    int profile;
+    int maxFrames; // 0 = run until the example quits
+    int frames;
+    int quit;
+    Uint64 lastFrameCounter; // 0 until the first platformFrameSeconds
+
+    // Heap use over the main loop
+    MemoryStats startMemory;
+    long long lastAllocations;
+    long long maxFrameAllocations;
+
+    const AutopilotStep *steps;
+    int stepCount;
+    int loopFrom;
+    int step;
+    int stepReads;
+} Platform;
+
+static Platform gPlatform;
+
+void platformInit(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            gPlatform.headless = 1;
+        else if (strcmp(argv[i], "--profile") == 0)
+            gPlatform.profile = 1;
+        else if (strncmp(argv[i], "--frames=", 9) == 0)
+            gPlatform.maxFrames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--record=", 9) == 0 && startRecording(argv[i] + 9) != 0)
+            fprintf(stderr, "Cannot write %s\n", argv[i] + 9);
+        else if (strncmp(argv[i], "--replay=", 9) == 0 && startReplay(argv[i] + 9) != 0)
+            fprintf(stderr, "%s is not a recording\n", argv[i] + 9);
+    }
+
+#ifndef __PSP__
+    if (gPlatform.headless)
+    {
+        // Leave an explicit choice from the environment alone
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+    }
+#endif
+}
+
+int platformHeadless(void)
+{
+    return gPlatform.headless;
+}
+
+int platformProfileDumps(void)
+{
+    return gPlatform.headless || gPlatform.profile;
+}
+
+double platformFrameSeconds(int ticksPerSecond)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    double elapsed = 0;
+    if (gPlatform.lastFrameCounter)
+        elapsed = (double)(now - gPlatform.lastFrameCounter) / SDL_GetPerformanceFrequency();
+    gPlatform.lastFrameCounter = now;
+
+    return gPlatform.headless ? 1.0 / ticksPerSecond : elapsed;
+}
+
+int platformRunning(void)
+{
+    if (gPlatform.quit)
+        return 0;
+    if (gPlatform.maxFrames > 0 && gPlatform.frames >= gPlatform.maxFrames)
+        return 0;
+    if (replayFinished())
+        return 0;
+
+    // Allocations are counted from the first frame on, after the example's own setup
+    MemoryStats memory;
+    memoryStats(&memory);
+    if (gPlatform.frames == 0)
+    {
+        gPlatform.startMemory = memory;
+        resetMemoryPeak();
+    }
+    else if (memory.allocations - gPlatform.lastAllocations > gPlatform.maxFrameAllocations)
+    {
+        gPlatform.maxFrameAllocations = memory.allocations - gPlatform.lastAllocations;
+    }
+    gPlatform.lastAllocations = memory.allocations;
+
+    gPlatform.frames++;
+    return 1;
+}
+
+void platformPrintSummary(FILE *out)
+{
+    MemoryStats memory;
+
+    replayPrintSummary(out);
+    if (!memoryStatsAvailable() || gPlatform.frames == 0)
+        return;
+
+    memoryStats(&memory);
+    long long allocations = memory.allocations - gPlatform.startMemory.allocations;
+    fprintf(out, "heap: %lld allocations (%.1f per frame, at most %lld in one), %lld frees\n", allocations,
+            (double)allocations / gPlatform.frames, gPlatform.maxFrameAllocations,
+            memory.frees - gPlatform.startMemory.frees);
+    fprintf(out, "heap: %.1f KB held at the first frame, %.1f KB now, %.1f KB at most\n",
+            gPlatform.startMemory.bytes / 1024.0, memory.bytes / 1024.0, memory.peakBytes / 1024.0);
+}
+
+void platformSetAutopilot(const AutopilotStep *steps, int count, int loopFrom)
+{
+    gPlatform.steps = steps;
+    gPlatform.stepCount = count;
+    gPlatform.loopFrom = loopFrom >= 0 && loopFrom < count ? loopFrom : 0;
+    gPlatform.step = 0;
+    gPlatform.stepReads = 0;
+}
+
+#ifndef __PSP__
+
+static unsigned int nextAutopilotButtons(void)
+{
+    if (gPlatform.stepCount == 0)
+        return 0;
+
+    if (gPlatform.stepReads >= gPlatform.steps[gPlatform.step].reads)
+    {
+        gPlatform.stepReads = 0;
+        gPlatform.step = gPlatform.step + 1 < gPlatform.stepCount ? gPlatform.step + 1 : gPlatform.loopFrom;
+    }
+
+    gPlatform.stepReads++;
+    return gPlatform.steps[gPlatform.step].buttons;
+}
+
+#define PAD_BUFFERS 64 // Samples kept, as many as the PSP's controller service keeps
+
+// Host stand-in for the controller service: one sample per input event or read, newest last
+typedef struct
+{
+    SceCtrlData samples[PAD_BUFFERS];
+    int count;
+    int next;
+    unsigned int lastTime;
+
+    unsigned int keyButtons;
+    unsigned int controllerButtons;
+    unsigned char lx;
+    unsigned char ly;
+    int controllersReady;
+} HostPad;
+
+static HostPad gPad = {.lx = 128, .ly = 128};
+
+static const struct
+{
+    SDL_Scancode key;
+    unsigned int button;
+} keymap[] = {
+    {SDL_SCANCODE_UP, PSP_CTRL_UP},
+    {SDL_SCANCODE_DOWN, PSP_CTRL_DOWN},
+    {SDL_SCANCODE_LEFT, PSP_CTRL_LEFT},
+    {SDL_SCANCODE_RIGHT, PSP_CTRL_RIGHT},
+    {SDL_SCANCODE_Z, PSP_CTRL_CROSS},
+    {SDL_SCANCODE_X, PSP_CTRL_CIRCLE},
+    {SDL_SCANCODE_A, PSP_CTRL_SQUARE},
+    {SDL_SCANCODE_S, PSP_CTRL_TRIANGLE},
+    {SDL_SCANCODE_Q, PSP_CTRL_LTRIGGER},
+    {SDL_SCANCODE_W, PSP_CTRL_RTRIGGER},
+    {SDL_SCANCODE_RETURN, PSP_CTRL_START},
+    {SDL_SCANCODE_BACKSPACE, PSP_CTRL_SELECT},
+};
+
+// Face buttons by position, so the bottom one is X as on the PSP
+static const struct
+{
+    SDL_GameControllerButton control;
+    unsigned int button;
+} controllermap[] = {
+    {SDL_CONTROLLER_BUTTON_DPAD_UP, PSP_CTRL_UP},
+    {SDL_CONTROLLER_BUTTON_DPAD_DOWN, PSP_CTRL_DOWN},
+    {SDL_CONTROLLER_BUTTON_DPAD_LEFT, PSP_CTRL_LEFT},
+    {SDL_CONTROLLER_BUTTON_DPAD_RIGHT, PSP_CTRL_RIGHT},
+    {SDL_CONTROLLER_BUTTON_A, PSP_CTRL_CROSS},
+    {SDL_CONTROLLER_BUTTON_B, PSP_CTRL_CIRCLE},
+    {SDL_CONTROLLER_BUTTON_X, PSP_CTRL_SQUARE},
+    {SDL_CONTROLLER_BUTTON_Y, PSP_CTRL_TRIANGLE},
+    {SDL_CONTROLLER_BUTTON_LEFTSHOULDER, PSP_CTRL_LTRIGGER},
+    {SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, PSP_CTRL_RTRIGGER},
+    {SDL_CONTROLLER_BUTTON_START, PSP_CTRL_START},
+    {SDL_CONTROLLER_BUTTON_BACK, PSP_CTRL_SELECT},
+};
+
+static unsigned int keyButton(SDL_Scancode key)
+{
+    for (size_t i = 0; i < sizeof(keymap) / sizeof(keymap[0]); i++)
+    {
+        if (keymap[i].key == key)
+            return keymap[i].button;
+    }
+    return 0;
+}
+
+static unsigned int controllerButton(Uint8 control)
+{
+    for (size_t i = 0; i < sizeof(controllermap) / sizeof(controllermap[0]); i++)
+    {
+        if (controllermap[i].control == control)
+            return controllermap[i].button;
+    }
+    return 0;
+}
+
+// Stick axis (-32768..32767) to the PSP's 0..255 with 128 centred
+static unsigned char axisToPad(Sint16 value)
+{
+    return (unsigned char)((value + 32768) >> 8);
+}
+
+// Appends the current state as a sample. time is in microseconds; samples
+// get distinct, increasing stamps even when several land in the same tick.
+static void pushPadSample(unsigned int buttons, unsigned int time)
+{
+    if (gPad.count > 0 && (int)(time - gPad.lastTime) <= 0)
+        time = gPad.lastTime + 1;
+
+    SceCtrlData *sample = &gPad.samples[gPad.next];
+    memset(sample, 0, sizeof(*sample));
+    sample->TimeStamp = time;
+    sample->Buttons = buttons;
+    sample->Lx = gPad.lx;
+    sample->Ly = gPad.ly;
+
+    gPad.lastTime = time;
+    gPad.next = (gPad.next + 1) % PAD_BUFFERS;
+    if (gPad.count < PAD_BUFFERS)
+        gPad.count++;
+}
+
+static void openControllers(void)
+{
+    gPad.controllersReady = 1;
+
+    // Connected pads then arrive as SDL_CONTROLLERDEVICEADDED events; without the subsystem there are just the keys
+    SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER);
+}
+
+// Turns this read's keyboard and controller events into samples at the time each happened
+static void pumpHostInput(void)
+{
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event))
+    {
+        unsigned int time = event.common.timestamp * 1000;
+
+        switch (event.type)
+        {
+        case SDL_QUIT:
+            gPlatform.quit = 1;
+            continue;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            if (event.key.repeat || !keyButton(event.key.keysym.scancode))
+                continue;
+            if (event.type == SDL_KEYDOWN)
+                gPad.keyButtons |= keyButton(event.key.keysym.scancode);
+            else
+                gPad.keyButtons &= ~keyButton(event.key.keysym.scancode);
+            break;
+        case SDL_CONTROLLERDEVICEADDED:
+            SDL_GameControllerOpen(event.cdevice.which);
+            continue;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            if (!controllerButton(event.cbutton.button))
+                continue;
+            if (event.type == SDL_CONTROLLERBUTTONDOWN)
+                gPad.controllerButtons |= controllerButton(event.cbutton.button);
+            else
+                gPad.controllerButtons &= ~controllerButton(event.cbutton.button);
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            if (event.caxis.axis == SDL_CONTROLLER_AXIS_LEFTX)
+                gPad.lx = axisToPad(event.caxis.value);
+            else if (event.caxis.axis == SDL_CONTROLLER_AXIS_LEFTY)
+                gPad.ly = axisToPad(event.caxis.value);
+            else
+                continue;
+            break;
+        default:
+            continue;
+        }
+
+        pushPadSample(gPad.keyButtons | gPad.controllerButtons, time);
+    }
+}
+
+int sceCtrlSetSamplingCycle(int cycle)
+{
+    (void)cycle;
+    return 0;
+}
+
+int sceCtrlSetSamplingMode(int mode)
+{
+    (void)mode;
+    return 0;
+}
+
+// Like the PSP: the newest count samples, oldest first, and the number returned.
+// Each read also samples the current state once, as the PSP does every cycle.
+int sceCtrlReadBufferPositive(SceCtrlData *pad, int count)
+{
+    if (!gPlatform.headless && !gPad.controllersReady)
+        openControllers();
+
+    if (gPlatform.headless)
+    {
+        SDL_Event event;
+        while (SDL_PollEvent(&event))
+        {
+            if (event.type == SDL_QUIT)
+                gPlatform.quit = 1;
+        }
+        pushPadSample(nextAutopilotButtons(), SDL_GetTicks() * 1000);
+    }
+    else
+    {
+        pumpHostInput();
+        pushPadSample(gPad.keyButtons | gPad.controllerButtons, SDL_GetTicks() * 1000);
+    }
+
+    if (count > gPad.count)
+        count = gPad.count;
+    for (int i = 0; i < count; i++)
+        pad[i] = gPad.samples[(gPad.next - count + i + PAD_BUFFERS) % PAD_BUFFERS];
+
+    return count;
+}
+
+int sceDisplayWaitVblankStart(void)
+{
+    static Uint64 nextVblank = 0;
+
+    if (gPlatform.headless)
+        return 0;
+
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint64 period = freq / 60;
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (nextVblank == 0 || now > nextVblank + period)
+        nextVblank = now;
+    while (now < nextVblank)
+    {
+        Uint64 ms = (nextVblank - now) * 1000 / freq;
+        if (ms > 1)
+            SDL_Delay((Uint32)(ms - 1));
+        now = SDL_GetPerformanceCounter();
+    }
+    nextVblank += period;
+
+    return 0;
+}
+
+void sceKernelExitGame(void)
+{
+    exit(0);
+}
+
+#endif
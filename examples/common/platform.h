@@ -0,0 +1,112 @@
+/**
+ * Platform shim
+ *
+ * On the PSP this just pulls in the kernel, controller and display headers.
+ * Everywhere else it provides the handful of sce* calls the examples use on
+ * top of SDL, so each example also builds and runs natively:
+ *
+ * - sceCtrlReadBufferPositive reads the keyboard (arrows = D-pad, Z = X,
+ *   X = O, A = Square, S = Triangle, Q/W = L/R, Enter = Start,
+ *   Backspace = Select) and any SDL game controller (face buttons by
+ *   position, left stick as the analog nub). As on the PSP it returns the
+ *   last samples from a 64-entry buffer, one per key or button event at
+ *   the time it happened, so presses between two reads are not lost
+ * - sceDisplayWaitVblankStart waits for the next 60 Hz boundary
+ * - sceKernelExitGame exits the process
+ *
+ * Passing --headless selects SDL's offscreen video and dummy audio drivers,
+ * drops all pacing and replays the example's autopilot instead of the
+ * keyboard, and each frame advances the simulation by exactly one tick. --frames=N stops the main loop after N frames. --record=FILE
+ * and --replay=FILE record a run's input, seeds and ticks and play them
+ * back (see replay.h); a replay stops the main loop at the end of its file.
+ * --profile writes the profiler's dumps on exit, which headless runs always do.
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdio.h>
+
+#ifdef __PSP__
+
+#include <pspkernel.h>
+#include <pspctrl.h>
+#include <pspdisplay.h>
+
+#else
+
+#include <SDL2/SDL.h>
+
+// Same bit values as pspctrl.h
+enum PspCtrlButtons
+{
+    PSP_CTRL_SELECT = 0x000001,
+    PSP_CTRL_START = 0x000008,
+    PSP_CTRL_UP = 0x000010,
+    PSP_CTRL_RIGHT = 0x000020,
+    PSP_CTRL_DOWN = 0x000040,
+    PSP_CTRL_LEFT = 0x000080,
+    PSP_CTRL_LTRIGGER = 0x000100,
+    PSP_CTRL_RTRIGGER = 0x000200,
+    PSP_CTRL_TRIANGLE = 0x001000,
+    PSP_CTRL_CIRCLE = 0x002000,
+    PSP_CTRL_CROSS = 0x004000,
+    PSP_CTRL_SQUARE = 0x008000,
+    PSP_CTRL_HOME = 0x010000
+};
+
+enum PspCtrlMode
+{
+    PSP_CTRL_MODE_DIGITAL = 0,
+    PSP_CTRL_MODE_ANALOG
+};
+
+typedef struct SceCtrlData
+{
+    unsigned int TimeStamp;
+    unsigned int Buttons;
+    unsigned char Lx;
+    unsigned char Ly;
+    unsigned char Rsrv[6];
+} SceCtrlData;
+
+int sceCtrlSetSamplingCycle(int cycle);
+int sceCtrlSetSamplingMode(int mode);
+int sceCtrlReadBufferPositive(SceCtrlData *pad, int count);
+int sceDisplayWaitVblankStart(void);
+void sceKernelExitGame(void);
+
+#endif
+
+// One step of a scripted input sequence: hold buttons for this many pad reads (at least 1)
+typedef struct
+{
+    int reads;
+    unsigned int buttons;
+} AutopilotStep;
+
+// Parses --headless, --frames=N, --record=FILE, --replay=FILE and --profile. Call before SDL_Init.
+void platformInit(int argc, char **argv);
+
+int platformHeadless(void);
+
+// Whether to write profile.csv and profile.json on exit: headless runs and --profile
+int platformProfileDumps(void);
+
+// Seconds since the previous call, for a fixed-step clock; 0 the first time.
+// Headless frames are not paced, so there every frame is exactly one tick at
+// ticksPerSecond and a run takes the same path however fast the host is.
+double platformFrameSeconds(int ticksPerSecond);
+
+// Call once per frame as part of the main loop condition. Returns 0 once
+// --frames is reached, a replay has ended or the window was closed.
+int platformRunning(void);
+
+// Replay or recording status and the heap allocations made since the first frame
+void platformPrintSummary(FILE *out);
+
+// Input replayed by sceCtrlReadBufferPositive in headless mode. Steps from
+// loopFrom onwards repeat. Ignored on the PSP and when not headless.
+void platformSetAutopilot(const AutopilotStep *steps, int count, int loopFrom);
+
+#endif
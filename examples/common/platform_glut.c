@@ -0,0 +1,68 @@
+#include <SDL2/SDL.h>
+
+#include "platform_glut.h"
+
+// Host-only; the PSP build links PSPGL's GLUT instead
+#ifndef __PSP__
+
+typedef struct
+{
+    unsigned int mode;
+    int width;
+    int height;
+    SDL_Window *window;
+    SDL_GLContext context;
+} Glut;
+
+static Glut gGlut = {GLUT_RGBA | GLUT_DOUBLE, 300, 300, NULL, NULL};
+
+void glutInit(int *argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+}
+
+void glutInitDisplayMode(unsigned int mode)
+{
+    gGlut.mode = mode;
+}
+
+void glutInitWindowSize(int width, int height)
+{
+    gGlut.width = width;
+    gGlut.height = height;
+}
+
+int glutCreateWindow(const char *title)
+{
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
+        return 0;
+
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, (gGlut.mode & GLUT_DOUBLE) ? 1 : 0);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, (gGlut.mode & GLUT_DEPTH) ? 16 : 0);
+
+    gGlut.window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                    gGlut.width, gGlut.height, SDL_WINDOW_OPENGL);
+    if (!gGlut.window)
+        return 0;
+
+    gGlut.context = SDL_GL_CreateContext(gGlut.window);
+    if (!gGlut.context)
+    {
+        SDL_DestroyWindow(gGlut.window);
+        gGlut.window = NULL;
+        return 0;
+    }
+
+    // Pacing comes from sceDisplayWaitVblankStart, as on the PSP
+    SDL_GL_SetSwapInterval(0);
+    return 1;
+}
+
+void glutSwapBuffers(void)
+{
+    if (gGlut.window)
+        SDL_GL_SwapWindow(gGlut.window);
+}
+
+#endif
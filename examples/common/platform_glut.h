@@ -0,0 +1,31 @@
+/**
+ * GLUT subset for the platform shim
+ *
+ * maze3d only uses GLUT to open its window and swap buffers. On the PSP that
+ * is PSPGL's GLUT; elsewhere these calls open an SDL window with an OpenGL
+ * context instead, so the host build needs no GLUT library and headless runs
+ * can use SDL's offscreen driver.
+ */
+
+#ifndef PLATFORM_GLUT_H
+#define PLATFORM_GLUT_H
+
+#ifdef __PSP__
+
+#include <GL/glut.h>
+
+#else
+
+#define GLUT_RGBA 0x0000
+#define GLUT_DOUBLE 0x0002
+#define GLUT_DEPTH 0x0010
+
+void glutInit(int *argc, char **argv);
+void glutInitDisplayMode(unsigned int mode);
+void glutInitWindowSize(int width, int height);
+int glutCreateWindow(const char *title);
+void glutSwapBuffers(void);
+
+#endif
+
+#endif
@@ -0,0 +1,240 @@
+#include <stdlib.h>
+
+#include "profiler.h"
+
+typedef struct
+{
+    Uint64 start;
+    Uint64 end;
+    unsigned char section;
+    unsigned char depth;
+} ProfileEvent;
+
+typedef struct
+{
+    float frameMs;
+    float sectionMs[PROFILER_MAX_SECTIONS];
+} ProfileFrame;
+
+typedef struct
+{
+    const char *names[PROFILER_MAX_SECTIONS];
+    int sectionCount;
+
+    int stack[PROFILER_MAX_DEPTH];
+    Uint64 stackStart[PROFILER_MAX_DEPTH];
+    int depth;
+
+    ProfileFrame current;
+    ProfileFrame history[PROFILER_HISTORY];
+    int frameCount; // Total frames finished; the ring index is frameCount % PROFILER_HISTORY
+
+    ProfileEvent events[PROFILER_MAX_EVENTS];
+    int eventCount;
+
+    Uint64 origin;
+    Uint64 frameStart;
+    double msPerTick;
+} Profiler;
+
+static Profiler gProfiler;
+
+static void ensureStarted(void)
+{
+    if (gProfiler.msPerTick == 0)
+    {
+        gProfiler.msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+        gProfiler.origin = SDL_GetPerformanceCounter();
+    }
+}
+
+static int findSection(const char *name)
+{
+    for (int i = 0; i < gProfiler.sectionCount; i++)
+    {
+        // Names are literals, so the pointer usually matches; fall back to the text
+        if (gProfiler.names[i] == name || SDL_strcmp(gProfiler.names[i], name) == 0)
+            return i;
+    }
+
+    if (gProfiler.sectionCount == PROFILER_MAX_SECTIONS)
+        return -1;
+
+    gProfiler.names[gProfiler.sectionCount] = name;
+    return gProfiler.sectionCount++;
+}
+
+void profilerBeginFrame(void)
+{
+    ensureStarted();
+    gProfiler.frameStart = SDL_GetPerformanceCounter();
+    SDL_memset(&gProfiler.current, 0, sizeof(gProfiler.current));
+    gProfiler.depth = 0;
+}
+
+void profilerEndFrame(void)
+{
+    if (gProfiler.frameStart == 0)
+        return;
+
+    // Unclosed sections are dropped rather than left to skew the next frame
+    gProfiler.depth = 0;
+
+    gProfiler.current.frameMs = (float)((SDL_GetPerformanceCounter() - gProfiler.frameStart) * gProfiler.msPerTick);
+    gProfiler.history[gProfiler.frameCount % PROFILER_HISTORY] = gProfiler.current;
+    gProfiler.frameCount++;
+}
+
+void profileBegin(const char *name)
+{
+    ensureStarted();
+
+    int section = findSection(name);
+    if (gProfiler.depth < PROFILER_MAX_DEPTH)
+    {
+        gProfiler.stack[gProfiler.depth] = section;
+        gProfiler.stackStart[gProfiler.depth] = SDL_GetPerformanceCounter();
+    }
+    gProfiler.depth++;
+}
+
+void profileEnd(void)
+{
+    if (gProfiler.depth == 0)
+        return;
+
+    gProfiler.depth--;
+    if (gProfiler.depth >= PROFILER_MAX_DEPTH)
+        return;
+
+    int section = gProfiler.stack[gProfiler.depth];
+    if (section < 0)
+        return;
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    Uint64 start = gProfiler.stackStart[gProfiler.depth];
+    gProfiler.current.sectionMs[section] += (float)((end - start) * gProfiler.msPerTick);
+
+    ProfileEvent *e = &gProfiler.events[gProfiler.eventCount % PROFILER_MAX_EVENTS];
+    e->start = start;
+    e->end = end;
+    e->section = (unsigned char)section;
+    e->depth = (unsigned char)gProfiler.depth;
+    gProfiler.eventCount++;
+}
+
+int profilerSectionCount(void)
+{
+    return gProfiler.sectionCount;
+}
+
+const char *profilerSectionName(int section)
+{
+    return section >= 0 && section < gProfiler.sectionCount ? gProfiler.names[section] : "frame";
+}
+
+int profilerFrameCount(void)
+{
+    return gProfiler.frameCount < PROFILER_HISTORY ? gProfiler.frameCount : PROFILER_HISTORY;
+}
+
+float profilerFrameMs(int section, int framesAgo)
+{
+    if (framesAgo < 0 || framesAgo >= profilerFrameCount())
+        return 0;
+
+    const ProfileFrame *f = &gProfiler.history[(gProfiler.frameCount - 1 - framesAgo) % PROFILER_HISTORY];
+    return section >= 0 && section < PROFILER_MAX_SECTIONS ? f->sectionMs[section] : f->frameMs;
+}
+
+static int compareFloats(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+void profilerStats(int section, int frames, ProfileStats *out)
+{
+    static float samples[PROFILER_HISTORY];
+
+    SDL_memset(out, 0, sizeof(*out));
+    if (frames > profilerFrameCount())
+        frames = profilerFrameCount();
+    if (frames <= 0)
+        return;
+
+    double sum = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        samples[i] = profilerFrameMs(section, i);
+        sum += samples[i];
+    }
+    qsort(samples, frames, sizeof(float), compareFloats);
+
+    // Nearest-rank percentiles
+    out->p50 = samples[(frames - 1) * 50 / 100];
+    out->p99 = samples[(frames - 1) * 99 / 100];
+    out->max = samples[frames - 1];
+    out->mean = (float)(sum / frames);
+}
+
+int profilerWriteCsv(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+
+    fprintf(f, "frame,frame_ms");
+    for (int s = 0; s < gProfiler.sectionCount; s++)
+        fprintf(f, ",%s_ms", gProfiler.names[s]);
+    fprintf(f, "\n");
+
+    int frames = profilerFrameCount();
+    int first = gProfiler.frameCount - frames;
+    for (int i = frames - 1; i >= 0; i--)
+    {
+        fprintf(f, "%d,%.4f", first + (frames - 1 - i), profilerFrameMs(-1, i));
+        for (int s = 0; s < gProfiler.sectionCount; s++)
+            fprintf(f, ",%.4f", profilerFrameMs(s, i));
+        fprintf(f, "\n");
+    }
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int profilerWriteTrace(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+
+    // Chrome trace event format: complete ("X") events with microsecond timestamps
+    fprintf(f, "{\"traceEvents\":[\n");
+
+    int count = gProfiler.eventCount < PROFILER_MAX_EVENTS ? gProfiler.eventCount : PROFILER_MAX_EVENTS;
+    int first = gProfiler.eventCount - count;
+    for (int i = 0; i < count; i++)
+    {
+        const ProfileEvent *e = &gProfiler.events[(first + i) % PROFILER_MAX_EVENTS];
+        double ts = (double)(e->start - gProfiler.origin) * gProfiler.msPerTick * 1000.0;
+        double dur = (double)(e->end - e->start) * gProfiler.msPerTick * 1000.0;
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                i ? ",\n" : "", gProfiler.names[e->section], ts, dur);
+    }
+
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+void profilerPrintSummary(FILE *out)
+{
+    ProfileStats stats;
+
+    fprintf(out, "%-10s %8s %8s %8s %8s  (%d frames)\n", "section", "mean", "p50", "p99", "max", profilerFrameCount());
+    for (int s = -1; s < gProfiler.sectionCount; s++)
+    {
+        profilerStats(s, PROFILER_HISTORY, &stats);
+        fprintf(out, "%-10s %8.3f %8.3f %8.3f %8.3f\n", profilerSectionName(s), stats.mean, stats.p50, stats.p99, stats.max);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * Frame profiler
+ *
+ * Named timers around parts of the frame (input, simulation, render, ...),
+ * a per-frame history of how long each took, and p50/p99 statistics over
+ * it. The history can be written out as CSV (one row per frame) and the
+ * individual timer events as a Chrome trace (chrome://tracing, Perfetto)
+ * so runs can be compared between commits.
+ *
+ * Only needs SDL's performance counter, so it runs the same on the PSP and
+ * on a desktop host. There is a single profiler per program.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+#include <SDL2/SDL.h>
+
+#define PROFILER_MAX_SECTIONS 12
+#define PROFILER_MAX_DEPTH 8
+// The buffers are static; the PSP build keeps about 75 KB of them instead of 620 KB
+#ifdef __PSP__
+#define PROFILER_HISTORY 512      // Frames kept for the CSV dump and statistics
+#define PROFILER_MAX_EVENTS 2048  // Timer events kept for the trace, newest win
+#else
+#define PROFILER_HISTORY 4096
+#define PROFILER_MAX_EVENTS 16384
+#endif
+#define PROFILER_STATS_FRAMES 120 // Window the overlay statistics cover
+
+typedef struct
+{
+    float p50;
+    float p99;
+    float max;
+    float mean;
+} ProfileStats; // Milliseconds
+
+// Marks the start of a frame; the time between two calls is the frame time
+void profilerBeginFrame(void);
+void profilerEndFrame(void);
+
+// name must outlive the profiler (use string literals). Sections may nest; a section
+// entered several times in one frame is summed.
+void profileBegin(const char *name);
+void profileEnd(void);
+
+// Times the statement or block that follows. Do not leave it with break, goto or return.
+#define PROFILE_SCOPE(name) \
+    for (int profile_once_ = (profileBegin(name), 0); !profile_once_; profile_once_ = (profileEnd(), 1))
+
+int profilerSectionCount(void);
+const char *profilerSectionName(int section);
+
+// Frames recorded so far, capped at PROFILER_HISTORY
+int profilerFrameCount(void);
+
+// Frame time, or section time when section >= 0, framesAgo frames back (0 = last finished frame)
+float profilerFrameMs(int section, int framesAgo);
+
+// Statistics over the last frames (at most PROFILER_HISTORY); section -1 is the whole frame
+void profilerStats(int section, int frames, ProfileStats *out);
+
+// Returns 0 on success, -1 if the file could not be written
+int profilerWriteCsv(const char *path);
+int profilerWriteTrace(const char *path);
+
+// One line per section with p50/p99/max over the whole history
+void profilerPrintSummary(FILE *out);
+
+#endif
@@ -0,0 +1,107 @@
+#include <SDL2/SDL_ttf.h>
+
+#include "profiler.h"
+#include "profiler_overlay.h"
+
+#define GRAPH_HEIGHT 40
+#define GRAPH_MAX_MS 33.3f    // Full graph height: two 60 Hz frames
+#define BUDGET_MS 16.7f
+#define PANEL_WIDTH 240
+
+int initProfilerOverlay(ProfilerOverlay *overlay, SDL_Renderer *renderer, const char *fontPath)
+{
+    SDL_memset(overlay, 0, sizeof(*overlay));
+
+    TTF_Font *font = TTF_OpenFont(fontPath, PROFILER_OVERLAY_FONT_SIZE);
+    if (!font)
+        return -1;
+
+    // The atlas keeps its own copy of the glyphs, so the font can go right away
+    int result = createTextAtlas(&overlay->atlas, renderer, font);
+    TTF_CloseFont(font);
+    return result;
+}
+
+static SDL_Color barColor(float ms)
+{
+    if (ms <= BUDGET_MS)
+        return (SDL_Color){0, 200, 0, 255};
+    if (ms <= BUDGET_MS * 2)
+        return (SDL_Color){230, 200, 0, 255};
+    return (SDL_Color){230, 40, 40, 255};
+}
+
+void drawProfilerOverlay(SDL_Renderer *renderer, ProfilerOverlay *overlay, int x, int y)
+{
+    if (!overlay->visible)
+        return;
+
+    int sections = profilerSectionCount();
+    int lineHeight = overlay->atlas.texture ? overlay->atlas.lineHeight : 0;
+    int panelHeight = GRAPH_HEIGHT + 4 + lineHeight * (sections + 1);
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &(SDL_Rect){x, y, PANEL_WIDTH, panelHeight});
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    // Oldest frame on the left; bars of one colour go out in a single call
+    SDL_Rect bars[PROFILER_OVERLAY_BARS];
+    int barWidth = PANEL_WIDTH / PROFILER_OVERLAY_BARS > 0 ? PANEL_WIDTH / PROFILER_OVERLAY_BARS : 1;
+    int frames = profilerFrameCount() < PROFILER_OVERLAY_BARS ? profilerFrameCount() : PROFILER_OVERLAY_BARS;
+
+    for (int pass = 0; pass < 3; pass++)
+    {
+        int count = 0;
+        SDL_Color color = {0, 0, 0, 255};
+
+        for (int i = 0; i < frames; i++)
+        {
+            float ms = profilerFrameMs(-1, i);
+            int band = ms <= BUDGET_MS ? 0 : (ms <= BUDGET_MS * 2 ? 1 : 2);
+            if (band != pass)
+                continue;
+
+            int h = (int)(ms * GRAPH_HEIGHT / GRAPH_MAX_MS);
+            if (h > GRAPH_HEIGHT)
+                h = GRAPH_HEIGHT;
+            if (h < 1)
+                h = 1;
+
+            bars[count++] = (SDL_Rect){x + (frames - 1 - i) * barWidth, y + GRAPH_HEIGHT - h, barWidth, h};
+            color = barColor(ms);
+        }
+
+        if (count > 0)
+        {
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRects(renderer, bars, count);
+        }
+    }
+
+    int budgetY = y + GRAPH_HEIGHT - (int)(BUDGET_MS * GRAPH_HEIGHT / GRAPH_MAX_MS);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawLine(renderer, x, budgetY, x + PANEL_WIDTH - 1, budgetY);
+
+    if (!overlay->atlas.texture)
+        return;
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color grey = {190, 190, 190, 255};
+    ProfileStats stats;
+    char line[64];
+    int textY = y + GRAPH_HEIGHT + 4;
+
+    for (int s = -1; s < sections; s++)
+    {
+        profilerStats(s, PROFILER_STATS_FRAMES, &stats);
+        snprintf(line, sizeof(line), "%-8s p50 %5.2f  p99 %5.2f ms", profilerSectionName(s), stats.p50, stats.p99);
+        drawAtlasText(renderer, &overlay->atlas, s < 0 ? white : grey, line, x + 2, textY);
+        textY += lineHeight;
+    }
+}
+
+void freeProfilerOverlay(ProfilerOverlay *overlay)
+{
+    freeTextAtlas(&overlay->atlas);
+}
@@ -0,0 +1,33 @@
+/**
+ * On-screen profiler overlay for SDL_Renderer examples
+ *
+ * Draws the recent frame times as a bar graph against the 60 Hz budget,
+ * followed by p50/p99 for the frame and for each profiled section.
+ */
+
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <SDL2/SDL.h>
+
+#include "text_atlas.h"
+
+#define PROFILER_OVERLAY_FONT_SIZE 10
+#define PROFILER_OVERLAY_BARS 120
+
+typedef struct
+{
+    TextAtlas atlas;
+    int visible;
+} ProfilerOverlay;
+
+// Builds a small glyph atlas from fontPath. Without it only the graph is drawn, so failure is not fatal.
+// Returns 0 on success, -1 if the font could not be loaded.
+int initProfilerOverlay(ProfilerOverlay *overlay, SDL_Renderer *renderer, const char *fontPath);
+
+// Draws nothing unless overlay->visible is set
+void drawProfilerOverlay(SDL_Renderer *renderer, ProfilerOverlay *overlay, int x, int y);
+
+void freeProfilerOverlay(ProfilerOverlay *overlay);
+
+#endif
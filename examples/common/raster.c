@@ -0,0 +1,355 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "raster.h"
+
+// Inverse depth at the near plane; a little under 65535 so interpolation overshoot cannot wrap
+#define DEPTH_SCALE 65000.0f
+
+// Fractional bits of the depth stepped along a span
+#define DEPTH_FRACTION 12
+
+static float edgeX(const RasterTriangle *t, int a, int b, float y)
+{
+    return t->x[a] + (y - t->y[a]) * (t->x[b] - t->x[a]) / (t->y[b] - t->y[a]);
+}
+
+// Clears the tile, then fills every triangle that reaches it. Returns the pixels written.
+static long fillTile(Raster *r, int tile)
+{
+    int x0 = (tile % RASTER_TILES_X) * RASTER_TILE_WIDTH;
+    int y0 = (tile / RASTER_TILES_X) * RASTER_TILE_HEIGHT;
+    int x1 = x0 + RASTER_TILE_WIDTH - 1;
+    int y1 = y0 + RASTER_TILE_HEIGHT - 1;
+    long pixels = 0;
+
+    for (int y = y0; y <= y1; y++)
+    {
+        uint32_t *c = r->color + y * r->pitch;
+        for (int x = x0; x <= x1; x++)
+            c[x] = r->clearColor;
+        memset(r->depth + y * RASTER_WIDTH + x0, 0, RASTER_TILE_WIDTH * sizeof(uint16_t));
+    }
+
+    for (int i = 0; i < r->triangleCount; i++)
+    {
+        const RasterTriangle *t = &r->triangles[i];
+        if (t->maxX < x0 || t->minX > x1 || t->maxY < y0 || t->minY > y1)
+            continue;
+
+        int top = t->minY > y0 ? t->minY : y0;
+        int bottom = t->maxY < y1 ? t->maxY : y1;
+        int32_t dz = (int32_t)(t->dzdx * (1 << DEPTH_FRACTION));
+
+        for (int y = top; y <= bottom; y++)
+        {
+            // Pixel centres between the long edge and whichever short edge spans this row
+            float py = y + 0.5f;
+            float xa = edgeX(t, 0, 2, py);
+            float xb = py < t->y[1] ? edgeX(t, 0, 1, py) : edgeX(t, 1, 2, py);
+            float left = xa < xb ? xa : xb;
+            float right = xa < xb ? xb : xa;
+
+            int start = (int)ceilf(left - 0.5f);
+            int end = (int)ceilf(right - 0.5f) - 1;
+            if (start < x0)
+                start = x0;
+            if (end > x1)
+                end = x1;
+            if (start > end)
+                continue;
+
+            float zStart = t->z + t->dzdx * (start + 0.5f - t->x[0]) + t->dzdy * (py - t->y[0]);
+            int32_t z = (int32_t)(zStart * (1 << DEPTH_FRACTION));
+            uint32_t *c = r->color + y * r->pitch;
+            uint16_t *d = r->depth + y * RASTER_WIDTH;
+
+            for (int x = start; x <= end; x++, z += dz)
+            {
+                int depth = z >> DEPTH_FRACTION;
+                if (depth > d[x])
+                {
+                    d[x] = (uint16_t)depth;
+                    c[x] = t->color;
+                    pixels++;
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+typedef struct
+{
+    Raster *raster;
+    SDL_Thread *workers[RASTER_MAX_THREADS];
+    int workerCount;
+
+    SDL_mutex *lock;
+    SDL_cond *start;
+    SDL_cond *done;
+    unsigned int generation; // Bumped once per frame to wake the workers
+    int busy;
+    int quit;
+
+    SDL_atomic_t nextTile;
+} RasterPool;
+
+// Takes tiles until none are left. Returns the pixels written.
+static long drawTiles(RasterPool *pool)
+{
+    long pixels = 0;
+    int tile;
+
+    while ((tile = SDL_AtomicAdd(&pool->nextTile, 1)) < RASTER_TILES)
+        pixels += fillTile(pool->raster, tile);
+    return pixels;
+}
+
+static int workerMain(void *arg)
+{
+    RasterPool *pool = arg;
+    unsigned int seen = 0;
+
+    for (;;)
+    {
+        SDL_LockMutex(pool->lock);
+        while (pool->generation == seen && !pool->quit)
+            SDL_CondWait(pool->start, pool->lock);
+        if (pool->quit)
+        {
+            SDL_UnlockMutex(pool->lock);
+            return 0;
+        }
+        seen = pool->generation;
+        SDL_UnlockMutex(pool->lock);
+
+        long pixels = drawTiles(pool);
+
+        SDL_LockMutex(pool->lock);
+        pool->raster->stats.pixels += pixels;
+        if (--pool->busy == 0)
+            SDL_CondSignal(pool->done);
+        SDL_UnlockMutex(pool->lock);
+    }
+}
+
+static void stopPool(RasterPool *pool)
+{
+    if (pool->lock)
+    {
+        SDL_LockMutex(pool->lock);
+        pool->quit = 1;
+        if (pool->start)
+            SDL_CondBroadcast(pool->start);
+        SDL_UnlockMutex(pool->lock);
+    }
+
+    for (int i = 0; i < pool->workerCount; i++)
+        SDL_WaitThread(pool->workers[i], NULL);
+
+    if (pool->done)
+        SDL_DestroyCond(pool->done);
+    if (pool->start)
+        SDL_DestroyCond(pool->start);
+    if (pool->lock)
+        SDL_DestroyMutex(pool->lock);
+    free(pool);
+}
+
+// Starts threads - 1 workers; the caller draws tiles too
+static RasterPool *startPool(Raster *r, int threads)
+{
+    RasterPool *pool = calloc(1, sizeof(RasterPool));
+    if (!pool)
+        return NULL;
+
+    pool->raster = r;
+    pool->lock = SDL_CreateMutex();
+    pool->start = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+
+    while (pool->lock && pool->start && pool->done && pool->workerCount < threads - 1)
+    {
+        pool->workers[pool->workerCount] = SDL_CreateThread(workerMain, "raster", pool);
+        if (!pool->workers[pool->workerCount])
+            break;
+        pool->workerCount++;
+    }
+
+    if (pool->workerCount == 0)
+    {
+        stopPool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static void drawFrame(Raster *r)
+{
+    RasterPool *pool = r->pool;
+
+    SDL_LockMutex(pool->lock);
+    SDL_AtomicSet(&pool->nextTile, 0);
+    pool->busy = pool->workerCount;
+    pool->generation++;
+    SDL_CondBroadcast(pool->start);
+    SDL_UnlockMutex(pool->lock);
+
+    long pixels = drawTiles(pool);
+
+    SDL_LockMutex(pool->lock);
+    while (pool->busy > 0)
+        SDL_CondWait(pool->done, pool->lock);
+    r->stats.pixels += pixels;
+    SDL_UnlockMutex(pool->lock);
+}
+
+int initRaster(Raster *r, int maxTriangles, int threads)
+{
+    memset(r, 0, sizeof(*r));
+
+    r->ownColor = malloc(RASTER_WIDTH * RASTER_HEIGHT * sizeof(uint32_t));
+    r->depth = malloc(RASTER_WIDTH * RASTER_HEIGHT * sizeof(uint16_t));
+    r->triangles = malloc((maxTriangles > 0 ? maxTriangles : 1) * sizeof(RasterTriangle));
+    if (!r->ownColor || !r->depth || !r->triangles)
+    {
+        freeRaster(r);
+        return -1;
+    }
+
+    r->color = r->ownColor;
+    r->pitch = RASTER_WIDTH;
+    r->nearDepth = 1.0f;
+    r->maxTriangles = maxTriangles;
+    r->threads = 1;
+
+    if (threads <= 0)
+        threads = SDL_GetCPUCount();
+    if (threads > RASTER_MAX_THREADS)
+        threads = RASTER_MAX_THREADS;
+
+    // Without workers the caller simply draws every tile itself
+    if (threads > 1 && (r->pool = startPool(r, threads)) != NULL)
+        r->threads = ((RasterPool *)r->pool)->workerCount + 1;
+
+    return 0;
+}
+
+void freeRaster(Raster *r)
+{
+    if (r->pool)
+        stopPool(r->pool);
+
+    free(r->ownColor);
+    free(r->depth);
+    free(r->triangles);
+    memset(r, 0, sizeof(*r));
+}
+
+void rasterSetTarget(Raster *r, void *pixels, int pitch)
+{
+    r->color = pixels ? pixels : r->ownColor;
+    r->pitch = pixels ? pitch / (int)sizeof(uint32_t) : RASTER_WIDTH;
+}
+
+void rasterBegin(Raster *r, uint32_t clearColor)
+{
+    r->clearColor = clearColor;
+    r->triangleCount = 0;
+    memset(&r->stats, 0, sizeof(r->stats));
+}
+
+int rasterTriangle(Raster *r, const float *x, const float *y, const float *z, uint32_t color)
+{
+    r->stats.submitted++;
+
+    // No clipping: anything reaching behind the near plane is dropped whole
+    if (r->triangleCount == r->maxTriangles || z[0] < r->nearDepth || z[1] < r->nearDepth || z[2] < r->nearDepth)
+    {
+        r->stats.culled++;
+        return 0;
+    }
+
+    // Screen y points down, so triangles facing the viewer have negative area
+    float e1x = x[1] - x[0], e1y = y[1] - y[0];
+    float e2x = x[2] - x[0], e2y = y[2] - y[0];
+    float area = e1x * e2y - e1y * e2x;
+    if (area >= 0)
+    {
+        r->stats.culled++;
+        return 0;
+    }
+
+    // Inverse depth is linear in screen space, so a plane through the three corners gives it everywhere
+    float w[3];
+    for (int k = 0; k < 3; k++)
+        w[k] = DEPTH_SCALE * r->nearDepth / z[k];
+
+    RasterTriangle *t = &r->triangles[r->triangleCount];
+    t->dzdx = ((w[1] - w[0]) * e2y - (w[2] - w[0]) * e1y) / area;
+    t->dzdy = ((w[2] - w[0]) * e1x - (w[1] - w[0]) * e2x) / area;
+
+    int order[3] = {0, 1, 2}, swap;
+    if (y[order[1]] < y[order[0]])
+        swap = order[0], order[0] = order[1], order[1] = swap;
+    if (y[order[2]] < y[order[1]])
+        swap = order[1], order[1] = order[2], order[2] = swap;
+    if (y[order[1]] < y[order[0]])
+        swap = order[0], order[0] = order[1], order[1] = swap;
+    for (int k = 0; k < 3; k++)
+    {
+        t->x[k] = x[order[k]];
+        t->y[k] = y[order[k]];
+    }
+    t->z = w[order[0]];
+
+    // Pixels whose centres lie inside, clamped to the screen
+    float minX = fminf(x[0], fminf(x[1], x[2]));
+    float maxX = fmaxf(x[0], fmaxf(x[1], x[2]));
+    int left = (int)ceilf(fmaxf(minX, 0) - 0.5f);
+    int right = (int)ceilf(fminf(maxX, RASTER_WIDTH) - 0.5f) - 1;
+    int top = (int)ceilf(fmaxf(t->y[0], 0) - 0.5f);
+    int bottom = (int)ceilf(fminf(t->y[2], RASTER_HEIGHT) - 0.5f) - 1;
+    if (left > right || top > bottom)
+    {
+        r->stats.culled++;
+        return 0;
+    }
+
+    t->minX = left;
+    t->maxX = right;
+    t->minY = top;
+    t->maxY = bottom;
+    t->color = color;
+    r->triangleCount++;
+    return 1;
+}
+
+void rasterMesh(Raster *r, const Vec3Array *screen, const Triangle *triangles, int count, const uint32_t *colors)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Triangle *tri = &triangles[i];
+        float x[3] = {screen->x[tri->a], screen->x[tri->b], screen->x[tri->c]};
+        float y[3] = {screen->y[tri->a], screen->y[tri->b], screen->y[tri->c]};
+        float z[3] = {screen->z[tri->a], screen->z[tri->b], screen->z[tri->c]};
+        rasterTriangle(r, x, y, z, colors[i]);
+    }
+}
+
+void rasterEnd(Raster *r)
+{
+    if (r->pool)
+    {
+        drawFrame(r);
+        return;
+    }
+
+    for (int tile = 0; tile < RASTER_TILES; tile++)
+        r->stats.pixels += fillTile(r, tile);
+}
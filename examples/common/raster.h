@@ -0,0 +1,103 @@
+/**
+ * Software triangle rasterizer
+ *
+ * Fills flat-coloured triangles into a 32-bit ARGB framebuffer at the PSP
+ * resolution, with a 16-bit inverse-depth buffer (larger is nearer) and
+ * back-face culling. Triangles are collected for a frame and then drawn tile
+ * by tile: each tile clears its own part of both buffers and scanline-fills
+ * the triangles whose bounds overlap it, so a tile's pixels stay in cache
+ * and tiles never share memory. On multicore hosts the tiles are spread over
+ * SDL worker threads; the PSP draws them in turn on its one CPU. The output
+ * is the same either way.
+ *
+ * The target can be the rasterizer's own buffer or a locked streaming
+ * SDL_Texture, so filled meshes work on any SDL renderer.
+ */
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+
+#include "transform.h"
+
+#define RASTER_WIDTH 480
+#define RASTER_HEIGHT 272
+
+// 8 x 4 tiles of 60 x 68 pixels
+#define RASTER_TILE_WIDTH 60
+#define RASTER_TILE_HEIGHT 68
+#define RASTER_TILES_X (RASTER_WIDTH / RASTER_TILE_WIDTH)
+#define RASTER_TILES_Y (RASTER_HEIGHT / RASTER_TILE_HEIGHT)
+#define RASTER_TILES (RASTER_TILES_X * RASTER_TILES_Y)
+
+#define RASTER_MAX_THREADS 16
+
+// Set up once per triangle; the tiles only read it
+typedef struct
+{
+    float x[3], y[3];     // Screen positions, sorted top to bottom
+    float z, dzdx, dzdy;  // Inverse depth at (x[0], y[0]) and its screen gradient
+    short minX, maxX;     // Pixel bounds, inclusive
+    short minY, maxY;
+    uint32_t color;
+} RasterTriangle;
+
+typedef struct
+{
+    int submitted;
+    int culled; // Back-facing, behind the near plane or covering no pixel centre
+    long pixels; // Pixels that passed the depth test
+} RasterStats;
+
+typedef struct
+{
+    uint32_t *color; // Current target, pitch in pixels
+    int pitch;
+    uint32_t *ownColor;
+    uint16_t *depth;
+
+    // Depths below this are dropped, and map to the largest depth buffer value
+    float nearDepth;
+    uint32_t clearColor;
+
+    RasterTriangle *triangles;
+    int triangleCount;
+    int maxTriangles;
+    RasterStats stats;
+
+    int threads;
+    void *pool;
+} Raster;
+
+/*
+ * Allocates the buffers and room for maxTriangles per frame. threads is the
+ * number of threads drawing tiles, including the caller; 0 means one per
+ * CPU as SDL_GetCPUCount reports it, so 1 on the PSP. The workers keep a
+ * pointer to r, so it must not move until freeRaster. Returns 0 on success,
+ * -1 on failure.
+ */
+int initRaster(Raster *r, int maxTriangles, int threads);
+void freeRaster(Raster *r);
+
+// Draw into pixels (ARGB8888, pitch in bytes) instead of the own buffer until the next call; NULL goes back
+void rasterSetTarget(Raster *r, void *pixels, int pitch);
+
+// Starts a frame: drops the collected triangles and resets the stats
+void rasterBegin(Raster *r, uint32_t clearColor);
+
+/*
+ * Adds one triangle in screen space; z is depth as transformProject writes
+ * it (eye distance + rotated z). Counter-clockwise triangles in object space
+ * face the viewer and are kept, the rest are culled. Returns 1 if the
+ * triangle will be drawn.
+ */
+int rasterTriangle(Raster *r, const float *x, const float *y, const float *z, uint32_t color);
+
+// Adds count triangles indexing screen, one colour each
+void rasterMesh(Raster *r, const Vec3Array *screen, const Triangle *triangles, int count, const uint32_t *colors);
+
+// Clears the target and depth buffer and draws everything added since rasterBegin
+void rasterEnd(Raster *r);
+
+#endif
@@ -0,0 +1,273 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+// Record tags. Below TAG_SEED a tag is a pad update whose bits say what follows.
+#define PAD_HELD 0x01  // Held buttons changed: u32 held
+#define PAD_STICK 0x02 // Analog nub moved: lx, ly
+#define PAD_EDGES 0x04 // Edges other than the held change implies (taps between updates): u32 pressed, released
+#define TAG_SEED 0x40  // u32 seed
+#define TAG_TICKS 0x80 // Tick count in the low 7 bits
+
+enum
+{
+    REPLAY_OFF,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+};
+
+typedef struct
+{
+    FILE *file;
+    int mode;
+    int finished;
+    const char *path;
+    long records;
+    long bytes;
+    ReplayPad last; // Pad after the previous update, what the next record is relative to
+} Replay;
+
+static Replay gReplay;
+
+static void putU32(unsigned int v)
+{
+    unsigned char b[4] = {(unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24)};
+    fwrite(b, 1, 4, gReplay.file);
+    gReplay.bytes += 4;
+}
+
+static void putByte(int v)
+{
+    fputc(v, gReplay.file);
+    gReplay.bytes++;
+}
+
+static int getU32(unsigned int *v)
+{
+    unsigned char b[4];
+    if (fread(b, 1, 4, gReplay.file) != 4)
+        return -1;
+    *v = b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+    gReplay.bytes += 4;
+    return 0;
+}
+
+static void finishReplay(const char *problem)
+{
+    if (problem)
+        fprintf(stderr, "replay: %s: %s after %ld records\n", gReplay.path, problem, gReplay.records);
+    gReplay.finished = 1;
+}
+
+// Next record's tag when replaying, or -1 if the file has run out or holds something else
+static int nextTag(int expected)
+{
+    if (gReplay.mode != REPLAY_PLAY || gReplay.finished)
+        return -1;
+
+    int tag = fgetc(gReplay.file);
+    if (tag == EOF)
+    {
+        finishReplay(NULL);
+        return -1;
+    }
+    gReplay.bytes++;
+
+    int kind = tag & TAG_TICKS ? TAG_TICKS : tag & TAG_SEED ? TAG_SEED : 0;
+    if (kind != expected)
+    {
+        finishReplay("out of step with the recording");
+        return -1;
+    }
+
+    gReplay.records++;
+    return tag;
+}
+
+static int openReplay(const char *path, int mode)
+{
+    stopReplay();
+
+    gReplay.file = fopen(path, mode == REPLAY_RECORD ? "wb" : "rb");
+    if (!gReplay.file)
+        return -1;
+
+    gReplay.mode = mode;
+    gReplay.path = path;
+    gReplay.finished = 0;
+    gReplay.records = 0;
+    gReplay.bytes = 0;
+    memset(&gReplay.last, 0, sizeof(gReplay.last));
+    gReplay.last.lx = 128;
+    gReplay.last.ly = 128;
+
+    if (mode == REPLAY_RECORD)
+    {
+        putU32(REPLAY_MAGIC);
+        putU32(REPLAY_VERSION);
+    }
+    else
+    {
+        unsigned int magic, version;
+        if (getU32(&magic) != 0 || getU32(&version) != 0 || magic != REPLAY_MAGIC || version != REPLAY_VERSION)
+        {
+            fclose(gReplay.file);
+            gReplay.file = NULL;
+            gReplay.mode = REPLAY_OFF;
+            return -1;
+        }
+    }
+
+    static int registered = 0;
+    if (!registered)
+    {
+        atexit(stopReplay);
+        registered = 1;
+    }
+    return 0;
+}
+
+int startRecording(const char *path)
+{
+    return openReplay(path, REPLAY_RECORD);
+}
+
+int startReplay(const char *path)
+{
+    return openReplay(path, REPLAY_PLAY);
+}
+
+void stopReplay(void)
+{
+    if (gReplay.file)
+        fclose(gReplay.file);
+    gReplay.file = NULL;
+    if (gReplay.mode == REPLAY_PLAY)
+        gReplay.finished = 1;
+}
+
+int recording(void)
+{
+    return gReplay.mode == REPLAY_RECORD && gReplay.file;
+}
+
+int replaying(void)
+{
+    return gReplay.mode == REPLAY_PLAY;
+}
+
+int replayFinished(void)
+{
+    return gReplay.mode == REPLAY_PLAY && gReplay.finished;
+}
+
+unsigned int replaySeed(unsigned int seed)
+{
+    if (recording())
+    {
+        putByte(TAG_SEED);
+        putU32(seed);
+        gReplay.records++;
+    }
+    else if (nextTag(TAG_SEED) >= 0 && getU32(&seed) != 0)
+    {
+        finishReplay("truncated");
+    }
+    return seed;
+}
+
+int replayTicks(int ticks)
+{
+    if (recording())
+    {
+        putByte(TAG_TICKS | (ticks < 0 ? 0 : ticks > 127 ? 127 : ticks));
+        gReplay.records++;
+        return ticks;
+    }
+
+    int tag = nextTag(TAG_TICKS);
+    return tag >= 0 ? tag & ~TAG_TICKS : ticks;
+}
+
+void recordPad(const ReplayPad *pad)
+{
+    if (!recording())
+        return;
+
+    const ReplayPad *last = &gReplay.last;
+    int tag = 0;
+    if (pad->held != last->held)
+        tag |= PAD_HELD;
+    if (pad->lx != last->lx || pad->ly != last->ly)
+        tag |= PAD_STICK;
+    if (pad->pressed != (pad->held & ~last->held) || pad->released != (last->held & ~pad->held))
+        tag |= PAD_EDGES;
+
+    putByte(tag);
+    if (tag & PAD_HELD)
+        putU32(pad->held);
+    if (tag & PAD_STICK)
+    {
+        putByte(pad->lx);
+        putByte(pad->ly);
+    }
+    if (tag & PAD_EDGES)
+    {
+        putU32(pad->pressed);
+        putU32(pad->released);
+    }
+
+    gReplay.last = *pad;
+    gReplay.records++;
+}
+
+int replayPad(ReplayPad *pad)
+{
+    int tag = nextTag(0);
+    if (tag < 0)
+        return 0;
+
+    ReplayPad next = gReplay.last;
+    int failed = 0;
+    if (tag & PAD_HELD)
+        failed |= getU32(&next.held);
+    if (tag & PAD_STICK)
+    {
+        int lx = fgetc(gReplay.file);
+        int ly = fgetc(gReplay.file);
+        failed |= lx == EOF || ly == EOF;
+        next.lx = (unsigned char)lx;
+        next.ly = (unsigned char)ly;
+        gReplay.bytes += 2;
+    }
+    if (tag & PAD_EDGES)
+    {
+        failed |= getU32(&next.pressed);
+        failed |= getU32(&next.released);
+    }
+    else
+    {
+        next.pressed = next.held & ~gReplay.last.held;
+        next.released = gReplay.last.held & ~next.held;
+    }
+
+    if (failed)
+    {
+        finishReplay("truncated");
+        return 0;
+    }
+
+    gReplay.last = next;
+    *pad = next;
+    return 1;
+}
+
+void replayPrintSummary(FILE *out)
+{
+    if (gReplay.mode == REPLAY_RECORD)
+        fprintf(out, "recorded %ld records (%.1f KB) to %s\n", gReplay.records, gReplay.bytes / 1024.0, gReplay.path);
+    else if (gReplay.mode == REPLAY_PLAY)
+        fprintf(out, "replayed %ld records (%.1f KB) from %s%s\n", gReplay.records, gReplay.bytes / 1024.0,
+                gReplay.path, gReplay.finished ? "" : ", stopped before its end");
+}
@@ -0,0 +1,65 @@
+/**
+ * Input recording and replay
+ *
+ * --record=FILE logs everything a run's outcome depends on besides code:
+ * the random seeds it drew, the pad state at every input update, and how
+ * many fixed simulation ticks each frame ran. --replay=FILE feeds the same
+ * values back in the same order instead of reading the pad, the clock or
+ * time(), so a run follows the same path on any machine and at any frame
+ * rate. Headless replays are what makes frame times and allocation counts
+ * comparable between commits.
+ *
+ * The file is a small header followed by one record per call, most of
+ * them a single byte: a frame whose pad did not change is one byte, and
+ * so is a tick count. A replay that meets a record of the wrong kind has
+ * run different code from the recording; it stops there and says so.
+ *
+ * There is a single recording or replay per program, started by
+ * platformInit.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+
+#define REPLAY_MAGIC 0x4C50524Du // "MRPL"
+#define REPLAY_VERSION 1
+
+typedef struct
+{
+    unsigned int held;
+    unsigned int pressed;  // Went down since the last update
+    unsigned int released; // Went up since the last update
+    unsigned char lx;
+    unsigned char ly;
+} ReplayPad;
+
+// Return 0 on success, -1 if the file cannot be opened or is not a recording
+int startRecording(const char *path);
+int startReplay(const char *path);
+
+// Closes the file; also run at exit
+void stopReplay(void);
+
+int recording(void);
+int replaying(void);
+
+// Set once a replay has used up its file or lost step with it
+int replayFinished(void);
+
+// Each takes the live value and returns what the run should use: the
+// live one (logged when recording) or the recorded one when replaying
+unsigned int replaySeed(unsigned int seed);
+int replayTicks(int ticks);
+
+// Logs one input update while recording
+void recordPad(const ReplayPad *pad);
+
+// The next input update while replaying. Returns 0 once there are none.
+int replayPad(ReplayPad *pad);
+
+// One line with the records and bytes written or read so far, and the file
+void replayPrintSummary(FILE *out);
+
+#endif
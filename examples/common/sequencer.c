@@ -0,0 +1,239 @@
+#include <math.h>
+
+#include "sequencer.h"
+
+#define TABLE_BITS 10
+#define TABLE_SIZE (1 << TABLE_BITS)
+#define FRACTION_BITS 16 // Of the phase below the table index, used to interpolate
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// One sine cycle plus a copy of the first entry, so interpolation never wraps
+static Sint16 sineTable[TABLE_SIZE + 1];
+static int tableReady = 0;
+
+// Any address that is not a pattern; tells the audio thread to stop a voice
+static char stopRequest;
+
+static void buildTable(void)
+{
+    for (int i = 0; i < TABLE_SIZE; i++)
+        sineTable[i] = (Sint16)lrint(32767.0 * sin(2.0 * M_PI * i / TABLE_SIZE));
+    sineTable[TABLE_SIZE] = sineTable[0];
+    tableReady = 1;
+}
+
+static int msToSamples(int ms, int rate)
+{
+    return (int)((Sint64)ms * rate / 1000);
+}
+
+void initSequencer(Sequencer *s, int rate, int channels)
+{
+    if (!tableReady)
+        buildTable();
+
+    SDL_memset(s, 0, sizeof(*s));
+    s->rate = rate;
+    s->channels = channels;
+    SDL_AtomicSet(&s->volume, SEQUENCER_MAX_VOLUME);
+}
+
+void playVoice(Sequencer *s, int voice, const SynthPattern *pattern)
+{
+    if (voice < 0 || voice >= SEQUENCER_VOICES)
+        return;
+    SDL_AtomicSetPtr(&s->voices[voice].pending, pattern ? (void *)pattern : (void *)&stopRequest);
+}
+
+int voicePlaying(Sequencer *s, int voice)
+{
+    if (voice < 0 || voice >= SEQUENCER_VOICES)
+        return 0;
+
+    // A pattern that is queued but not yet picked up counts as playing
+    void *pending = SDL_AtomicGetPtr(&s->voices[voice].pending);
+    if (pending)
+        return pending != &stopRequest;
+    return SDL_AtomicGetPtr(&s->voices[voice].active) != NULL;
+}
+
+void setSequencerVolume(Sequencer *s, int volume)
+{
+    if (volume < 0)
+        volume = 0;
+    if (volume > SEQUENCER_MAX_VOLUME)
+        volume = SEQUENCER_MAX_VOLUME;
+    SDL_AtomicSet(&s->volume, volume);
+}
+
+void pauseSequencer(Sequencer *s, int paused)
+{
+    SDL_AtomicSet(&s->paused, paused);
+}
+
+int sequencerPaused(Sequencer *s)
+{
+    return SDL_AtomicGet(&s->paused);
+}
+
+int patternSamples(const SynthPattern *pattern, int rate)
+{
+    int total = 0;
+    for (int i = 0; i < pattern->count; i++)
+        total += msToSamples(pattern->notes[i].steps * pattern->stepMs, rate);
+    return total;
+}
+
+static void startNote(SynthVoice *v, int rate)
+{
+    const SynthNote *note = &v->pattern->notes[v->note];
+    v->position = 0;
+    v->length = msToSamples(note->steps * v->pattern->stepMs, rate);
+    v->phase = 0;
+    v->step = (Uint32)(((Uint64)note->frequency << 32) / (Uint64)rate);
+}
+
+static void startPattern(SynthVoice *v, const SynthPattern *pattern, int rate)
+{
+    // A pattern with no length would spin forever looking for its next sample
+    v->pattern = pattern && patternSamples(pattern, rate) > 0 ? pattern : NULL;
+    SDL_AtomicSetPtr(&v->active, (void *)v->pattern);
+    if (!v->pattern)
+        return;
+
+    v->note = 0;
+    v->attack = msToSamples(pattern->attackMs, rate);
+    v->release = msToSamples(pattern->releaseMs, rate);
+    startNote(v, rate);
+}
+
+// Moves to the next note; returns 0 when a one-shot pattern has finished
+static int nextNote(SynthVoice *v, int rate)
+{
+    if (++v->note == v->pattern->count)
+    {
+        if (!v->pattern->loop)
+        {
+            v->pattern = NULL;
+            SDL_AtomicSetPtr(&v->active, NULL);
+            return 0;
+        }
+        v->note = 0;
+    }
+    startNote(v, rate);
+    return 1;
+}
+
+// Envelope gain in 1/32768ths, as the original fades: ramp in over attack, out over the last release samples
+static int envelope(const SynthVoice *v, int attackScale, int releaseScale)
+{
+    int remaining = v->length - v->position;
+    if (v->position < v->attack)
+        return (v->position * attackScale) >> 14;
+    if (remaining < v->release)
+        return (remaining * releaseScale) >> 14;
+    return 32768;
+}
+
+// Adds up to frames samples of one voice into acc
+static void renderVoice(SynthVoice *v, int rate, int *acc, int frames)
+{
+    int amplitude = v->pattern->amplitude;
+    // (1 << 29) / n: position * scale stays under 2^29 for position < n
+    int attackScale = v->attack > 0 ? (1 << 29) / v->attack : 0;
+    int releaseScale = v->release > 0 ? (1 << 29) / v->release : 0;
+
+    int i = 0;
+    while (i < frames)
+    {
+        if (v->position == v->length && !nextNote(v, rate))
+            return;
+
+        int run = v->length - v->position;
+        if (run > frames - i)
+            run = frames - i;
+
+        if (v->step == 0)
+        {
+            // A rest: time passes, nothing sounds
+            v->position += run;
+            i += run;
+            continue;
+        }
+
+        for (int end = i + run; i < end; i++)
+        {
+            Uint32 index = v->phase >> (32 - TABLE_BITS);
+            int fraction = (v->phase >> (32 - TABLE_BITS - FRACTION_BITS)) & ((1 << FRACTION_BITS) - 1);
+            int a = sineTable[index];
+            int sample = a + (((sineTable[index + 1] - a) * fraction) >> FRACTION_BITS);
+
+            sample = (sample * amplitude) >> 15;
+            acc[i] += (sample * envelope(v, attackScale, releaseScale)) >> 15;
+
+            v->phase += v->step;
+            v->position++;
+        }
+    }
+}
+
+void mixSequencer(Sequencer *s, Sint16 *out, int frames)
+{
+    for (int k = 0; k < SEQUENCER_VOICES; k++)
+    {
+        SynthVoice *v = &s->voices[k];
+        void *request = SDL_AtomicSetPtr(&v->pending, NULL);
+        if (request)
+            startPattern(v, request == &stopRequest ? NULL : request, s->rate);
+    }
+
+    if (SDL_AtomicGet(&s->paused))
+        return;
+
+    int volume = SDL_AtomicGet(&s->volume);
+    int acc[SEQUENCER_BLOCK];
+
+    while (frames > 0)
+    {
+        int block = frames < SEQUENCER_BLOCK ? frames : SEQUENCER_BLOCK;
+        int active = 0;
+        SDL_memset(acc, 0, block * sizeof(int));
+
+        for (int k = 0; k < SEQUENCER_VOICES; k++)
+        {
+            if (s->voices[k].pattern)
+            {
+                renderVoice(&s->voices[k], s->rate, acc, block);
+                active = 1;
+            }
+        }
+
+        if (active)
+        {
+            for (int i = 0; i < block; i++)
+            {
+                int sample = (acc[i] * volume) / SEQUENCER_MAX_VOLUME;
+                for (int c = 0; c < s->channels; c++)
+                {
+                    int mixed = out[c] + sample;
+                    out[c] = (Sint16)(mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed));
+                }
+                out += s->channels;
+            }
+        }
+        else
+        {
+            out += block * s->channels;
+        }
+        frames -= block;
+    }
+}
+
+void sequencerHook(void *userdata, Uint8 *stream, int len)
+{
+    Sequencer *s = userdata;
+    mixSequencer(s, (Sint16 *)stream, len / (int)(sizeof(Sint16) * s->channels));
+}
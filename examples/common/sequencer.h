@@ -0,0 +1,92 @@
+/**
+ * Streaming step sequencer
+ *
+ * Plays note patterns on a few voices and mixes them block by block inside
+ * the audio callback, so a song costs the same memory however long it runs.
+ * Each voice is a wavetable sine oscillator, a 32-bit phase accumulator
+ * stepping through one shared 1024-entry table with linear interpolation,
+ * under a linear attack/release envelope per note. All per-sample work is
+ * integer.
+ *
+ * Songs are plain data: a pattern is an array of notes (frequency, length
+ * in steps) plus the step length, level and envelope. The main thread
+ * starts and stops patterns with single atomic pointer stores and the audio
+ * thread picks them up at the start of its next block, so neither side
+ * takes a lock.
+ */
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <SDL2/SDL.h>
+
+#define SEQUENCER_VOICES 8
+#define SEQUENCER_BLOCK 256       // Frames mixed per pass
+#define SEQUENCER_MAX_VOLUME 128  // Same scale as MIX_MAX_VOLUME
+
+typedef struct
+{
+    Uint16 frequency; // Hz, 0 for a rest
+    Uint16 steps;     // Length in steps
+} SynthNote;
+
+typedef struct
+{
+    const SynthNote *notes;
+    int count;
+    int stepMs;    // Length of one step
+    int amplitude; // Peak sample value, up to 32767
+    int attackMs;  // Linear fade in at the start of each note
+    int releaseMs; // Linear fade out at the end of each note
+    int loop;
+} SynthPattern;
+
+typedef struct
+{
+    void *pending; // Next pattern (or a stop request) from playVoice, taken by the audio thread
+    void *active;  // Pattern playing, published by the audio thread for voicePlaying
+
+    // Audio thread only
+    const SynthPattern *pattern;
+    int note;
+    int position; // Samples into the current note
+    int length;   // Samples in the current note
+    int attack;
+    int release;
+    Uint32 phase;
+    Uint32 step; // Phase increment per sample, 2^32 per cycle
+} SynthVoice;
+
+typedef struct
+{
+    int rate;
+    int channels;
+    SDL_atomic_t volume;
+    SDL_atomic_t paused;
+    SynthVoice voices[SEQUENCER_VOICES];
+} Sequencer;
+
+// Output is interleaved signed 16-bit samples, channels per frame. The
+// first call also builds the shared wavetable, so make it on the main
+// thread before any other thread renders.
+void initSequencer(Sequencer *s, int rate, int channels);
+
+// Starts pattern on a voice from the beginning, replacing whatever it played; NULL stops the voice
+void playVoice(Sequencer *s, int voice, const SynthPattern *pattern);
+int voicePlaying(Sequencer *s, int voice);
+
+void setSequencerVolume(Sequencer *s, int volume);
+// A paused sequencer outputs nothing and keeps its place
+void pauseSequencer(Sequencer *s, int paused);
+int sequencerPaused(Sequencer *s);
+
+// Adds frames of every playing voice into out, clamped to 16 bits
+void mixSequencer(Sequencer *s, Sint16 *out, int frames);
+
+// SDL audio callback or Mix_HookMusic hook for AUDIO_S16SYS; userdata is the Sequencer
+void sequencerHook(void *userdata, Uint8 *stream, int len);
+
+// Samples one pass through pattern takes at rate
+int patternSamples(const SynthPattern *pattern, int rate);
+
+#endif
@@ -0,0 +1,101 @@
+#include "synth.h"
+
+static void putLE16(Uint8 *p, Uint16 v)
+{
+    p[0] = (Uint8)v;
+    p[1] = (Uint8)(v >> 8);
+}
+
+static void putLE32(Uint8 *p, Uint32 v)
+{
+    putLE16(p, (Uint16)v);
+    putLE16(p + 2, (Uint16)(v >> 16));
+}
+
+int allocSynthSound(SynthSound *sound, int rate, int count)
+{
+    SDL_memset(sound, 0, sizeof(*sound));
+    if (rate <= 0 || count <= 0)
+        return -1;
+
+    Uint32 dataSize = (Uint32)count * 2;
+    sound->wav = SDL_calloc(1, SYNTH_WAV_HEADER + dataSize);
+    if (!sound->wav)
+        return -1;
+
+    sound->samples = (Sint16 *)(sound->wav + SYNTH_WAV_HEADER);
+    sound->count = count;
+    sound->rate = rate;
+
+    // Mono 16-bit PCM
+    Uint8 *h = sound->wav;
+    SDL_memcpy(h, "RIFF", 4);
+    putLE32(h + 4, 36 + dataSize);
+    SDL_memcpy(h + 8, "WAVEfmt ", 8);
+    putLE32(h + 16, 16);
+    putLE16(h + 20, 1);
+    putLE16(h + 22, 1);
+    putLE32(h + 24, (Uint32)rate);
+    putLE32(h + 28, (Uint32)rate * 2);
+    putLE16(h + 32, 2);
+    putLE16(h + 34, 16);
+    SDL_memcpy(h + 36, "data", 4);
+    putLE32(h + 40, dataSize);
+    return 0;
+}
+
+void freeSynthSound(SynthSound *sound)
+{
+    SDL_free(sound->wav);
+    SDL_memset(sound, 0, sizeof(*sound));
+}
+
+int synthWavSize(const SynthSound *sound)
+{
+    return SYNTH_WAV_HEADER + sound->count * 2;
+}
+
+int renderSynthPattern(SynthSound *sound, const SynthPattern *pattern, int rate)
+{
+    if (allocSynthSound(sound, rate, patternSamples(pattern, rate)) < 0)
+        return -1;
+
+    // The same voice code the audio callback runs, driven offline
+    Sequencer sequencer;
+    initSequencer(&sequencer, rate, 1);
+    playVoice(&sequencer, 0, pattern);
+    mixSequencer(&sequencer, sound->samples, sound->count);
+
+    // WAV samples are little-endian whatever the CPU
+    for (int i = 0; i < sound->count; i++)
+        putLE16((Uint8 *)&sound->samples[i], (Uint16)sound->samples[i]);
+    return 0;
+}
+
+Mix_Chunk *synthChunk(const SynthSound *sound)
+{
+    if (!sound->wav)
+        return NULL;
+    return Mix_LoadWAV_RW(SDL_RWFromConstMem(sound->wav, synthWavSize(sound)), 1);
+}
+
+Mix_Music *synthMusic(const SynthSound *sound)
+{
+    if (!sound->wav)
+        return NULL;
+    return Mix_LoadMUS_RW(SDL_RWFromConstMem(sound->wav, synthWavSize(sound)), 1);
+}
+
+int saveSynthSound(const SynthSound *sound, const char *path)
+{
+    if (!sound->wav)
+        return -1;
+
+    SDL_RWops *file = SDL_RWFromFile(path, "wb");
+    if (!file)
+        return -1;
+
+    size_t written = SDL_RWwrite(file, sound->wav, synthWavSize(sound), 1);
+    SDL_RWclose(file);
+    return written == 1 ? 0 : -1;
+}
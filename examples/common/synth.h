@@ -0,0 +1,54 @@
+/**
+ * In-memory sound synthesis for SDL_mixer
+ *
+ * Sequencer patterns are rendered straight into a mono 16-bit WAV image
+ * in memory, header included, and handed to SDL_mixer through
+ * SDL_RWFromConstMem: no file is written or read. Chunks are decoded into the mixer's format and
+ * no longer need the image; music streams from it, so the image is the
+ * only copy of the samples and must outlive the Mix_Music. Writing the
+ * image to disk is a separate, explicit step for when a WAV file is wanted.
+ *
+ * This suits short effects that SDL_mixer should mix on its own channels.
+ * Music is better streamed by the sequencer itself (sequencer.h), which
+ * needs no buffer at all. Rendering touches no SDL state, so sounds can be
+ * built on a worker thread and turned into chunks on the main thread.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include "sequencer.h"
+
+#define SYNTH_WAV_HEADER 44
+
+typedef struct
+{
+    Uint8 *wav;      // RIFF header followed by the samples
+    Sint16 *samples; // Little-endian, inside wav
+    int count;
+    int rate;
+} SynthSound;
+
+// Allocates count silent samples at rate Hz. Returns 0 on success, -1 if out of memory.
+int allocSynthSound(SynthSound *sound, int rate, int count);
+void freeSynthSound(SynthSound *sound);
+
+// Size of the WAV image in bytes
+int synthWavSize(const SynthSound *sound);
+
+// Allocates the sound and renders one pass of pattern into it. Returns 0 on success.
+int renderSynthPattern(SynthSound *sound, const SynthPattern *pattern, int rate);
+
+// Decodes the image into a chunk in the mixer's format; the sound can be freed afterwards
+Mix_Chunk *synthChunk(const SynthSound *sound);
+
+// Music streamed from the image; free the music before the sound
+Mix_Music *synthMusic(const SynthSound *sound);
+
+// Writes the image as a WAV file. Returns 0 on success.
+int saveSynthSound(const SynthSound *sound, const char *path);
+
+#endif
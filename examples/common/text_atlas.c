@@ -0,0 +1,181 @@
+#include "text_atlas.h"
+
+#define ATLAS_WIDTH 256
+#define GLYPH_PADDING 1
+
+static int nextPowerOfTwo(int v)
+{
+    int p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+
+int createTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer, TTF_Font *font)
+{
+    SDL_Surface *glyphSurfaces[TEXT_ATLAS_GLYPHS];
+    SDL_Color white = {255, 255, 255, 255};
+    int result = -1;
+
+    SDL_memset(atlas, 0, sizeof(*atlas));
+    atlas->lineHeight = TTF_FontLineSkip(font);
+
+    // Rasterize every glyph and shelf-pack it into rows of ATLAS_WIDTH
+    int penX = 0;
+    int penY = 0;
+    int rowHeight = 0;
+
+    for (int i = 0; i < TEXT_ATLAS_GLYPHS; i++)
+    {
+        Uint16 ch = (Uint16)(TEXT_ATLAS_FIRST_CHAR + i);
+        Glyph *g = &atlas->glyphs[i];
+
+        int advance = 0;
+        TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &advance);
+        g->advance = advance;
+
+        glyphSurfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!glyphSurfaces[i])
+            continue;
+
+        int w = glyphSurfaces[i]->w;
+        int h = glyphSurfaces[i]->h;
+
+        if (penX + w > ATLAS_WIDTH)
+        {
+            penX = 0;
+            penY += rowHeight + GLYPH_PADDING;
+            rowHeight = 0;
+        }
+
+        g->src = (SDL_Rect){penX, penY, w, h};
+        penX += w + GLYPH_PADDING;
+        if (h > rowHeight)
+            rowHeight = h;
+    }
+
+    atlas->w = ATLAS_WIDTH;
+    atlas->h = nextPowerOfTwo(penY + rowHeight);
+
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas->w, atlas->h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (sheet)
+    {
+        SDL_FillRect(sheet, NULL, 0);
+
+        for (int i = 0; i < TEXT_ATLAS_GLYPHS; i++)
+        {
+            if (!glyphSurfaces[i])
+                continue;
+
+            // Copy coverage as-is instead of blending onto the empty sheet
+            SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dst = atlas->glyphs[i].src;
+            SDL_BlitSurface(glyphSurfaces[i], NULL, sheet, &dst);
+        }
+
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        if (atlas->texture)
+        {
+            SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+            result = 0;
+        }
+        SDL_FreeSurface(sheet);
+    }
+
+    for (int i = 0; i < TEXT_ATLAS_GLYPHS; i++)
+    {
+        if (glyphSurfaces[i])
+            SDL_FreeSurface(glyphSurfaces[i]);
+    }
+
+    // Every quad uses the same two-triangle pattern, so build indices once
+    for (int q = 0; q < TEXT_ATLAS_BATCH; q++)
+    {
+        int *idx = &atlas->indices[q * 6];
+        int v = q * 4;
+        idx[0] = v;
+        idx[1] = v + 1;
+        idx[2] = v + 2;
+        idx[3] = v;
+        idx[4] = v + 2;
+        idx[5] = v + 3;
+    }
+
+    return result;
+}
+
+int measureAtlasText(const TextAtlas *atlas, const char *text)
+{
+    int width = 0;
+
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++)
+    {
+        if (*p < TEXT_ATLAS_FIRST_CHAR || *p > TEXT_ATLAS_LAST_CHAR)
+            continue;
+        width += atlas->glyphs[*p - TEXT_ATLAS_FIRST_CHAR].advance;
+    }
+
+    return width;
+}
+
+int drawAtlasText(SDL_Renderer *renderer, TextAtlas *atlas, SDL_Color color, const char *text, int x, int y)
+{
+    if (!atlas->texture)
+        return 0;
+
+    float invW = 1.0f / (float)atlas->w;
+    float invH = 1.0f / (float)atlas->h;
+    int penX = x;
+    int quads = 0;
+    int total = 0;
+
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++)
+    {
+        if (*p < TEXT_ATLAS_FIRST_CHAR || *p > TEXT_ATLAS_LAST_CHAR)
+            continue;
+
+        const Glyph *g = &atlas->glyphs[*p - TEXT_ATLAS_FIRST_CHAR];
+
+        if (g->src.w > 0 && *p != ' ')
+        {
+            float x0 = (float)penX;
+            float y0 = (float)y;
+            float x1 = x0 + g->src.w;
+            float y1 = y0 + g->src.h;
+            float u0 = g->src.x * invW;
+            float v0 = g->src.y * invH;
+            float u1 = (g->src.x + g->src.w) * invW;
+            float v1 = (g->src.y + g->src.h) * invH;
+
+            SDL_Vertex *v = &atlas->vertices[quads * 4];
+            v[0] = (SDL_Vertex){{x0, y0}, color, {u0, v0}};
+            v[1] = (SDL_Vertex){{x1, y0}, color, {u1, v0}};
+            v[2] = (SDL_Vertex){{x1, y1}, color, {u1, v1}};
+            v[3] = (SDL_Vertex){{x0, y1}, color, {u0, v1}};
+
+            if (++quads == TEXT_ATLAS_BATCH)
+            {
+                SDL_RenderGeometry(renderer, atlas->texture, atlas->vertices, quads * 4, atlas->indices, quads * 6);
+                total += quads;
+                quads = 0;
+            }
+        }
+
+        penX += g->advance;
+    }
+
+    if (quads > 0)
+    {
+        SDL_RenderGeometry(renderer, atlas->texture, atlas->vertices, quads * 4, atlas->indices, quads * 6);
+        total += quads;
+    }
+
+    return total;
+}
+
+void freeTextAtlas(TextAtlas *atlas)
+{
+    if (atlas->texture)
+        SDL_DestroyTexture(atlas->texture);
+    atlas->texture = NULL;
+}
@@ -0,0 +1,54 @@
+/**
+ * Glyph atlas text renderer
+ *
+ * Rasterizes the printable ASCII glyphs of a TTF font once into a single
+ * packed texture and draws strings as batches of textured quads from it.
+ * Drawing never allocates and never uploads texture data, so text that
+ * changes every frame costs the same as static text.
+ */
+
+#ifndef TEXT_ATLAS_H
+#define TEXT_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define TEXT_ATLAS_FIRST_CHAR 32
+#define TEXT_ATLAS_LAST_CHAR 126
+#define TEXT_ATLAS_GLYPHS (TEXT_ATLAS_LAST_CHAR - TEXT_ATLAS_FIRST_CHAR + 1)
+
+// Glyphs submitted per SDL_RenderGeometry call
+#define TEXT_ATLAS_BATCH 128
+
+typedef struct
+{
+    SDL_Rect src; // Location inside the atlas texture
+    int advance;  // Horizontal pen advance in pixels
+} Glyph;
+
+typedef struct
+{
+    SDL_Texture *texture;
+    int w;
+    int h;
+    int lineHeight;
+    Glyph glyphs[TEXT_ATLAS_GLYPHS];
+
+    // Preallocated batch storage, reused by every draw
+    SDL_Vertex vertices[TEXT_ATLAS_BATCH * 4];
+    int indices[TEXT_ATLAS_BATCH * 6];
+} TextAtlas;
+
+// Returns 0 on success, -1 if the glyphs could not be rasterized or uploaded
+int createTextAtlas(TextAtlas *atlas, SDL_Renderer *renderer, TTF_Font *font);
+
+// Width in pixels of text as drawAtlasText would lay it out
+int measureAtlasText(const TextAtlas *atlas, const char *text);
+
+// Draws text with its top-left corner at (x, y), tinted with color.
+// Returns the number of glyph quads submitted.
+int drawAtlasText(SDL_Renderer *renderer, TextAtlas *atlas, SDL_Color color, const char *text, int x, int y);
+
+void freeTextAtlas(TextAtlas *atlas);
+
+#endif
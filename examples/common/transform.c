@@ -0,0 +1,136 @@
+#include <stdlib.h>
+
+#include "transform.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSFORM_LANES 8
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_LANES 4
+#else
+#define TRANSFORM_LANES 1
+#endif
+
+int allocVec3Array(Vec3Array *a, int count)
+{
+    // Pad each array to whole SIMD blocks so the three never share a vector load
+    int padded = (count + 7) & ~7;
+
+    a->x = malloc(3 * (size_t)padded * sizeof(float));
+    if (!a->x)
+    {
+        a->y = a->z = NULL;
+        a->count = 0;
+        return -1;
+    }
+
+    a->y = a->x + padded;
+    a->z = a->y + padded;
+    a->count = count;
+    return 0;
+}
+
+void freeVec3Array(Vec3Array *a)
+{
+    free(a->x);
+    a->x = a->y = a->z = NULL;
+    a->count = 0;
+}
+
+void transformProjectScalar(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out, int first)
+{
+    const float *r = m->m;
+
+    for (int i = first; i < in->count; i++)
+    {
+        float x = in->x[i], y = in->y[i], z = in->z[i];
+        float rx = r[0] * x + r[1] * y + r[2] * z;
+        float ry = r[3] * x + r[4] * y + r[5] * z;
+        float rz = r[6] * x + r[7] * y + r[8] * z;
+
+        float depth = p->distance + rz;
+        float factor = p->distance / depth;
+        out->x[i] = rx * factor + p->centerX;
+        out->y[i] = ry * factor + p->centerY;
+        out->z[i] = depth;
+    }
+}
+
+#if TRANSFORM_LANES == 8
+
+static int transformProjectSimd(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out)
+{
+    __m256 r[9];
+    for (int k = 0; k < 9; k++)
+        r[k] = _mm256_set1_ps(m->m[k]);
+    __m256 distance = _mm256_set1_ps(p->distance);
+    __m256 cx = _mm256_set1_ps(p->centerX);
+    __m256 cy = _mm256_set1_ps(p->centerY);
+
+    int blocks = in->count & ~7;
+    for (int i = 0; i < blocks; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in->x + i);
+        __m256 y = _mm256_loadu_ps(in->y + i);
+        __m256 z = _mm256_loadu_ps(in->z + i);
+
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], x), _mm256_mul_ps(r[1], y)), _mm256_mul_ps(r[2], z));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[3], x), _mm256_mul_ps(r[4], y)), _mm256_mul_ps(r[5], z));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[6], x), _mm256_mul_ps(r[7], y)), _mm256_mul_ps(r[8], z));
+
+        __m256 depth = _mm256_add_ps(distance, rz);
+        __m256 factor = _mm256_div_ps(distance, depth);
+        _mm256_storeu_ps(out->x + i, _mm256_add_ps(_mm256_mul_ps(rx, factor), cx));
+        _mm256_storeu_ps(out->y + i, _mm256_add_ps(_mm256_mul_ps(ry, factor), cy));
+        _mm256_storeu_ps(out->z + i, depth);
+    }
+
+    return blocks;
+}
+
+#elif TRANSFORM_LANES == 4
+
+static int transformProjectSimd(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out)
+{
+    __m128 r[9];
+    for (int k = 0; k < 9; k++)
+        r[k] = _mm_set1_ps(m->m[k]);
+    __m128 distance = _mm_set1_ps(p->distance);
+    __m128 cx = _mm_set1_ps(p->centerX);
+    __m128 cy = _mm_set1_ps(p->centerY);
+
+    int blocks = in->count & ~3;
+    for (int i = 0; i < blocks; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(in->x + i);
+        __m128 y = _mm_loadu_ps(in->y + i);
+        __m128 z = _mm_loadu_ps(in->z + i);
+
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], x), _mm_mul_ps(r[1], y)), _mm_mul_ps(r[2], z));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[3], x), _mm_mul_ps(r[4], y)), _mm_mul_ps(r[5], z));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[6], x), _mm_mul_ps(r[7], y)), _mm_mul_ps(r[8], z));
+
+        __m128 depth = _mm_add_ps(distance, rz);
+        __m128 factor = _mm_div_ps(distance, depth);
+        _mm_storeu_ps(out->x + i, _mm_add_ps(_mm_mul_ps(rx, factor), cx));
+        _mm_storeu_ps(out->y + i, _mm_add_ps(_mm_mul_ps(ry, factor), cy));
+        _mm_storeu_ps(out->z + i, depth);
+    }
+
+    return blocks;
+}
+
+#endif
+
+void transformProject(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out)
+{
+    int done = 0;
+
+#if TRANSFORM_LANES > 1
+    done = transformProjectSimd(m, p, in, out);
+#endif
+
+    // Leftover vertices (all of them without SIMD)
+    transformProjectScalar(m, p, in, out, done);
+}
@@ -0,0 +1,57 @@
+/**
+ * Batched vertex transform and projection
+ *
+ * Positions are stored as structure-of-arrays (all x, then all y, then all
+ * z) so a whole mesh is rotated and projected in one pass over contiguous
+ * floats. On x86 hosts the pass runs 4 (SSE) or 8 (AVX) vertices at a time;
+ * elsewhere, including the PSP, it is a plain loop the compiler can keep in
+ * registers. Results are identical up to float rounding.
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "fast_math.h"
+
+typedef struct
+{
+    float *x;
+    float *y;
+    float *z;
+    int count;
+} Vec3Array;
+
+// A line between two vertex indices
+typedef struct
+{
+    int a, b;
+} Edge;
+
+// Three vertex indices, counter-clockwise seen from outside the mesh
+typedef struct
+{
+    int a, b, c;
+} Triangle;
+
+typedef struct
+{
+    float distance; // Eye distance; depth is distance + rotated z
+    float centerX;
+    float centerY;
+} Projection;
+
+// One allocation for all three arrays. Returns 0 on success, -1 if out of memory.
+int allocVec3Array(Vec3Array *a, int count);
+void freeVec3Array(Vec3Array *a);
+
+/*
+ * Rotates every vertex of in by m and projects it. out->x/y receive screen
+ * coordinates and out->z the depth (distance + rotated z). out must hold at
+ * least in->count vertices; in and out must not overlap.
+ */
+void transformProject(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out);
+
+// The portable loop on its own, from vertex first onwards; also used for the SIMD path's leftovers
+void transformProjectScalar(const Mat3 *m, const Projection *p, const Vec3Array *in, Vec3Array *out, int first);
+
+#endif
@@ -4,106 +4,61 @@
  * Created by Claude Code (Anthropic)
  */
 
-#include <pspkernel.h>
-#include <pspctrl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "fast_math.h"
+#include "fixed_step.h"
+#include "input.h"
+#include "line_batch.h"
+#include "mesh.h"
+#include "platform.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "replay.h"
+#include "raster.h"
+#include "text_atlas.h"
+#include "transform.h"
+
 #define SCREEN_WIDTH 480
 #define SCREEN_HEIGHT 272
 
-typedef struct
-{
-    float x, y, z;
-} Vec3;
-
-typedef struct
-{
-    int a, b;
-} Edge;
-
-typedef struct
-{
-    SDL_Texture *texture;
-    int w;
-    int h;
-} Text;
-
-Text createText(SDL_Renderer *renderer, TTF_Font *font, SDL_Color color, const char *text)
-{
-    Text t = {NULL, 0, 0};
+// Rotation advances per simulation tick, not per rendered frame
+#define TICK_RATE 60
+#define MAX_TICKS_PER_FRAME 5
 
-    SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
-    if (!surface)
-        return t;
+// Loaded meshes are scaled to the built-in cube's size (corner at 50, 50, 50)
+#define MESH_RADIUS 86.6f
+#define MAX_VERTEX_MARKERS 64
 
-    t.texture = SDL_CreateTextureFromSurface(renderer, surface);
-    t.w = surface->w;
-    t.h = surface->h;
-    SDL_FreeSurface(surface);
-
-    return t;
-}
-
-void drawText(SDL_Renderer *renderer, Text *text, int x, int y)
-{
-    if (!text->texture)
-        return;
-
-    SDL_Rect dst = {x, y, text->w, text->h};
-    SDL_RenderCopy(renderer, text->texture, NULL, &dst);
-}
+// Filled faces: nothing of the mesh comes nearer than 200 - 86.6, so the depth buffer can start at 100
+#define NEAR_DEPTH 100.0f
 
-void freeText(Text *text)
-{
-    if (text->texture)
-        SDL_DestroyTexture(text->texture);
-    text->texture = NULL;
-}
-
-Vec3 rotateX(Vec3 v, float angle)
-{
-    Vec3 result;
-    result.x = v.x;
-    result.y = v.y * cosf(angle) - v.z * sinf(angle);
-    result.z = v.y * sinf(angle) + v.z * cosf(angle);
-    return result;
-}
-
-Vec3 rotateY(Vec3 v, float angle)
-{
-    Vec3 result;
-    result.x = v.x * cosf(angle) + v.z * sinf(angle);
-    result.y = v.y;
-    result.z = -v.x * sinf(angle) + v.z * cosf(angle);
-    return result;
-}
-
-Vec3 rotateZ(Vec3 v, float angle)
-{
-    Vec3 result;
-    result.x = v.x * cosf(angle) - v.y * sinf(angle);
-    result.y = v.x * sinf(angle) + v.y * cosf(angle);
-    result.z = v.z;
-    return result;
-}
-
-void project(Vec3 v, int *x, int *y, float distance)
+typedef struct
 {
-    float factor = distance / (distance + v.z);
-    *x = (int)(v.x * factor) + SCREEN_WIDTH / 2;
-    *y = (int)(v.y * factor) + SCREEN_HEIGHT / 2;
-}
+    float x, y, z;
+} Angles;
 
 int main(int argc, char **argv)
 {
-    (void)argc;
-    (void)argv;
+    platformInit(argc, argv);
 
-    sceCtrlSetSamplingCycle(0);
+    const char *meshPath = "cube.obj";
+    int filled = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--mesh=", 7) == 0)
+            meshPath = argv[i] + 7;
+        else if (strcmp(argv[i], "--filled") == 0)
+            filled = 1;
+    }
+
+    static Input input;
+    initInput(&input);
     sceCtrlSetSamplingMode(PSP_CTRL_MODE_DIGITAL);
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -130,7 +85,9 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(win, -1, 0);
+    // Vsync paces rendering; the fixed timestep keeps the spin speed independent of it.
+    // Headless runs are unpaced so they measure the frame cost.
+    SDL_Renderer *renderer = SDL_CreateRenderer(win, -1, platformHeadless() ? 0 : SDL_RENDERER_PRESENTVSYNC);
     if (!renderer)
     {
         SDL_DestroyWindow(win);
@@ -149,89 +106,223 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    Text title = createText(renderer, font, (SDL_Color){255, 255, 255, 255}, "3D Spinning Cube Demo");
-    Text credit = createText(renderer, font, (SDL_Color){180, 180, 180, 255}, "Made by Claude Code (Anthropic)");
-    Text controls = createText(renderer, font, (SDL_Color){150, 150, 150, 255}, "START to exit");
-
-    Vec3 vertices[8] = {
-        {-50, -50, -50},
-        {50, -50, -50},
-        {50, 50, -50},
-        {-50, 50, -50},
-        {-50, -50, 50},
-        {50, -50, 50},
-        {50, 50, 50},
-        {-50, 50, 50}};
-
-    Edge edges[12] = {
+    static TextAtlas atlas;
+    if (createTextAtlas(&atlas, renderer, font) < 0)
+    {
+        TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(win);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    static ProfilerOverlay overlay;
+    initProfilerOverlay(&overlay, renderer, "Orbitron-Regular.ttf");
+
+    // Positions are kept as separate x, y and z arrays so the whole mesh transforms in one pass
+    static float cubeX[8] = {-50, 50, 50, -50, -50, 50, 50, -50};
+    static float cubeY[8] = {-50, -50, 50, 50, -50, -50, 50, 50};
+    static float cubeZ[8] = {-50, -50, -50, -50, 50, 50, 50, 50};
+    static Edge cubeEdges[12] = {
         {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    static Triangle cubeTriangles[12] = {
+        {0, 3, 2}, {0, 2, 1}, {4, 5, 6}, {4, 6, 7}, {0, 1, 5}, {0, 5, 4},
+        {1, 2, 6}, {1, 6, 5}, {2, 3, 7}, {2, 7, 6}, {3, 0, 4}, {3, 4, 7}};
+
+    // The OBJ is parsed once and then read from its binary cache; the built-in cube is the fallback
+    char cachePath[256];
+    snprintf(cachePath, sizeof(cachePath), "%s.bin", meshPath);
+
+    Mesh mesh;
+    int meshLoaded = loadMesh(&mesh, meshPath, cachePath) == 0;
+    if (meshLoaded)
+        normalizeMesh(&mesh, MESH_RADIUS);
+    else
+        mesh = (Mesh){{cubeX, cubeY, cubeZ, 8}, cubeEdges, 12, cubeTriangles, 12, NULL, 0};
+
+    Vec3Array screen, normals;
+    uint32_t *faceColors = malloc((mesh.triangleCount ? mesh.triangleCount : 1) * sizeof(uint32_t));
+    if (!faceColors || allocVec3Array(&screen, mesh.vertices.count) < 0 ||
+        allocVec3Array(&normals, mesh.triangleCount) < 0)
+    {
+        freeVec3Array(&screen);
+        free(faceColors);
+        if (meshLoaded)
+            freeMesh(&mesh);
+        freeProfilerOverlay(&overlay);
+        freeTextAtlas(&atlas);
+        TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(win);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    Projection projection = {200.0f, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2};
 
-    float angleX = 0.0f;
-    float angleY = 0.0f;
-    float angleZ = 0.0f;
+    static LineBatch lines;
+    initLineBatch(&lines);
+
+    // Filled faces are rasterized on the CPU into a streaming texture; without one, TRIANGLE does nothing
+    computeFaceNormals(&mesh, &normals);
+    static Raster raster;
+    int rasterReady = initRaster(&raster, mesh.triangleCount, 0) == 0;
+    raster.nearDepth = NEAR_DEPTH;
+    SDL_Texture *faces = rasterReady ? SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                                         RASTER_WIDTH, RASTER_HEIGHT)
+                                     : NULL;
+    if (!faces)
+        filled = 0;
+
+    Angles angles = {0.0f, 0.0f, 0.0f};
+    Angles prevAngles = angles;
+
+    FixedStep clock;
+    initFixedStep(&clock, TICK_RATE, MAX_TICKS_PER_FRAME);
+    platformFrameSeconds(TICK_RATE);
 
-    SceCtrlData pad;
     int running = 1;
 
-    while (running)
+    while (running && platformRunning())
     {
-        sceCtrlReadBufferPositive(&pad, 1);
+        profilerBeginFrame();
 
-        if (pad.Buttons & PSP_CTRL_START)
+        profileBegin("input");
+        updateInput(&input);
+
+        if (input.held & PSP_CTRL_START)
             running = 0;
 
-        angleX += 0.02f;
-        angleY += 0.025f;
-        angleZ += 0.015f;
+        // SELECT toggles the profiler overlay, TRIANGLE switches between wireframe and filled faces
+        if (input.pressed & PSP_CTRL_SELECT)
+            overlay.visible = !overlay.visible;
+        if ((input.pressed & PSP_CTRL_TRIANGLE) && faces)
+            filled = !filled;
+        profileEnd();
+
+        profileBegin("sim");
+        int ticks = replayTicks(advanceFixedStep(&clock, platformFrameSeconds(TICK_RATE)));
+
+        for (int t = 0; t < ticks; t++)
+        {
+            prevAngles = angles;
+            angles.x += 0.02f;
+            angles.y += 0.025f;
+            angles.z += 0.015f;
+        }
+        profileEnd();
+
+        // Draw between the last two ticks so motion stays smooth at any frame rate
+        float alpha = fixedStepAlpha(&clock);
+        float angleX = prevAngles.x + (angles.x - prevAngles.x) * alpha;
+        float angleY = prevAngles.y + (angles.y - prevAngles.y) * alpha;
+        float angleZ = prevAngles.z + (angles.z - prevAngles.z) * alpha;
 
+        profileBegin("render");
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        Vec3 rotated[8];
-        int projected[8][2];
+        // One table-driven rotation matrix per frame instead of sinf/cosf per vertex and axis
+        Mat3 rotation;
+        mat3RotationXYZ(&rotation, angleX, angleY, angleZ);
 
-        for (int i = 0; i < 8; i++)
+        transformProject(&rotation, &projection, &mesh.vertices, &screen);
+
+        if (filled)
         {
-            rotated[i] = vertices[i];
-            rotated[i] = rotateX(rotated[i], angleX);
-            rotated[i] = rotateY(rotated[i], angleY);
-            rotated[i] = rotateZ(rotated[i], angleZ);
-            project(rotated[i], &projected[i][0], &projected[i][1], 200.0f);
+            // Flat shading from the rotated face normal, lit from the upper left in front
+            for (int i = 0; i < mesh.triangleCount; i++)
+            {
+                Vec3 n = mat3Transform(&rotation, (Vec3){normals.x[i], normals.y[i], normals.z[i]});
+                float light = -0.40f * n.x - 0.50f * n.y - 0.77f * n.z;
+                int level = (int)(60 + 195 * (light > 0 ? light : 0));
+                faceColors[i] = 0xFF000000u | (uint32_t)(level * 200 / 255) << 8 | (uint32_t)level;
+            }
+
+            rasterBegin(&raster, 0xFF000000u);
+            rasterMesh(&raster, &screen, mesh.triangles, mesh.triangleCount, faceColors);
+
+            // Straight into the texture when it can be locked, otherwise through the own buffer
+            profileBegin("raster");
+            void *pixels;
+            int pitch;
+            if (SDL_LockTexture(faces, NULL, &pixels, &pitch) == 0)
+            {
+                rasterSetTarget(&raster, pixels, pitch);
+                rasterEnd(&raster);
+                SDL_UnlockTexture(faces);
+            }
+            else
+            {
+                rasterSetTarget(&raster, NULL, 0);
+                rasterEnd(&raster);
+                SDL_UpdateTexture(faces, NULL, raster.color, RASTER_WIDTH * sizeof(uint32_t));
+            }
+            profileEnd();
+
+            SDL_RenderCopy(renderer, faces, NULL, NULL);
         }
-
-        SDL_SetRenderDrawColor(renderer, 0, 200, 255, 255);
-        for (int i = 0; i < 12; i++)
+        else
         {
-            int a = edges[i].a;
-            int b = edges[i].b;
-            SDL_RenderDrawLine(renderer,
-                               projected[a][0], projected[a][1],
-                               projected[b][0], projected[b][1]);
+            // All edges in one geometry call, all vertex markers in one fill call
+            drawEdges(renderer, &lines, screen.x, screen.y, mesh.edges, mesh.edgeCount, (SDL_Color){0, 200, 255, 255});
         }
 
-        for (int i = 0; i < 8; i++)
+        // Markers only for small meshes; on a dense one they would bury the wireframe
+        if (!filled && screen.count <= MAX_VERTEX_MARKERS)
         {
-            SDL_Rect point = {projected[i][0] - 2, projected[i][1] - 2, 4, 4};
+            SDL_FRect points[MAX_VERTEX_MARKERS];
+            for (int i = 0; i < screen.count; i++)
+                points[i] = (SDL_FRect){screen.x[i] - 2, screen.y[i] - 2, 4, 4};
             SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
-            SDL_RenderFillRect(renderer, &point);
+            SDL_RenderFillRectsF(renderer, points, screen.count);
         }
+        profileEnd();
 
-        drawText(renderer, &title, 10, 10);
-        drawText(renderer, &credit, 10, 35);
-        drawText(renderer, &controls, 10, SCREEN_HEIGHT - 30);
+        profileBegin("hud");
+        drawAtlasText(renderer, &atlas, (SDL_Color){255, 255, 255, 255}, "3D Spinning Cube Demo", 10, 10);
+        drawAtlasText(renderer, &atlas, (SDL_Color){180, 180, 180, 255}, "Made by Claude Code (Anthropic)", 10, 35);
+        const char *hint = !faces ? "START to exit" : filled ? "TRIANGLE: wireframe, START: exit" : "TRIANGLE: fill, START: exit";
+        drawAtlasText(renderer, &atlas, (SDL_Color){150, 150, 150, 255}, hint, 10, SCREEN_HEIGHT - 30);
+        drawProfilerOverlay(renderer, &overlay, SCREEN_WIDTH - 250, 10);
+        profileEnd();
 
+        profileBegin("present");
         SDL_RenderPresent(renderer);
-        SDL_Delay(16);
+        profileEnd();
+
+        profilerEndFrame();
+    }
+
+    if (platformProfileDumps())
+    {
+        profilerWriteCsv("profile.csv");
+        profilerWriteTrace("profile.json");
+    }
+    if (platformHeadless())
+    {
+        profilerPrintSummary(stdout);
+        platformPrintSummary(stdout);
     }
 
-    freeText(&title);
-    freeText(&credit);
-    freeText(&controls);
+    if (faces)
+        SDL_DestroyTexture(faces);
+    if (rasterReady)
+        freeRaster(&raster);
+    freeVec3Array(&normals);
+    freeVec3Array(&screen);
+    free(faceColors);
+    if (meshLoaded)
+        freeMesh(&mesh);
+    freeProfilerOverlay(&overlay);
+    freeTextAtlas(&atlas);
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
     TTF_Quit();
     SDL_Quit();
+    stopReplay();
     sceKernelExitGame();
 
     return 0;
@@ -56,5 +56,12 @@ else
     echo "Warning: Font file not found at $SCRIPT_DIR/Orbitron-Regular.ttf"
 fi
 
+# Copy wireframe mesh; its .bin cache is built on the first run
+if [ -f "$SCRIPT_DIR/cube.obj" ]; then
+    cp "$SCRIPT_DIR/cube.obj" "$OUTPUT_DIR/"
+else
+    echo "Warning: Mesh file not found at $SCRIPT_DIR/cube.obj"
+fi
+
 echo "Release build complete!"
 echo "Output directory: $OUTPUT_DIR"
@@ -0,0 +1,344 @@
+#include <string.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "batch.h"
+
+#define ATLAS_WIDTH 256
+#define WHITE_SIZE 4            /* Sampled at its centre, so filtering never reaches a glyph */
+#define GLYPH_PADDING 1
+
+static int nextPowerOfTwo(int v)
+{
+    int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+/* Shelf-packs the glyphs after the white block and uploads the sheet; font may be NULL */
+static int buildAtlas(BatchRenderer *batch, TTF_Font *font)
+{
+    SDL_Surface *glyphSurfaces[BATCH_GLYPHS] = {0};
+    SDL_Color white = {255, 255, 255, 255};
+    int penX = WHITE_SIZE + GLYPH_PADDING, penY = 0, rowHeight = WHITE_SIZE;
+    int rects[BATCH_GLYPHS][2];
+
+    for (int i = 0; font && i < BATCH_GLYPHS; i++) {
+        Uint16 ch = (Uint16)(BATCH_FIRST_CHAR + i);
+        int advance = 0;
+        TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &advance);
+        batch->glyphs[i].advance = advance;
+
+        glyphSurfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!glyphSurfaces[i]) continue;
+
+        int w = glyphSurfaces[i]->w, h = glyphSurfaces[i]->h;
+        if (penX + w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + GLYPH_PADDING;
+            rowHeight = 0;
+        }
+        rects[i][0] = penX;
+        rects[i][1] = penY;
+        batch->glyphs[i].w = w;
+        batch->glyphs[i].h = h;
+        penX += w + GLYPH_PADDING;
+        if (h > rowHeight) rowHeight = h;
+    }
+
+    batch->atlasWidth = font ? ATLAS_WIDTH : WHITE_SIZE;
+    batch->atlasHeight = nextPowerOfTwo(penY + rowHeight);
+
+    int result = -1;
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, batch->atlasWidth, batch->atlasHeight, 32,
+                                                        SDL_PIXELFORMAT_RGBA32);
+    if (sheet) {
+        SDL_FillRect(sheet, NULL, 0);
+        SDL_Rect block = {0, 0, WHITE_SIZE, WHITE_SIZE};
+        SDL_FillRect(sheet, &block, SDL_MapRGBA(sheet->format, 255, 255, 255, 255));
+
+        float invW = 1.0f / batch->atlasWidth, invH = 1.0f / batch->atlasHeight;
+        for (int i = 0; i < BATCH_GLYPHS; i++) {
+            if (!glyphSurfaces[i]) continue;
+
+            /* Copy coverage as-is instead of blending onto the empty sheet */
+            SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dst = {rects[i][0], rects[i][1], glyphSurfaces[i]->w, glyphSurfaces[i]->h};
+            SDL_BlitSurface(glyphSurfaces[i], NULL, sheet, &dst);
+
+            BatchGlyph *g = &batch->glyphs[i];
+            g->u0 = dst.x * invW;
+            g->v0 = dst.y * invH;
+            g->u1 = (dst.x + g->w) * invW;
+            g->v1 = (dst.y + g->h) * invH;
+        }
+        batch->whiteU = WHITE_SIZE * 0.5f * invW;
+        batch->whiteV = WHITE_SIZE * 0.5f * invH;
+
+        glGenTextures(1, &batch->atlas);
+        glBindTexture(GL_TEXTURE_2D, batch->atlas);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        SDL_LockSurface(sheet);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, batch->atlasWidth, batch->atlasHeight, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, sheet->pixels);
+        SDL_UnlockSurface(sheet);
+        SDL_FreeSurface(sheet);
+        result = 0;
+    }
+
+    for (int i = 0; i < BATCH_GLYPHS; i++) {
+        if (glyphSurfaces[i]) SDL_FreeSurface(glyphSurfaces[i]);
+    }
+    return result;
+}
+
+int initBatch(BatchRenderer *batch, const char *fontPath, int fontSize, int screenWidth, int screenHeight)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->screenWidth = screenWidth;
+    batch->screenHeight = screenHeight;
+
+    TTF_Font *font = fontPath ? TTF_OpenFont(fontPath, fontSize) : NULL;
+    if (font) {
+        batch->hasText = 1;
+        batch->lineHeight = TTF_FontHeight(font);
+    }
+
+    int result = buildAtlas(batch, font);
+    if (font) TTF_CloseFont(font);
+    return result;
+}
+
+void freeBatch(BatchRenderer *batch)
+{
+    if (batch->atlas) glDeleteTextures(1, &batch->atlas);
+    batch->atlas = 0;
+}
+
+int batchHasText(const BatchRenderer *batch)
+{
+    return batch->hasText;
+}
+
+void batchLayer(BatchRenderer *batch, int layer)
+{
+    batch->layer = layer;
+}
+
+/* Room for count vertices in a run of the current layer and texture, or NULL if the batch is full */
+static BatchVertex *reserve(BatchRenderer *batch, GLuint texture, int count)
+{
+    if (batch->vertexCount + count > BATCH_VERTICES) {
+        batch->dropped++;
+        return NULL;
+    }
+
+    BatchCommand *last = batch->commandCount ? &batch->commands[batch->commandCount - 1] : NULL;
+    if (!last || last->layer != batch->layer || last->texture != texture) {
+        if (batch->commandCount == BATCH_COMMANDS) {
+            batch->dropped++;
+            return NULL;
+        }
+        last = &batch->commands[batch->commandCount++];
+        last->layer = batch->layer;
+        last->texture = texture;
+        last->first = batch->vertexCount;
+        last->count = 0;
+    }
+
+    BatchVertex *v = &batch->vertices[batch->vertexCount];
+    last->count += count;
+    batch->vertexCount += count;
+    return v;
+}
+
+static unsigned char toByte(float c)
+{
+    return (unsigned char)(c <= 0 ? 0 : c >= 1 ? 255 : c * 255.0f + 0.5f);
+}
+
+static void setVertex(BatchVertex *v, float x, float y, float u, float t, const unsigned char *color)
+{
+    v->u = u;
+    v->v = t;
+    v->r = color[0];
+    v->g = color[1];
+    v->b = color[2];
+    v->a = color[3];
+    v->x = x;
+    v->y = y;
+}
+
+/* Two triangles; GL_QUADS is not in every GL the PSP toolchains ship */
+static void putQuad(BatchVertex *v, float x, float y, float w, float h,
+                    float u0, float t0, float u1, float t1, const unsigned char *color)
+{
+    setVertex(&v[0], x,     y,     u0, t0, color);
+    setVertex(&v[1], x + w, y,     u1, t0, color);
+    setVertex(&v[2], x + w, y + h, u1, t1, color);
+    setVertex(&v[3], x,     y,     u0, t0, color);
+    setVertex(&v[4], x + w, y + h, u1, t1, color);
+    setVertex(&v[5], x,     y + h, u0, t1, color);
+}
+
+void batchRect(BatchRenderer *batch, float x, float y, float w, float h, float r, float g, float b, float a)
+{
+    batchSprite(batch, batch->atlas, x, y, w, h, batch->whiteU, batch->whiteV, batch->whiteU, batch->whiteV,
+                r, g, b, a);
+}
+
+void batchTriangle(BatchRenderer *batch, float x0, float y0, float x1, float y1, float x2, float y2,
+                   float r, float g, float b, float a)
+{
+    BatchVertex *v = reserve(batch, batch->atlas, 3);
+    if (!v) return;
+
+    unsigned char color[4] = {toByte(r), toByte(g), toByte(b), toByte(a)};
+    setVertex(&v[0], x0, y0, batch->whiteU, batch->whiteV, color);
+    setVertex(&v[1], x1, y1, batch->whiteU, batch->whiteV, color);
+    setVertex(&v[2], x2, y2, batch->whiteU, batch->whiteV, color);
+}
+
+void batchSprite(BatchRenderer *batch, GLuint texture, float x, float y, float w, float h,
+                 float u0, float v0, float u1, float v1, float r, float g, float b, float a)
+{
+    BatchVertex *v = reserve(batch, texture, 6);
+    if (!v) return;
+
+    unsigned char color[4] = {toByte(r), toByte(g), toByte(b), toByte(a)};
+    putQuad(v, x, y, w, h, u0, v0, u1, v1, color);
+}
+
+float batchText(BatchRenderer *batch, float x, float y, float scale, const char *text,
+                float r, float g, float b, float a)
+{
+    if (!batch->hasText) return 0;
+
+    unsigned char color[4] = {toByte(r), toByte(g), toByte(b), toByte(a)};
+    float penX = x;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p < BATCH_FIRST_CHAR || *p > BATCH_LAST_CHAR) continue;
+
+        const BatchGlyph *glyph = &batch->glyphs[*p - BATCH_FIRST_CHAR];
+        if (glyph->w > 0 && *p != ' ') {
+            BatchVertex *v = reserve(batch, batch->atlas, 6);
+            if (!v) break;
+            putQuad(v, penX, y, glyph->w * scale, glyph->h * scale,
+                    glyph->u0, glyph->v0, glyph->u1, glyph->v1, color);
+        }
+        penX += glyph->advance * scale;
+    }
+    return penX - x;
+}
+
+float measureBatchText(const BatchRenderer *batch, const char *text, float scale)
+{
+    if (!batch->hasText) return 0;
+
+    int width = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p < BATCH_FIRST_CHAR || *p > BATCH_LAST_CHAR) continue;
+        width += batch->glyphs[*p - BATCH_FIRST_CHAR].advance;
+    }
+    return width * scale;
+}
+
+float batchLineHeight(const BatchRenderer *batch, float scale)
+{
+    return batch->lineHeight * scale;
+}
+
+/* Stable sort of the runs by layer, then texture: insertion sort, as runs arrive nearly in order */
+static void sortCommands(BatchRenderer *batch)
+{
+    for (int i = 0; i < batch->commandCount; i++) {
+        const BatchCommand *c = &batch->commands[i];
+        int j = i;
+        while (j > 0) {
+            const BatchCommand *prev = &batch->commands[batch->order[j - 1]];
+            if (prev->layer < c->layer || (prev->layer == c->layer && prev->texture <= c->texture)) break;
+            batch->order[j] = batch->order[j - 1];
+            j--;
+        }
+        batch->order[j] = i;
+    }
+}
+
+void flushBatch(BatchRenderer *batch)
+{
+    batch->drawCalls = 0;
+    batch->flushedVertices = batch->vertexCount;
+    batch->frames++;
+
+    if (batch->vertexCount > 0) {
+        sortCommands(batch);
+
+        /* Copy the runs into draw order, so each layer and texture is one contiguous range */
+        int count = 0;
+        for (int i = 0; i < batch->commandCount; i++) {
+            const BatchCommand *c = &batch->commands[batch->order[i]];
+            memcpy(&batch->sorted[count], &batch->vertices[c->first], c->count * sizeof(BatchVertex));
+            count += c->count;
+        }
+
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_FOG);
+        glEnable(GL_TEXTURE_2D);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, batch->screenWidth, batch->screenHeight, 0, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch->sorted[0].u);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), &batch->sorted[0].r);
+        glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch->sorted[0].x);
+
+        /* Layers are already in order, so one draw per change of texture */
+        int first = 0;
+        for (int i = 0; i < batch->commandCount; ) {
+            GLuint texture = batch->commands[batch->order[i]].texture;
+            int run = 0;
+            while (i < batch->commandCount && batch->commands[batch->order[i]].texture == texture) {
+                run += batch->commands[batch->order[i]].count;
+                i++;
+            }
+
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glDrawArrays(GL_TRIANGLES, first, run);
+            batch->drawCalls++;
+            first += run;
+        }
+
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopMatrix();
+
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_FOG);
+    }
+
+    batch->totalDrawCalls += batch->drawCalls;
+    batch->totalVertices += batch->vertexCount;
+    batch->vertexCount = 0;
+    batch->commandCount = 0;
+    batch->layer = 0;
+}
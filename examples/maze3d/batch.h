@@ -0,0 +1,115 @@
+/**
+ * Immediate-mode 2D batch for the HUD, menus and overlays
+ *
+ * Rectangles, triangles, sprites and text are appended to one vertex array
+ * over the frame; nothing reaches GL until flushBatch. The flush sets up
+ * the 2D state once, orders the primitives by layer and then texture, and
+ * draws each run of equal state with a single glDrawArrays.
+ *
+ * Untextured shapes sample a white block in the glyph atlas, so shapes and
+ * text share one texture and a screen of both is usually one draw call.
+ * Within a layer, primitives keep their order only against others with the
+ * same texture; anything that must cover a sprite of another texture goes
+ * in a higher layer.
+ *
+ * Glyphs are the printable ASCII range of a TTF font, rasterized once with
+ * SDL_ttf into the atlas. Without the font, text draws nothing and
+ * batchHasText says so.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <GL/gl.h>
+
+#define BATCH_VERTICES 6144     /* 1024 quads per frame; more are dropped and counted */
+#define BATCH_COMMANDS 512      /* Runs of one layer and texture before sorting */
+#define BATCH_FIRST_CHAR 32
+#define BATCH_LAST_CHAR 126
+#define BATCH_GLYPHS (BATCH_LAST_CHAR - BATCH_FIRST_CHAR + 1)
+
+/* Interleaved texcoord + colour + position, laid out for the GL array pointers */
+typedef struct {
+    float u, v;
+    unsigned char r, g, b, a;
+    float x, y;
+} BatchVertex;
+
+/* A run of vertices sharing layer and texture, in submission order */
+typedef struct {
+    int layer;
+    GLuint texture;
+    int first;
+    int count;
+} BatchCommand;
+
+typedef struct {
+    float u0, v0, u1, v1;
+    int w, h;
+    int advance;
+} BatchGlyph;
+
+typedef struct {
+    GLuint atlas;               /* White block plus glyphs */
+    int atlasWidth;
+    int atlasHeight;
+    float whiteU, whiteV;       /* Centre of the white block */
+    int hasText;
+    int lineHeight;
+    BatchGlyph glyphs[BATCH_GLYPHS];
+
+    int screenWidth;
+    int screenHeight;
+    int layer;
+
+    BatchVertex vertices[BATCH_VERTICES];
+    BatchVertex sorted[BATCH_VERTICES];
+    BatchCommand commands[BATCH_COMMANDS];
+    int order[BATCH_COMMANDS];
+    int vertexCount;
+    int commandCount;
+
+    /* Last flush */
+    int drawCalls;
+    int flushedVertices;
+
+    /* Since initBatch */
+    int frames;
+    long totalDrawCalls;
+    long totalVertices;
+    int dropped;                /* Primitives that did not fit */
+} BatchRenderer;
+
+/*
+ * Builds the atlas from the font at fontPath and fontSize pixels, or only
+ * the white block if the font cannot be loaded. Needs a current GL context
+ * and TTF_Init. Returns 0 on success, -1 if the atlas could not be created.
+ */
+int initBatch(BatchRenderer *batch, const char *fontPath, int fontSize, int screenWidth, int screenHeight);
+void freeBatch(BatchRenderer *batch);
+
+int batchHasText(const BatchRenderer *batch);
+
+/* Primitives appended from now on draw over those of lower layers; flushBatch resets it to 0 */
+void batchLayer(BatchRenderer *batch, int layer);
+
+void batchRect(BatchRenderer *batch, float x, float y, float w, float h, float r, float g, float b, float a);
+void batchTriangle(BatchRenderer *batch, float x0, float y0, float x1, float y1, float x2, float y2,
+                   float r, float g, float b, float a);
+
+/* A textured quad over (x, y, w, h) from the texture's (u0, v0)-(u1, v1), tinted by the colour */
+void batchSprite(BatchRenderer *batch, GLuint texture, float x, float y, float w, float h,
+                 float u0, float v0, float u1, float v1, float r, float g, float b, float a);
+
+/* Text with its top-left corner at (x, y), glyphs scaled by scale. Returns its width. */
+float batchText(BatchRenderer *batch, float x, float y, float scale, const char *text,
+                float r, float g, float b, float a);
+
+/* Width of text as batchText would lay it out, and the height of a line */
+float measureBatchText(const BatchRenderer *batch, const char *text, float scale);
+float batchLineHeight(const BatchRenderer *batch, float scale);
+
+/* Draws everything appended since the last flush, then empties the batch */
+void flushBatch(BatchRenderer *batch);
+
+#endif
@@ -7,11 +7,6 @@
  * Created by Claude Code (Anthropic)
  */
 
-#include <pspkernel.h>
-#include <pspctrl.h>
-#include <pspdisplay.h>
-#include <pspgu.h>
-#include <pspgum.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,24 +15,48 @@
 
 #include <GL/gl.h>
 #include <GL/glu.h>
-#include <GL/glut.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "arena.h"
+#include "audio_monitor.h"
+#include "batch.h"
+#include "fixed_step.h"
+#include "input.h"
+#include "job.h"
+#include "maze.h"
+#include "platform.h"
+#include "platform_glut.h"
+#include "profiler.h"
+#include "replay.h"
+#include "player.h"
+#include "sequencer.h"
+#include "spatial.h"
+#include "synth.h"
+#include "textures.h"
+#include "world.h"
 
 /* Module info provided by SDL2 */
 
 #define SCREEN_WIDTH 480
 #define SCREEN_HEIGHT 272
 #define TEX_SIZE 64
+#define TEX_LEVELS 7     /* 64x64 down to 1x1 */
 #define WALL_HEIGHT 1.0f
 #define PLAYER_HEIGHT 0.5f
-#define PLAYER_RADIUS 0.25f
-#define MOVE_SPEED 0.08f
-#define ROT_SPEED 0.04f
+#define MAX_TICKS_PER_FRAME 5  /* Below 12 FPS the game slows down instead of jumping */
+#define FOG_END 15.0f
+#define CULL_FOV 1.75f   /* Horizontal FOV is ~91 degrees at 480x272; leave a margin */
+#define CULL_RAYS 240
+#define SAMPLE_RATE 22050
+#define FONT_PATH "Orbitron-Regular.ttf"
+#define FONT_SIZE 16
 
 /* Game States */
 typedef enum {
+    STATE_LOADING,
     STATE_MENU,
     STATE_GAME,
     STATE_PAUSE,
@@ -46,48 +65,142 @@ typedef enum {
     STATE_QUIT
 } GameState;
 
-/* Player structure */
-typedef struct {
-    float x, y;
-    float angle;
-} Player;
-
 /* Level configuration */
 typedef struct {
     int mazeWidth;
     int mazeHeight;
 } LevelConfig;
 
-/* Wall vertex for rendering */
+/* Interleaved texcoord + position, laid out for glTexCoordPointer/glVertexPointer */
+typedef struct {
+    float u, v;
+    float x, y, z;
+} MeshVertex;
+
+/* Packed triangle list for one wall texture */
+typedef struct {
+    MeshVertex *vertices;
+    int vertexCount;
+    int capacity;           /* In vertices */
+} WallMesh;
+
+/*
+ * Everything a level needs while it is played; built on a worker thread and
+ * swapped in whole. A level is one arena block that holds the Level itself:
+ * building it is bump allocation and freeing it is a single free, and a
+ * window move rebuilds the walls, meshes and visibility in place.
+ */
+typedef struct {
+    Arena arena;
+    World world;            /* Only the chunks around the player are resident */
+    WallMesh brickMesh;
+    WallMesh exitMesh;
+
+    /* Visibility culling: only walls hit by the ray fan are submitted */
+    Visibility visibility;
+    WallMesh visibleBrick;
+    WallMesh visibleExit;
+    unsigned char *runQueued;   /* Per merged run: already in this frame's visible meshes */
+} Level;
+
+/* What the level job should build; owned by the main thread while no job runs */
 typedef struct {
-    float x1, z1, x2, z2;
-    int isExit;
-} Wall;
+    int number;
+    int mazeWidth;
+    int mazeHeight;
+    uint32_t seed;
+} LevelRequest;
+
+/* Built by the asset job, then kept so a format change can repack the images */
+typedef struct {
+    TextureImage images[TEXTURE_KIND_COUNT];
+    SynthSound winSound;
+    SynthSound selectSound;
+} AssetData;
+
+/*
+ * Every merged run holds at least one face, so no window can have more runs
+ * than WORLD_MAX_WALLS and the full meshes always fit. Windows seen so far
+ * stay under 900 (examples/bench/arena_bench). The visible-set meshes are
+ * capped from measurement instead: a frame sees under 20 runs
+ * (examples/bench/merge_bench), and one that sees more draws the full
+ * meshes.
+ */
+#define LEVEL_MAX_RUNS WORLD_MAX_WALLS
+#define VISIBLE_MAX_RUNS 128
+
+/*
+ * Enough for the busiest window: its faces, merged runs (sized like the
+ * faces until merged) and visibility, the full meshes and the capped
+ * visible-set meshes, plus the Level and cells
+ */
+#define LEVEL_ARENA_SIZE (sizeof(Level) + 4096 + \
+                          WORLD_MAX_WALLS * (2 * sizeof(Wall) + 2 * sizeof(int) + 1) + \
+                          LEVEL_MAX_RUNS * (6 * sizeof(MeshVertex) + 1) + \
+                          2 * VISIBLE_MAX_RUNS * 6 * sizeof(MeshVertex))
+/* The most a frame takes is one texture's mip chain expanded to RGBA8 (4/3 of level 0) */
+#define FRAME_ARENA_SIZE (TEX_SIZE * TEX_SIZE * 4 * 4 / 3 + 4096)
+
+/* Per-frame GL submission counters */
+typedef struct {
+    int drawCalls;
+    int vertices;
+    int textureBinds;
+} RenderStats;
 
 /* Global state */
-static GameState gState = STATE_MENU;
-static Player gPlayer;
-static int *gWallGrid = NULL;
-static int gGridWidth = 0;
-static int gGridHeight = 0;
+static GameState gState = STATE_LOADING;
+static Player gPlayer;          /* State after the latest simulation tick */
+static Player gPrevPlayer;      /* State after the tick before, for interpolation */
+static Player gView;            /* What this frame renders, between the two */
+static FixedStep gClock;
+static Level *gLevel = NULL;
 static int gCurrentLevel = 0;
+static int gFirstLevel = 0;     /* --level=N starts the game there instead of level 1 */
+static int gSaveAudio = 0;      /* --save-audio also writes the synthesized sounds as WAV files */
 static int gMenuSelection = 0;
 static int gPauseSelection = 0;
 
-static Wall *gWalls = NULL;
-static int gWallCount = 0;
+/* Background work: assets at startup, then the next level while the current screen is up */
+static Job gAssetJob;
+static Job gLevelJob;
+static LevelRequest gLevelRequest;
+static uint32_t gSeedBase;
+static int gPendingLevel = -1;
+
+static int gCullingEnabled = 1;
+static int gShowProfiler = 0;
+static int gTextureMode = 0;    /* 0: each texture in its own format, else all in format gTextureMode - 1 */
+static int gTextureBytes = 0;
+static RenderStats gStats;
+static Arena gFrameArena;       /* Scratch for the current frame only, reset as each frame starts */
+static BatchRenderer gBatch;   /* HUD, menus and overlays, flushed once per frame */
 
 static GLuint gBrickTexture = 0;
 static GLuint gExitTexture = 0;
 static GLuint gFloorTexture = 0;
 static GLuint gCeilingTexture = 0;
+static AssetData *gAssets = NULL;
 
-static Mix_Music *gMusic = NULL;
+static AudioMonitor gAudio;     /* Mixer buffer profile, underruns and press-to-sound latency */
+static int gAudioProfile = AUDIO_PROFILE_DEFAULT;
+static Sequencer gSequencer;    /* Streams the music from the mixer's music hook */
 static Mix_Chunk *gWinSound = NULL;
 static Mix_Chunk *gSelectSound = NULL;
 
-static SceCtrlData gPad;
-static int gButtonPressed = 0;
+/*
+ * Broad phase for everything that moves in the level, in world coordinates
+ * and rebuilt every tick. The player is the only entity so far; enemies,
+ * pickups and projectiles join gEntities and find what they touch with
+ * querySpatialHash.
+ */
+#define MAX_ENTITIES 64
+#define ENTITY_PLAYER 0
+static SpatialEntity gEntities[MAX_ENTITIES];
+static int gEntityCount = 1;
+static SpatialHash gEntityHash;
+
+static Input gInput;            /* Each handler updates it once, so a press acts in one state only */
 
 /* FPS counter */
 static Uint32 gLastTime = 0;
@@ -102,505 +215,441 @@ static LevelConfig gLevels[3] = {
 
 /* ============== Texture Generation ============== */
 
-static unsigned int *generateBrickTextureData(void)
-{
-    unsigned int *data = malloc(TEX_SIZE * TEX_SIZE * sizeof(unsigned int));
-    if (!data) return NULL;
-
-    for (int y = 0; y < TEX_SIZE; y++) {
-        for (int x = 0; x < TEX_SIZE; x++) {
-            int brickH = 16;
-            int brickW = 32;
-            int row = y / brickH;
-            int offset = (row % 2) * (brickW / 2);
-
-            int isMortarH = (y % brickH) < 2;
-            int isMortarV = ((x + offset) % brickW) < 2 && !isMortarH;
-
-            if (isMortarH || isMortarV) {
-                data[y * TEX_SIZE + x] = 0xFF505050;
-            } else {
-                int variation = (rand() % 40) - 20;
-                unsigned char r = (unsigned char)(140 + variation);
-                unsigned char g = (unsigned char)(70 + variation / 2);
-                unsigned char b = (unsigned char)(40 + variation / 3);
-                data[y * TEX_SIZE + x] = 0xFF000000 | (b << 16) | (g << 8) | r;
-            }
-        }
-    }
-    return data;
-}
+/* Fixed seeds: the textures look the same on every launch, so their cache stays valid */
+static const TextureParams gTextureParams[TEXTURE_KIND_COUNT] = {
+    {TEXTURE_BRICK,   TEX_SIZE, 0x0001B21Cu, TEX_LEVELS},
+    {TEXTURE_EXIT,    TEX_SIZE, 0x00E817u,   TEX_LEVELS},
+    {TEXTURE_FLOOR,   TEX_SIZE, 0x00F100Du,  TEX_LEVELS},
+    {TEXTURE_CEILING, TEX_SIZE, 0x00CE111Au, TEX_LEVELS}
+};
 
-static unsigned int *generateExitTextureData(void)
-{
-    unsigned int *data = malloc(TEX_SIZE * TEX_SIZE * sizeof(unsigned int));
-    if (!data) return NULL;
+/* Per-texture formats for mode 0: flat colours fit a palette, the shaded walls want 16-bit gradients */
+static const TextureFormat gTextureFormats[TEXTURE_KIND_COUNT] = {
+    TEXTURE_RGB565, TEXTURE_CLUT8, TEXTURE_CLUT8, TEXTURE_RGB565
+};
 
-    for (int y = 0; y < TEX_SIZE; y++) {
-        for (int x = 0; x < TEX_SIZE; x++) {
-            int checker = ((x / 8) + (y / 8)) % 2;
-            if (checker) {
-                data[y * TEX_SIZE + x] = 0xFF00FF00;
-            } else {
-                data[y * TEX_SIZE + x] = 0xFF008800;
-            }
-        }
-    }
-    return data;
-}
+#define TEXTURE_MODE_COUNT (TEXTURE_FORMAT_COUNT + 1)
 
-static unsigned int *generateFloorTextureData(void)
+static void specifyPacked(const PackedTexture *packed, GLint internal, GLenum format, GLenum type)
 {
-    unsigned int *data = malloc(TEX_SIZE * TEX_SIZE * sizeof(unsigned int));
-    if (!data) return NULL;
-
-    for (int y = 0; y < TEX_SIZE; y++) {
-        for (int x = 0; x < TEX_SIZE; x++) {
-            int checker = ((x / 16) + (y / 16)) % 2;
-            int variation = (rand() % 20) - 10;
-            unsigned char base = checker ? 60 : 50;
-            unsigned char c = (unsigned char)(base + variation);
-            data[y * TEX_SIZE + x] = 0xFF000000 | (c << 16) | (c << 8) | c;
-        }
+    for (int level = 0, size = packed->size; level < packed->levels; level++, size /= 2) {
+        glTexImage2D(GL_TEXTURE_2D, level, internal, size, size, 0, format, type, packedLevel(packed, level));
     }
-    return data;
 }
 
-static unsigned int *generateCeilingTextureData(void)
+/*
+ * Replaces the bound texture's levels with image packed as format. Where GL
+ * cannot take the format as is (paletted textures off the PSP) the packed
+ * texels are expanded again, so the picture still shows the format's loss.
+ * Returns the bytes the texture takes on the PSP.
+ */
+static int uploadTexture(const TextureImage *image, TextureFormat format)
 {
-    unsigned int *data = malloc(TEX_SIZE * TEX_SIZE * sizeof(unsigned int));
-    if (!data) return NULL;
+    PackedTexture packed;
+    if (!image->pixels || packTexture(image, format, &packed) < 0) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_SIZE, TEX_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        return TEX_SIZE * TEX_SIZE * 4;
+    }
 
-    for (int y = 0; y < TEX_SIZE; y++) {
-        for (int x = 0; x < TEX_SIZE; x++) {
-            int variation = (rand() % 15) - 7;
-            unsigned char c = (unsigned char)(40 + variation);
-            data[y * TEX_SIZE + x] = 0xFF000000 | ((c+20) << 16) | (c << 8) | c;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);    /* The small levels have rows under 4 bytes */
+    switch (format) {
+#ifdef GL_UNSIGNED_SHORT_5_6_5
+    case TEXTURE_RGB565:
+        specifyPacked(&packed, GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5);
+        break;
+    case TEXTURE_RGBA4444:
+        specifyPacked(&packed, GL_RGBA, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4);
+        break;
+#endif
+#if defined(__PSP__) && defined(GL_COLOR_INDEX8_EXT)
+    case TEXTURE_CLUT8:
+        glColorTable(GL_TEXTURE_2D, GL_RGBA, TEXTURE_PALETTE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, packed.palette);
+        specifyPacked(&packed, GL_COLOR_INDEX8_EXT, GL_COLOR_INDEX, GL_UNSIGNED_BYTE);
+        break;
+#endif
+    default: {
+        TextureImage expanded = {image->size, image->levels, NULL};
+        size_t texels = textureLevel(image, image->levels) - image->pixels;
+        size_t mark = arenaMark(&gFrameArena);
+        expanded.pixels = format == TEXTURE_RGBA8888 ? packed.texels
+                                                     : arenaAlloc(&gFrameArena, texels * sizeof(unsigned int));
+        if (expanded.pixels) {
+            if (expanded.pixels != packed.texels) unpackTexture(&packed, expanded.pixels);
+            for (int level = 0, size = image->size; level < image->levels; level++, size /= 2) {
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                             textureLevel(&expanded, level));
+            }
         }
+        rewindArena(&gFrameArena, mark);
+        break;
     }
-    return data;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image->levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    int bytes = packedTextureBytes(&packed);
+    freePackedTexture(&packed);
+    return bytes;
 }
 
-static GLuint createTexture(unsigned int *data)
+static GLuint createTexture(void)
 {
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_SIZE, TEX_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     return tex;
 }
 
-static void initTextures(void)
+/* Re-specifies the same texture names in the current mode's formats; a failed build gets a blank texture */
+static void uploadTextures(void)
 {
-    unsigned int *data;
-
-    data = generateBrickTextureData();
-    gBrickTexture = createTexture(data);
-    free(data);
+    static const TextureImage blank = {0, 0, NULL};
+    GLuint textures[TEXTURE_KIND_COUNT] = {gBrickTexture, gExitTexture, gFloorTexture, gCeilingTexture};
+
+    gTextureBytes = 0;
+    for (int i = 0; i < TEXTURE_KIND_COUNT; i++) {
+        TextureFormat format = gTextureMode == 0 ? gTextureFormats[i] : (TextureFormat)(gTextureMode - 1);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        gTextureBytes += uploadTexture(gAssets ? &gAssets->images[i] : &blank, format);
+    }
+}
 
-    data = generateExitTextureData();
-    gExitTexture = createTexture(data);
-    free(data);
+static void freeAssetData(void *result)
+{
+    AssetData *data = result;
+    if (!data) return;
 
-    data = generateFloorTextureData();
-    gFloorTexture = createTexture(data);
+    for (int i = 0; i < TEXTURE_KIND_COUNT; i++) freeTextureImage(&data->images[i]);
+    freeSynthSound(&data->winSound);
+    freeSynthSound(&data->selectSound);
     free(data);
+}
 
-    data = generateCeilingTextureData();
-    gCeilingTexture = createTexture(data);
-    free(data);
+/* GL calls stay on the main thread; only the pixels come from the asset job */
+static void initTextures(void)
+{
+    gBrickTexture = createTexture();
+    gExitTexture = createTexture();
+    gFloorTexture = createTexture();
+    gCeilingTexture = createTexture();
+    uploadTextures();
 }
 
 /* ============== Audio ============== */
 
-static void saveWavFile(const char *filename, short *buffer, int samples, int sampleRate)
-{
-    SDL_RWops *file = SDL_RWFromFile(filename, "wb");
-    if (!file) return;
-
-    unsigned int dataSize = samples * 2;
-    unsigned int chunkSize = 36 + dataSize;
-
-    SDL_RWwrite(file, "RIFF", 4, 1);
-    SDL_RWwrite(file, &chunkSize, 4, 1);
-    SDL_RWwrite(file, "WAVE", 4, 1);
-    SDL_RWwrite(file, "fmt ", 4, 1);
-
-    unsigned int fmtSize = 16;
-    unsigned short audioFormat = 1;
-    unsigned short numChannels = 1;
-    unsigned int byteRate = sampleRate * 2;
-    unsigned short blockAlign = 2;
-    unsigned short bitsPerSample = 16;
-
-    SDL_RWwrite(file, &fmtSize, 4, 1);
-    SDL_RWwrite(file, &audioFormat, 2, 1);
-    SDL_RWwrite(file, &numChannels, 2, 1);
-    SDL_RWwrite(file, &sampleRate, 4, 1);
-    SDL_RWwrite(file, &byteRate, 4, 1);
-    SDL_RWwrite(file, &blockAlign, 2, 1);
-    SDL_RWwrite(file, &bitsPerSample, 2, 1);
-
-    SDL_RWwrite(file, "data", 4, 1);
-    SDL_RWwrite(file, &dataSize, 4, 1);
-    SDL_RWwrite(file, buffer, dataSize, 1);
-
-    SDL_RWclose(file);
-}
+#define MUSIC_VOICE 0
+
+/* Background music - simple melody, looped by the sequencer */
+static const SynthNote gMelodyNotes[] = {
+    {262, 1}, {294, 1}, {330, 1}, {349, 1}, {392, 1}, {349, 1}, {330, 1}, {294, 1}
+};
+static const SynthPattern gMelody = {gMelodyNotes, 8, 500, 15000, 50, 50, 1};
 
-static void generateAudioFiles(void)
+/* Select sound - fades out over its whole length */
+static const SynthNote gSelectNotes[] = {{440, 1}};
+static const SynthPattern gSelectPattern = {gSelectNotes, 1, 100, 20000, 0, 100, 0};
+
+/* Win sound - rising arpeggio */
+static const SynthNote gWinNotes[] = {{523, 1}, {659, 1}, {784, 1}, {1047, 1}};
+static const SynthPattern gWinPattern = {gWinNotes, 4, 250, 20000, 0, 33, 0};
+
+/* The effects are rendered in memory for the mixer's channels; nothing touches the Memory Stick unless --save-audio asks */
+static void synthesizeSounds(AssetData *data)
 {
-    int sampleRate = 22050;
-
-    /* Background music - simple melody */
-    int musicSamples = sampleRate * 4;
-    short *musicBuffer = malloc(musicSamples * sizeof(short));
-    int notes[] = {262, 294, 330, 349, 392, 349, 330, 294};
-    int samplesPerNote = musicSamples / 8;
-    for (int n = 0; n < 8; n++) {
-        for (int i = 0; i < samplesPerNote; i++) {
-            int idx = n * samplesPerNote + i;
-            double t = (double)i / sampleRate;
-            double envelope = 1.0;
-            int fadeLen = sampleRate / 20;
-            if (i < fadeLen) envelope = (double)i / fadeLen;
-            else if (i > samplesPerNote - fadeLen) envelope = (double)(samplesPerNote - i) / fadeLen;
-            musicBuffer[idx] = (short)(15000 * envelope * sin(2.0 * M_PI * notes[n] * t));
-        }
-    }
-    saveWavFile("bgmusic.wav", musicBuffer, musicSamples, sampleRate);
-    free(musicBuffer);
-
-    /* Select sound */
-    int selectSamples = sampleRate / 10;
-    short *selectBuffer = malloc(selectSamples * sizeof(short));
-    for (int i = 0; i < selectSamples; i++) {
-        double t = (double)i / sampleRate;
-        double envelope = 1.0 - (double)i / selectSamples;
-        selectBuffer[i] = (short)(20000 * envelope * sin(2.0 * M_PI * 440 * t));
-    }
-    saveWavFile("select.wav", selectBuffer, selectSamples, sampleRate);
-    free(selectBuffer);
-
-    /* Win sound */
-    int winSamples = sampleRate;
-    short *winBuffer = malloc(winSamples * sizeof(short));
-    int winNotes[] = {523, 659, 784, 1047};
-    int winSamplesPerNote = winSamples / 4;
-    for (int n = 0; n < 4; n++) {
-        for (int i = 0; i < winSamplesPerNote; i++) {
-            int idx = n * winSamplesPerNote + i;
-            double t = (double)i / sampleRate;
-            double envelope = 1.0;
-            if (i > winSamplesPerNote - sampleRate/30)
-                envelope = (double)(winSamplesPerNote - i) / (sampleRate/30);
-            winBuffer[idx] = (short)(20000 * envelope * sin(2.0 * M_PI * winNotes[n] * t));
+    renderSynthPattern(&data->selectSound, &gSelectPattern, SAMPLE_RATE);
+    renderSynthPattern(&data->winSound, &gWinPattern, SAMPLE_RATE);
+
+    if (gSaveAudio) {
+        SynthSound music;
+        if (renderSynthPattern(&music, &gMelody, SAMPLE_RATE) == 0) {
+            saveSynthSound(&music, "bgmusic.wav");
+            freeSynthSound(&music);
         }
+        saveSynthSound(&data->selectSound, "select.wav");
+        saveSynthSound(&data->winSound, "win.wav");
     }
-    saveWavFile("win.wav", winBuffer, winSamples, sampleRate);
-    free(winBuffer);
 }
 
-/* ============== Maze Generation ============== */
+/* Main thread: the chunks are decoded into the mixer's format, so their sounds can go */
+static void initSounds(void)
+{
+    if (!gAssets) return;
 
-#define WALL_N 1
-#define WALL_E 2
-#define WALL_S 4
-#define WALL_W 8
+    gWinSound = synthChunk(&gAssets->winSound);
+    gSelectSound = synthChunk(&gAssets->selectSound);
+    freeSynthSound(&gAssets->winSound);
+    freeSynthSound(&gAssets->selectSound);
+}
 
-typedef struct {
-    int walls;
-    int visited;
-} MazeCell;
+/* The music is never rendered ahead: the hook mixes each block as the mixer asks for it */
+static void initMusic(void)
+{
+    int rate, channels;
+    Uint16 format;
 
-static void generateMaze(int width, int height)
+    if (!Mix_QuerySpec(&rate, &format, &channels) || format != AUDIO_S16SYS) return;
+    initSequencer(&gSequencer, rate, channels);
+    setSequencerVolume(&gSequencer, SEQUENCER_MAX_VOLUME / 2);
+    hookAudioMonitor(&gAudio, sequencerHook, &gSequencer);
+}
+
+/* Stamps the event first so the monitor can time it to the callback that mixes the sound */
+static void playSound(Mix_Chunk *sound)
 {
-    MazeCell *cells = malloc(width * height * sizeof(MazeCell));
-    if (!cells) return;
+    if (!sound) return;
+    markAudioTrigger(&gAudio);
+    Mix_PlayChannel(-1, sound, 0);
+}
 
-    for (int i = 0; i < width * height; i++) {
-        cells[i].walls = WALL_N | WALL_E | WALL_S | WALL_W;
-        cells[i].visited = 0;
-    }
+/* Worker side of the startup job: texture pixels and sound samples, no GL or mixer calls */
+static void *buildAssets(Job *job, void *arg)
+{
+    (void)arg;
 
-    typedef struct { int x, y; } Pos;
-    Pos *stack = malloc(width * height * sizeof(Pos));
-    int stackTop = 0;
+    AssetData *data = calloc(1, sizeof(AssetData));
+    if (!data) return NULL;
 
-    int cx = 0, cy = 0;
-    cells[0].visited = 1;
+    /* Read from the cache next to the EBOOT; only the first launch generates them */
+    for (int i = 0; i < TEXTURE_KIND_COUNT && !jobCancelled(job); i++)
+        loadTexture(&gTextureParams[i], "", &data->images[i]);
 
-    int visited = 1;
-    int total = width * height;
+    if (!jobCancelled(job)) synthesizeSounds(data);
+    return data;
+}
 
-    while (visited < total) {
-        Pos neighbors[4];
-        int dirs[4];
-        int count = 0;
+/* ============== Wall Meshes ============== */
 
-        if (cy > 0 && !cells[(cy - 1) * width + cx].visited) {
-            neighbors[count] = (Pos){cx, cy - 1};
-            dirs[count++] = 0;
-        }
-        if (cx < width - 1 && !cells[cy * width + cx + 1].visited) {
-            neighbors[count] = (Pos){cx + 1, cy};
-            dirs[count++] = 1;
-        }
-        if (cy < height - 1 && !cells[(cy + 1) * width + cx].visited) {
-            neighbors[count] = (Pos){cx, cy + 1};
-            dirs[count++] = 2;
-        }
-        if (cx > 0 && !cells[cy * width + cx - 1].visited) {
-            neighbors[count] = (Pos){cx - 1, cy};
-            dirs[count++] = 3;
-        }
+/* One quad for a merged run; u counts whole cells along it, so GL_REPEAT tiles the texture once per cell */
+static void appendWallQuad(WallMesh *mesh, const Wall *w)
+{
+    MeshVertex *v = &mesh->vertices[mesh->vertexCount];
+    float length = fabsf(w->x2 - w->x1) + fabsf(w->z2 - w->z1);
+
+    /* Two triangles: bottom-left, bottom-right, top-right / bottom-left, top-right, top-left */
+    v[0] = (MeshVertex){0, 1, w->x1, 0, w->z1};
+    v[1] = (MeshVertex){length, 1, w->x2, 0, w->z2};
+    v[2] = (MeshVertex){length, 0, w->x2, WALL_HEIGHT, w->z2};
+    v[3] = v[0];
+    v[4] = v[2];
+    v[5] = (MeshVertex){0, 0, w->x1, WALL_HEIGHT, w->z1};
+
+    mesh->vertexCount += 6;
+}
 
-        if (count > 0) {
-            int choice = rand() % count;
-            Pos next = neighbors[choice];
-            int dir = dirs[choice];
-
-            switch (dir) {
-                case 0:
-                    cells[cy * width + cx].walls &= ~WALL_N;
-                    cells[next.y * width + next.x].walls &= ~WALL_S;
-                    break;
-                case 1:
-                    cells[cy * width + cx].walls &= ~WALL_E;
-                    cells[next.y * width + next.x].walls &= ~WALL_W;
-                    break;
-                case 2:
-                    cells[cy * width + cx].walls &= ~WALL_S;
-                    cells[next.y * width + next.x].walls &= ~WALL_N;
-                    break;
-                case 3:
-                    cells[cy * width + cx].walls &= ~WALL_W;
-                    cells[next.y * width + next.x].walls &= ~WALL_E;
-                    break;
-            }
+/* The storage stays in the level's arena; the wall rebuild before this one already released it */
+static int allocWallMesh(Level *level, WallMesh *mesh, int quadCount)
+{
+    mesh->vertices = NULL;
+    mesh->vertexCount = 0;
+    mesh->capacity = 0;
+    if (quadCount == 0) return 1;
+    mesh->vertices = arenaAlloc(&level->arena, quadCount * 6 * sizeof(MeshVertex));
+    if (!mesh->vertices) return 0;
+    mesh->capacity = quadCount * 6;
+    return 1;
+}
 
-            stack[stackTop++] = (Pos){cx, cy};
-            cx = next.x;
-            cy = next.y;
-            cells[cy * width + cx].visited = 1;
-            visited++;
-        } else {
-            stackTop--;
-            cx = stack[stackTop].x;
-            cy = stack[stackTop].y;
-        }
+/* Forgets the meshes and visibility, whose storage went with the old wall list; nothing is drawn until a rebuild */
+static void clearWallMeshes(Level *level)
+{
+    memset(&level->brickMesh, 0, sizeof(level->brickMesh));
+    memset(&level->exitMesh, 0, sizeof(level->exitMesh));
+    memset(&level->visibleBrick, 0, sizeof(level->visibleBrick));
+    memset(&level->visibleExit, 0, sizeof(level->visibleExit));
+    memset(&level->visibility, 0, sizeof(level->visibility));
+    level->runQueued = NULL;
+}
+
+/*
+ * Pack every wall run of the resident window into one vertex array per
+ * texture so a frame draws them in two calls. Rebuilt whenever the window
+ * moves, right after updateWorld rebuilt the wall list. Returns 0 on
+ * success; on failure, which LEVEL_ARENA_SIZE rules out, the level is left
+ * with no walls to draw.
+ */
+static int buildWallMeshes(Level *level)
+{
+    const Maze *maze = &level->world.window;
+    clearWallMeshes(level);
+
+    int exitCount = 0;
+    for (int i = 0; i < maze->runCount; i++) {
+        if (maze->runs[i].isExit) exitCount++;
+    }
+    int brickCount = maze->runCount - exitCount;
+
+    /* The visible-set meshes are refilled every frame; a frame that sees more draws the full meshes */
+    if (!allocWallMesh(level, &level->brickMesh, brickCount) ||
+        !allocWallMesh(level, &level->exitMesh, exitCount) ||
+        !allocWallMesh(level, &level->visibleBrick, brickCount < VISIBLE_MAX_RUNS ? brickCount : VISIBLE_MAX_RUNS) ||
+        !allocWallMesh(level, &level->visibleExit, exitCount < VISIBLE_MAX_RUNS ? exitCount : VISIBLE_MAX_RUNS)) {
+        clearWallMeshes(level);
+        return -1;
     }
 
-    /* Convert to wall grid */
-    gGridWidth = width * 2 + 1;
-    gGridHeight = height * 2 + 1;
+    level->runQueued = arenaCalloc(&level->arena, maze->runCount > 0 ? maze->runCount : 1, 1);
+    if (!level->runQueued) {
+        clearWallMeshes(level);
+        return -1;
+    }
 
-    if (gWallGrid) free(gWallGrid);
-    gWallGrid = malloc(gGridWidth * gGridHeight * sizeof(int));
+    for (int i = 0; i < maze->runCount; i++) {
+        const Wall *w = &maze->runs[i];
+        appendWallQuad(w->isExit ? &level->exitMesh : &level->brickMesh, w);
+    }
 
-    for (int i = 0; i < gGridWidth * gGridHeight; i++) {
-        gWallGrid[i] = 1;
+    if (initVisibility(&level->visibility, maze) < 0) {
+        clearWallMeshes(level);
+        return -1;
     }
+    return 0;
+}
+
+/* ============== Level Management ============== */
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int gx = x * 2 + 1;
-            int gy = y * 2 + 1;
+#define START_X 1.5f
+#define START_Y 1.5f
 
-            /* Mark exit cell */
-            if (x == width - 1 && y == height - 1) {
-                gWallGrid[gy * gGridWidth + gx] = 2;
-            } else {
-                gWallGrid[gy * gGridWidth + gx] = 0;
-            }
+static void freeLevel(void *result)
+{
+    Level *level = result;
+    if (!level) return;
 
-            MazeCell *cell = &cells[y * width + x];
-            if (!(cell->walls & WALL_E) && x < width - 1) {
-                gWallGrid[gy * gGridWidth + gx + 1] = 0;
-            }
-            if (!(cell->walls & WALL_S) && y < height - 1) {
-                gWallGrid[(gy + 1) * gGridWidth + gx] = 0;
-            }
-        }
+    /* The Level is inside its own arena, so copy the arena out before freeing the block */
+    Arena arena = level->arena;
+    freeArena(&arena);
+}
+
+/* Worker side of the level job: grid, wall list and meshes for the starting window */
+static void *buildLevel(Job *job, void *arg)
+{
+    const LevelRequest *req = arg;
+
+    Arena arena;
+    if (initArena(&arena, LEVEL_ARENA_SIZE) < 0) return NULL;
+    Level *level = arenaCalloc(&arena, 1, sizeof(Level));
+    if (!level) {
+        freeArena(&arena);
+        return NULL;
     }
+    level->arena = arena;
 
-    free(cells);
-    free(stack);
-
-    /* Build wall list for rendering */
-    if (gWalls) free(gWalls);
-    gWalls = malloc(gGridWidth * gGridHeight * 4 * sizeof(Wall));
-    gWallCount = 0;
-
-    for (int y = 0; y < gGridHeight; y++) {
-        for (int x = 0; x < gGridWidth; x++) {
-            int cell = gWallGrid[y * gGridWidth + x];
-            if (cell == 1) {
-                /* Check each side for visible walls */
-                float fx = (float)x;
-                float fy = (float)y;
-
-                /* North face */
-                if (y > 0 && gWallGrid[(y-1) * gGridWidth + x] != 1) {
-                    gWalls[gWallCount].x1 = fx;
-                    gWalls[gWallCount].z1 = fy;
-                    gWalls[gWallCount].x2 = fx + 1;
-                    gWalls[gWallCount].z2 = fy;
-                    gWalls[gWallCount].isExit = 0;
-                    gWallCount++;
-                }
-                /* South face */
-                if (y < gGridHeight - 1 && gWallGrid[(y+1) * gGridWidth + x] != 1) {
-                    gWalls[gWallCount].x1 = fx + 1;
-                    gWalls[gWallCount].z1 = fy + 1;
-                    gWalls[gWallCount].x2 = fx;
-                    gWalls[gWallCount].z2 = fy + 1;
-                    gWalls[gWallCount].isExit = 0;
-                    gWallCount++;
-                }
-                /* West face */
-                if (x > 0 && gWallGrid[y * gGridWidth + x - 1] != 1) {
-                    gWalls[gWallCount].x1 = fx;
-                    gWalls[gWallCount].z1 = fy + 1;
-                    gWalls[gWallCount].x2 = fx;
-                    gWalls[gWallCount].z2 = fy;
-                    gWalls[gWallCount].isExit = 0;
-                    gWallCount++;
-                }
-                /* East face */
-                if (x < gGridWidth - 1 && gWallGrid[y * gGridWidth + x + 1] != 1) {
-                    gWalls[gWallCount].x1 = fx + 1;
-                    gWalls[gWallCount].z1 = fy;
-                    gWalls[gWallCount].x2 = fx + 1;
-                    gWalls[gWallCount].z2 = fy + 1;
-                    gWalls[gWallCount].isExit = 0;
-                    gWallCount++;
-                }
-            }
-            /* Exit cell walls are green */
-            else if (cell == 2) {
-                float fx = (float)x;
-                float fy = (float)y;
-
-                if (y > 0 && gWallGrid[(y-1) * gGridWidth + x] == 1) {
-                    gWalls[gWallCount].x1 = fx;
-                    gWalls[gWallCount].z1 = fy;
-                    gWalls[gWallCount].x2 = fx + 1;
-                    gWalls[gWallCount].z2 = fy;
-                    gWalls[gWallCount].isExit = 1;
-                    gWallCount++;
-                }
-                if (y < gGridHeight - 1 && gWallGrid[(y+1) * gGridWidth + x] == 1) {
-                    gWalls[gWallCount].x1 = fx + 1;
-                    gWalls[gWallCount].z1 = fy + 1;
-                    gWalls[gWallCount].x2 = fx;
-                    gWalls[gWallCount].z2 = fy + 1;
-                    gWalls[gWallCount].isExit = 1;
-                    gWallCount++;
-                }
-                if (x > 0 && gWallGrid[y * gGridWidth + x - 1] == 1) {
-                    gWalls[gWallCount].x1 = fx;
-                    gWalls[gWallCount].z1 = fy + 1;
-                    gWalls[gWallCount].x2 = fx;
-                    gWalls[gWallCount].z2 = fy;
-                    gWalls[gWallCount].isExit = 1;
-                    gWallCount++;
-                }
-                if (x < gGridWidth - 1 && gWallGrid[y * gGridWidth + x + 1] == 1) {
-                    gWalls[gWallCount].x1 = fx + 1;
-                    gWalls[gWallCount].z1 = fy;
-                    gWalls[gWallCount].x2 = fx + 1;
-                    gWalls[gWallCount].z2 = fy + 1;
-                    gWalls[gWallCount].isExit = 1;
-                    gWallCount++;
-                }
-            }
-        }
+    if (initWorld(&level->world, req->mazeWidth, req->mazeHeight, req->seed, &level->arena) < 0 || jobCancelled(job) ||
+        updateWorld(&level->world, START_X, START_Y) < 0 || jobCancelled(job) ||
+        buildWallMeshes(level) < 0) {
+        freeLevel(level);
+        return NULL;
     }
+    return level;
 }
 
-/* ============== Collision Detection ============== */
-
-static int isWall(int x, int y)
+/* Starts building a level in the background, replacing any other level still being built */
+static void prefetchLevel(int level)
 {
-    if (x < 0 || x >= gGridWidth || y < 0 || y >= gGridHeight) return 1;
-    return gWallGrid[y * gGridWidth + x] == 1;
+    if (jobPending(&gLevelJob) && gPendingLevel == level) return;
+    cancelJob(&gLevelJob);
+
+    LevelConfig *cfg = &gLevels[level];
+    gLevelRequest.number = level;
+    gLevelRequest.mazeWidth = cfg->mazeWidth;
+    gLevelRequest.mazeHeight = cfg->mazeHeight;
+    gLevelRequest.seed = gSeedBase + level;
+
+    startJob(&gLevelJob, "levelgen", buildLevel, freeLevel, &gLevelRequest);
+    gPendingLevel = level;
 }
 
-static int isExit(int x, int y)
+/* Switches to a level, normally one prefetched while the previous screen was up. Returns 0 on success. */
+static int loadLevel(int level)
 {
-    if (x < 0 || x >= gGridWidth || y < 0 || y >= gGridHeight) return 0;
-    return gWallGrid[y * gGridWidth + x] == 2;
+    prefetchLevel(level);
+
+    Level *next = finishJob(&gLevelJob);
+    gPendingLevel = -1;
+    if (!next) return -1;
+
+    Level *old = gLevel;
+    gLevel = next;
+    freeLevel(old);
+
+    gCurrentLevel = level;
+    gPlayer.x = START_X;
+    gPlayer.y = START_Y;
+    gPlayer.angle = 0;
+    gPrevPlayer = gPlayer;
+    gView = gPlayer;
+    initFixedStep(&gClock, PLAYER_TICK_RATE, MAX_TICKS_PER_FRAME);
+    return 0;
 }
 
-static int checkCollision(float x, float y)
+/* ============== Player Movement ============== */
+
+/* Maps the pad to movement controls; digital and analog inputs add up */
+static void readPlayerInput(const SceCtrlData *pad, PlayerInput *input)
 {
-    int minX = (int)(x - PLAYER_RADIUS);
-    int maxX = (int)(x + PLAYER_RADIUS);
-    int minY = (int)(y - PLAYER_RADIUS);
-    int maxY = (int)(y + PLAYER_RADIUS);
-
-    for (int cy = minY; cy <= maxY; cy++) {
-        for (int cx = minX; cx <= maxX; cx++) {
-            if (isWall(cx, cy)) {
-                float closestX = fmaxf((float)cx, fminf(x, (float)(cx + 1)));
-                float closestY = fmaxf((float)cy, fminf(y, (float)(cy + 1)));
-                float dx = x - closestX;
-                float dy = y - closestY;
-                if (dx * dx + dy * dy < PLAYER_RADIUS * PLAYER_RADIUS) {
-                    return 1;
-                }
-            }
-        }
+    input->forward = 0;
+    input->strafe = 0;
+    input->turn = 0;
+
+    if (pad->Buttons & PSP_CTRL_UP) input->forward += 1;
+    if (pad->Buttons & PSP_CTRL_DOWN) input->forward -= 1;
+    if (pad->Buttons & PSP_CTRL_LEFT) input->turn -= 1;
+    if (pad->Buttons & PSP_CTRL_RIGHT) input->turn += 1;
+    if (pad->Buttons & PSP_CTRL_LTRIGGER) input->strafe -= 1;
+    if (pad->Buttons & PSP_CTRL_RTRIGGER) input->strafe += 1;
+
+    /* Analog stick */
+    if (pad->Lx != 128 || pad->Ly != 128) {
+        float axisX = (pad->Lx - 128) / 128.0f;
+        float axisY = (pad->Ly - 128) / 128.0f;
+
+        if (fabsf(axisX) > 0.2f) input->turn += axisX;
+        if (fabsf(axisY) > 0.2f) input->forward -= axisY;
     }
-    return 0;
 }
 
-static void movePlayer(float dx, float dy)
+/* One fixed simulation tick */
+static void simulateTick(const PlayerInput *input)
 {
-    float newX = gPlayer.x + dx;
-    float newY = gPlayer.y + dy;
-
-    if (!checkCollision(newX, newY)) {
-        gPlayer.x = newX;
-        gPlayer.y = newY;
-    } else if (!checkCollision(newX, gPlayer.y)) {
-        gPlayer.x = newX;
-    } else if (!checkCollision(gPlayer.x, newY)) {
-        gPlayer.y = newY;
+    World *world = &gLevel->world;
+
+    gPrevPlayer = gPlayer;
+    stepPlayer(&gPlayer, world, input);
+
+    /*
+     * Stream in the chunks around the new position before anything looks at
+     * them. LEVEL_ARENA_SIZE covers the largest window a level can have, so
+     * a failed rebuild means that bound is wrong: it is reported, and the
+     * old meshes, gone with the rewound arena, are not drawn.
+     */
+    int moved = updateWorld(world, gPlayer.x, gPlayer.y);
+    if (moved < 0 || (moved > 0 && buildWallMeshes(gLevel) < 0)) {
+        fprintf(stderr, "Window at %d,%d does not fit the level arena\n", world->originX, world->originY);
+        clearWallMeshes(gLevel);
     }
 
+    /* Queries this tick see every entity where it now stands */
+    gEntities[ENTITY_PLAYER] = (SpatialEntity){gPlayer.x, gPlayer.y, PLAYER_RADIUS};
+    buildSpatialHash(&gEntityHash, gEntities, gEntityCount);
+
     int px = (int)gPlayer.x;
     int py = (int)gPlayer.y;
-    if (isExit(px, py)) {
-        if (gWinSound) Mix_PlayChannel(-1, gWinSound, 0);
+    if (worldIsExit(world, px, py)) {
+        playSound(gWinSound);
         if (gCurrentLevel < 2) {
             gState = STATE_LEVEL_COMPLETE;
+            /* Build the next level while the level complete screen is showing */
+            prefetchLevel(gCurrentLevel + 1);
         } else {
             gState = STATE_WIN;
         }
     }
 }
 
-/* ============== Level Management ============== */
-
-static void loadLevel(int level)
-{
-    gCurrentLevel = level;
-    LevelConfig *cfg = &gLevels[level];
-
-    srand((unsigned int)time(NULL) + level);
-    generateMaze(cfg->mazeWidth, cfg->mazeHeight);
-
-    gPlayer.x = 1.5f;
-    gPlayer.y = 1.5f;
-    gPlayer.angle = 0;
-}
-
 /* ============== OpenGL Rendering ============== */
 
 static void setupGL(void)
@@ -621,36 +670,86 @@ static void setupGL(void)
     glEnable(GL_FOG);
     glFogi(GL_FOG_MODE, GL_LINEAR);
     glFogf(GL_FOG_START, 3.0f);
-    glFogf(GL_FOG_END, 15.0f);
+    glFogf(GL_FOG_END, FOG_END);
     float fogColor[] = {0.1f, 0.1f, 0.15f, 1.0f};
     glFogfv(GL_FOG_COLOR, fogColor);
 
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
 }
 
-static void renderWalls(void)
+static void drawWallMesh(const WallMesh *mesh, GLuint texture)
 {
-    for (int i = 0; i < gWallCount; i++) {
-        Wall *w = &gWalls[i];
+    if (mesh->vertexCount == 0) return;
 
-        if (w->isExit) {
-            glBindTexture(GL_TEXTURE_2D, gExitTexture);
-        } else {
-            glBindTexture(GL_TEXTURE_2D, gBrickTexture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(MeshVertex), &mesh->vertices[0].u);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), &mesh->vertices[0].x);
+    glDrawArrays(GL_TRIANGLES, 0, mesh->vertexCount);
+
+    gStats.textureBinds++;
+    gStats.drawCalls++;
+    gStats.vertices += mesh->vertexCount;
+}
+
+/*
+ * Refill the visible-set meshes from the walls the ray fan reached this
+ * frame. A face is drawn as the whole run it belongs to, once however many
+ * of its faces were hit: a few more pixels than the faces alone, far fewer
+ * triangles down a corridor. Returns 0 if the runs did not all fit.
+ */
+static int buildVisibleMeshes(void)
+{
+    Level *level = gLevel;
+    const Maze *maze = &level->world.window;
+
+    computeVisibility(&level->visibility, maze,
+                      gView.x - level->world.originX, gView.y - level->world.originY, gView.angle,
+                      CULL_FOV, FOG_END, CULL_RAYS);
+
+    level->visibleBrick.vertexCount = 0;
+    level->visibleExit.vertexCount = 0;
+    int fits = 1;
+    for (int i = 0; i < level->visibility.count; i++) {
+        int run = maze->wallRuns[level->visibility.walls[i]];
+        if (level->runQueued[run]) continue;
+        level->runQueued[run] = 1;
+
+        const Wall *w = &maze->runs[run];
+        WallMesh *mesh = w->isExit ? &level->visibleExit : &level->visibleBrick;
+        if (mesh->vertexCount + 6 > mesh->capacity) {
+            fits = 0;
+            continue;
         }
+        appendWallQuad(mesh, w);
+    }
 
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 1); glVertex3f(w->x1, 0, w->z1);
-        glTexCoord2f(1, 1); glVertex3f(w->x2, 0, w->z2);
-        glTexCoord2f(1, 0); glVertex3f(w->x2, WALL_HEIGHT, w->z2);
-        glTexCoord2f(0, 0); glVertex3f(w->x1, WALL_HEIGHT, w->z1);
-        glEnd();
+    /* Clear only what was set, so the pass stays proportional to what is in view */
+    for (int i = 0; i < level->visibility.count; i++) {
+        level->runQueued[maze->wallRuns[level->visibility.walls[i]]] = 0;
     }
+    return fits;
+}
+
+static void renderWalls(void)
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    if (gCullingEnabled && gLevel->visibility.walls && buildVisibleMeshes()) {
+        drawWallMesh(&gLevel->visibleBrick, gBrickTexture);
+        drawWallMesh(&gLevel->visibleExit, gExitTexture);
+    } else {
+        drawWallMesh(&gLevel->brickMesh, gBrickTexture);
+        drawWallMesh(&gLevel->exitMesh, gExitTexture);
+    }
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 static void renderFloorCeiling(void)
 {
-    float size = (float)(gGridWidth > gGridHeight ? gGridWidth : gGridHeight);
+    float size = (float)gLevel->world.window.gridWidth;
 
     /* Floor */
     glBindTexture(GL_TEXTURE_2D, gFloorTexture);
@@ -669,22 +768,30 @@ static void renderFloorCeiling(void)
     glTexCoord2f(size, size);  glVertex3f(size, WALL_HEIGHT, size);
     glTexCoord2f(size, 0);     glVertex3f(size, WALL_HEIGHT, 0);
     glEnd();
+
+    gStats.textureBinds += 2;
+    gStats.drawCalls += 2;
+    gStats.vertices += 8;
 }
 
 static void renderScene(void)
 {
+    memset(&gStats, 0, sizeof(gStats));
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
     /* Camera */
-    float lookX = gPlayer.x + cosf(gPlayer.angle);
-    float lookZ = gPlayer.y + sinf(gPlayer.angle);
-    gluLookAt(gPlayer.x, PLAYER_HEIGHT, gPlayer.y,
+    float lookX = gView.x + cosf(gView.angle);
+    float lookZ = gView.y + sinf(gView.angle);
+    gluLookAt(gView.x, PLAYER_HEIGHT, gView.y,
               lookX, PLAYER_HEIGHT, lookZ,
               0, 1, 0);
 
+    /* Window geometry is built relative to its origin, which is always a whole number of texture repeats */
+    glTranslatef((float)gLevel->world.originX, 0, (float)gLevel->world.originY);
+
     glColor3f(1, 1, 1);
     renderFloorCeiling();
     renderWalls();
@@ -692,66 +799,77 @@ static void renderScene(void)
 
 /* ============== 2D Overlay Rendering ============== */
 
-static void beginOrtho(void)
-{
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_FOG);
-    glDisable(GL_TEXTURE_2D);
+/*
+ * Everything below appends to gBatch; the main loop flushes it once per
+ * frame after the scene, so a whole screen of shapes and text is usually a
+ * single draw call.
+ */
 
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, -1, 1);
+static void drawRect(float x, float y, float w, float h, float r, float g, float b, float a)
+{
+    batchRect(&gBatch, x, y, w, h, r, g, b, a);
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+static void drawBar(float x, float y, float w, float h, float r, float g, float b)
+{
+    batchRect(&gBatch, x, y, w, h, r, g, b, 1);
 }
 
-static void endOrtho(void)
+/* Draw a simple indicator triangle */
+static void drawTriangle(float x, float y, float size, float r, float g, float b)
 {
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    batchTriangle(&gBatch, x, y, x + size, y + size / 2, x, y + size, r, g, b, 1);
+}
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_FOG);
-    glEnable(GL_TEXTURE_2D);
+/* Text with its top-left corner at (x, y) */
+static void drawText(float x, float y, float scale, const char *text, float r, float g, float b)
+{
+    batchText(&gBatch, x, y, scale, text, r, g, b, 1);
 }
 
-static void drawRect(float x, float y, float w, float h, float r, float g, float b, float a)
+/* Text centred on x */
+static void drawTextCentered(float x, float y, float scale, const char *text, float r, float g, float b)
 {
-    glColor4f(r, g, b, a);
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x + w, y);
-    glVertex2f(x + w, y + h);
-    glVertex2f(x, y + h);
-    glEnd();
+    drawText(x - measureBatchText(&gBatch, text, scale) / 2, y, scale, text, r, g, b);
 }
 
-/* Simple bar indicator instead of text (pspgl lacks bitmap fonts) */
-static void drawBar(float x, float y, float w, float h, float r, float g, float b)
+/* Seven-segment digits, bit 0 = top, then clockwise, bit 6 = middle; used when the font did not load */
+static const unsigned char gSegments[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+
+static void drawDigit(float x, float y, int digit, float r, float g, float b)
 {
-    glColor3f(r, g, b);
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x + w, y);
-    glVertex2f(x + w, y + h);
-    glVertex2f(x, y + h);
-    glEnd();
+    const float w = 6, h = 10, t = 1.5f;
+    unsigned char seg = gSegments[digit];
+
+    if (seg & 0x01) drawBar(x, y, w, t, r, g, b);
+    if (seg & 0x02) drawBar(x + w - t, y, t, h / 2, r, g, b);
+    if (seg & 0x04) drawBar(x + w - t, y + h / 2, t, h / 2, r, g, b);
+    if (seg & 0x08) drawBar(x, y + h - t, w, t, r, g, b);
+    if (seg & 0x10) drawBar(x, y + h / 2, t, h / 2, r, g, b);
+    if (seg & 0x20) drawBar(x, y, t, h / 2, r, g, b);
+    if (seg & 0x40) drawBar(x, y + (h - t) / 2, w, t, r, g, b);
 }
 
-/* Draw a simple indicator triangle */
-static void drawTriangle(float x, float y, float size, float r, float g, float b)
+/* Right-aligned number ending at x, about 10 pixels tall */
+static void drawNumber(float x, float y, int value, float r, float g, float b)
 {
-    glColor3f(r, g, b);
-    glBegin(GL_TRIANGLES);
-    glVertex2f(x, y);
-    glVertex2f(x + size, y + size/2);
-    glVertex2f(x, y + size);
-    glEnd();
+    if (value < 0) value = 0;
+
+    if (batchHasText(&gBatch)) {
+        char text[16];
+        snprintf(text, sizeof(text), "%d", value);
+        float scale = 10.0f / batchLineHeight(&gBatch, 1);
+        drawText(x - measureBatchText(&gBatch, text, scale), y - 1, scale, text, r, g, b);
+        return;
+    }
+
+    do {
+        x -= 8;
+        drawDigit(x, y, value % 10, r, g, b);
+        value /= 10;
+    } while (value > 0);
 }
 
 /* ============== Game State Rendering ============== */
@@ -771,9 +889,11 @@ static void updateFPS(void)
 
 static void renderHUD(void)
 {
-    beginOrtho();
+    char text[32];
 
-    /* Level indicator - bars */
+    /* Level number over one bar per level reached */
+    snprintf(text, sizeof(text), "LEVEL %d/3", gCurrentLevel + 1);
+    drawText(10, 28, 0.75f, text, 1, 1, 1);
     for (int i = 0; i <= gCurrentLevel; i++) {
         drawBar(10 + i * 25, 10, 20, 15, 1, 1, 1);
     }
@@ -781,273 +901,264 @@ static void renderHUD(void)
     /* FPS indicator - green/yellow/red based on performance */
     float fpsColor = gFPS >= 50 ? 1.0f : (gFPS >= 30 ? 0.5f : 0.0f);
     drawBar(SCREEN_WIDTH - 60, 10, 50 * (gFPS / 60.0f), 10, fpsColor, 1.0f - fpsColor, 0);
+    drawNumber(SCREEN_WIDTH - 10, 24, gFPS, 1, 1, 1);
 
     /* Exit hint - green arrow at bottom */
     drawTriangle(10, SCREEN_HEIGHT - 30, 20, 0, 1, 0);
 
-    endOrtho();
+    /* Render stats - purple marker: texture KB and mode, blue marker: draw calls, orange marker: vertices */
+    drawBar(SCREEN_WIDTH - 110, SCREEN_HEIGHT - 56, 4, 10, 0.7f, 0.3f, 1.0f);
+    drawNumber(SCREEN_WIDTH - 70, SCREEN_HEIGHT - 56, gTextureMode, 0.7f, 0.3f, 1.0f);
+    drawNumber(SCREEN_WIDTH - 10, SCREEN_HEIGHT - 56, gTextureBytes / 1024, 1, 1, 1);
+    drawBar(SCREEN_WIDTH - 110, SCREEN_HEIGHT - 40, 4, 10, 0.3f, 0.5f, 1.0f);
+    drawNumber(SCREEN_WIDTH - 10, SCREEN_HEIGHT - 40, gStats.drawCalls, 1, 1, 1);
+    drawBar(SCREEN_WIDTH - 110, SCREEN_HEIGHT - 24, 4, 10, 1.0f, 0.6f, 0.1f);
+    drawNumber(SCREEN_WIDTH - 10, SCREEN_HEIGHT - 24, gStats.vertices, 1, 1, 1);
 }
 
-static void renderMenu(void)
+/*
+ * Frame time graph (one bar per frame, white line at the 60 Hz budget) and,
+ * per row, a section colour followed by its p50 and p99 in tenths of a ms.
+ * The first row is the whole frame, then sections in first-use order.
+ */
+static void renderProfiler(void)
+{
+    static const float colors[][3] = {
+        {1, 1, 1}, {0.3f, 0.6f, 1}, {1, 0.6f, 0.1f}, {0.2f, 1, 0.4f}, {1, 0.3f, 0.8f}, {1, 1, 0.2f}
+    };
+    const float x = 10, y = 40, graphH = 40, maxMs = 33.3f;
+
+    /* Above the HUD it covers */
+    batchLayer(&gBatch, 1);
+    drawRect(x - 4, y - 4, 248, graphH + 8 + 14 * (profilerSectionCount() + 2), 0, 0, 0, 0.6f);
+
+    /* Oldest on the left */
+    int frames = profilerFrameCount() < 120 ? profilerFrameCount() : 120;
+    for (int i = 0; i < frames; i++) {
+        float ms = profilerFrameMs(-1, i);
+        float h = ms * graphH / maxMs;
+        if (h > graphH) h = graphH;
+        float bx = x + (frames - 1 - i) * 2;
+        if (ms <= 16.7f) drawBar(bx, y + graphH - h, 2, h, 0, 0.8f, 0);
+        else if (ms <= 33.3f) drawBar(bx, y + graphH - h, 2, h, 0.9f, 0.8f, 0);
+        else drawBar(bx, y + graphH - h, 2, h, 0.9f, 0.15f, 0.15f);
+    }
+    drawBar(x, y + graphH - 16.7f * graphH / maxMs, 240, 1, 1, 1, 1);
+
+    ProfileStats stats;
+    float rowY = y + graphH + 4;
+    for (int s = -1; s < profilerSectionCount(); s++) {
+        const float *c = colors[(s + 1) % (int)(sizeof(colors) / sizeof(colors[0]))];
+        profilerStats(s, PROFILER_STATS_FRAMES, &stats);
+        drawBar(x, rowY, 4, 10, c[0], c[1], c[2]);
+        drawText(x + 130, rowY - 1, 10.0f / batchLineHeight(&gBatch, 1), s < 0 ? "frame" : profilerSectionName(s),
+                 c[0], c[1], c[2]);
+        drawNumber(x + 60, rowY, (int)(stats.p50 * 10 + 0.5f), 1, 1, 1);
+        drawNumber(x + 120, rowY, (int)(stats.p99 * 10 + 0.5f), 1, 0.6f, 0.6f);
+        rowY += 14;
+    }
+
+    /* Audio row: press-to-heard p50 (callback wait plus the buffer queued ahead) and underruns */
+    AudioStats audio;
+    audioMonitorStats(&gAudio, &audio);
+    drawBar(x, rowY, 4, 10, 0.3f, 1, 1);
+    if (audio.presses > 0) drawNumber(x + 60, rowY, (int)((audio.p50Ms + audio.periodMs) * 10 + 0.5f), 0.3f, 1, 1);
+    drawNumber(x + 120, rowY, audio.underruns, 1, 0.6f, 0.6f);
+    drawText(x + 130, rowY - 1, 10.0f / batchLineHeight(&gBatch, 1), "audio", 0.3f, 1, 1);
+
+    batchLayer(&gBatch, 0);
+}
+
+static void renderLoading(void)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    beginOrtho();
 
     drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0.05f, 0.05f, 0.1f, 1);
+    drawTextCentered(SCREEN_WIDTH / 2, 100, 1, "LOADING", 1, 1, 1);
 
-    /* Title - large white bar */
-    drawBar(140, 40, 200, 30, 1, 1, 1);
+    /* Sliding block inside a track - the asset job has no progress to report */
+    float t = (SDL_GetTicks() % 1000) / 1000.0f;
+    drawBar(140, 130, 200, 12, 0.2f, 0.2f, 0.3f);
+    drawBar(140 + t * 160, 130, 40, 12, 1, 1, 1);
+}
+
+/* Two boxed items with the selected one in yellow behind an arrow */
+static void drawMenuItems(float y, const char *first, const char *second, int selection)
+{
+    const char *items[2] = {first, second};
 
-    /* Menu items - boxes with selection indicator */
     for (int i = 0; i < 2; i++) {
-        float r = (i == gMenuSelection) ? 1.0f : 0.4f;
-        float g = (i == gMenuSelection) ? 1.0f : 0.4f;
-        float b = (i == gMenuSelection) ? 0.0f : 0.4f;
+        float c = (i == selection) ? 1.0f : 0.4f;
 
-        drawBar(180, 110 + i * 40, 120, 25, r, g, b);
+        drawBar(180, y + i * 40, 120, 25, c, c, i == selection ? 0.0f : 0.4f);
+        drawTextCentered(240, y + i * 40 + 3, 1, items[i], i == selection ? 0.05f : 0.9f,
+                         i == selection ? 0.05f : 0.9f, i == selection ? 0.1f : 0.9f);
 
         /* Selection arrow */
-        if (i == gMenuSelection) {
-            drawTriangle(155, 112 + i * 40, 20, 1, 1, 0);
+        if (i == selection) {
+            drawTriangle(155, y + 2 + i * 40, 20, 1, 1, 0);
         }
     }
+}
 
-    /* Start = green tint, Quit = red tint inside the bars */
-    drawBar(185, 115, 30, 15, 0, 0.8f, 0);  /* Start indicator */
-    drawBar(185, 155, 30, 15, 0.8f, 0, 0);  /* Quit indicator */
+static void renderMenu(void)
+{
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    endOrtho();
+    drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0.05f, 0.05f, 0.1f, 1);
+    drawTextCentered(SCREEN_WIDTH / 2, 36, 2, "3D MAZE", 1, 1, 1);
+    drawMenuItems(110, "START", "QUIT", gMenuSelection);
 }
 
 static void renderPause(void)
 {
-    beginOrtho();
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 0.7f);
-    glDisable(GL_BLEND);
-
-    /* Pause title bar */
-    drawBar(180, 60, 120, 25, 1, 1, 1);
-
-    /* Menu items */
-    for (int i = 0; i < 2; i++) {
-        float r = (i == gPauseSelection) ? 1.0f : 0.4f;
-        float g = (i == gPauseSelection) ? 1.0f : 0.4f;
-        float b = (i == gPauseSelection) ? 0.0f : 0.4f;
-
-        drawBar(180, 120 + i * 40, 120, 25, r, g, b);
-
-        if (i == gPauseSelection) {
-            drawTriangle(155, 122 + i * 40, 20, 1, 1, 0);
-        }
-    }
-
-    /* Resume = green, Quit = red */
-    drawBar(185, 125, 30, 15, 0, 0.8f, 0);
-    drawBar(185, 165, 30, 15, 0.8f, 0, 0);
-
-    endOrtho();
+    drawTextCentered(SCREEN_WIDTH / 2, 60, 1.5f, "PAUSED", 1, 1, 1);
+    drawMenuItems(120, "RESUME", "QUIT", gPauseSelection);
 }
 
 static void renderLevelComplete(void)
 {
+    char text[32];
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    beginOrtho();
 
     drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0.05f, 0.2f, 0.05f, 1);
 
-    /* Level complete - green bars showing level number */
+    snprintf(text, sizeof(text), "LEVEL %d COMPLETE", gCurrentLevel + 1);
+    drawTextCentered(SCREEN_WIDTH / 2, 40, 1.5f, text, 1, 1, 1);
+
+    /* One green bar per level done */
     for (int i = 0; i <= gCurrentLevel; i++) {
         drawBar(160 + i * 60, 80, 50, 40, 0, 1, 0);
     }
 
-    /* Checkmark shape */
-    drawBar(200, 150, 80, 8, 1, 1, 1);
-
-    /* X button prompt */
-    drawBar(220, 190, 40, 30, 0.3f, 0.3f, 0.8f);
-
-    endOrtho();
+    drawTextCentered(SCREEN_WIDTH / 2, 190, 1, "PRESS X TO CONTINUE", 0.5f, 0.5f, 1);
 }
 
 static void renderWin(void)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    beginOrtho();
 
     drawRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0.2f, 0.1f, 0.2f, 1);
 
     /* Victory - gold star shape (triangle) */
-    drawTriangle(200, 40, 80, 1, 0.85f, 0);
+    drawTriangle(200, 20, 80, 1, 0.85f, 0);
+    drawTextCentered(SCREEN_WIDTH / 2, 104, 1.5f, "YOU ESCAPED", 1, 0.85f, 0);
 
     /* All 3 level bars - completed */
     for (int i = 0; i < 3; i++) {
-        drawBar(140 + i * 70, 130, 60, 30, 0, 1, 0);
+        drawBar(140 + i * 70, 140, 60, 30, 0, 1, 0);
     }
 
-    /* X button prompt */
-    drawBar(220, 200, 40, 30, 0.3f, 0.3f, 0.8f);
-
-    endOrtho();
+    drawTextCentered(SCREEN_WIDTH / 2, 200, 1, "PRESS X FOR THE MENU", 0.5f, 0.5f, 1);
 }
 
 /* ============== Input Handling ============== */
 
 static void handleMenuInput(void)
 {
-    sceCtrlReadBufferPositive(&gPad, 1);
+    updateInput(&gInput);
 
-    if (gPad.Buttons) {
-        if (!gButtonPressed) {
-            if (gPad.Buttons & PSP_CTRL_UP) {
-                gMenuSelection = (gMenuSelection + 1) % 2;
-                if (gSelectSound) Mix_PlayChannel(-1, gSelectSound, 0);
-            }
-            if (gPad.Buttons & PSP_CTRL_DOWN) {
-                gMenuSelection = (gMenuSelection + 1) % 2;
-                if (gSelectSound) Mix_PlayChannel(-1, gSelectSound, 0);
-            }
-            if (gPad.Buttons & PSP_CTRL_CROSS) {
-                if (gMenuSelection == 0) {
-                    loadLevel(0);
-                    gState = STATE_GAME;
-                    Mix_PlayMusic(gMusic, -1);
-                } else {
-                    gState = STATE_QUIT;
-                }
+    if (gInput.pressed & (PSP_CTRL_UP | PSP_CTRL_DOWN)) {
+        gMenuSelection = (gMenuSelection + 1) % 2;
+        playSound(gSelectSound);
+    }
+    if (gInput.pressed & PSP_CTRL_CROSS) {
+        if (gMenuSelection == 0) {
+            if (loadLevel(gFirstLevel) == 0) {
+                gState = STATE_GAME;
+                playVoice(&gSequencer, MUSIC_VOICE, &gMelody);
             }
-            gButtonPressed = 1;
+        } else {
+            gState = STATE_QUIT;
         }
-    } else {
-        gButtonPressed = 0;
     }
 }
 
-static void handleGameInput(void)
+/* Samples the pad once per rendered frame, then runs however many ticks the elapsed time covers */
+static void handleGameInput(float elapsed)
 {
-    sceCtrlReadBufferPositive(&gPad, 1);
+    profileBegin("input");
+    updateInput(&gInput);
 
-    float moveX = 0, moveY = 0;
+    PlayerInput input;
+    readPlayerInput(&gInput.pad, &input);
+    profileEnd();
 
-    if (gPad.Buttons & PSP_CTRL_UP) {
-        moveX += cosf(gPlayer.angle) * MOVE_SPEED;
-        moveY += sinf(gPlayer.angle) * MOVE_SPEED;
-    }
-    if (gPad.Buttons & PSP_CTRL_DOWN) {
-        moveX -= cosf(gPlayer.angle) * MOVE_SPEED;
-        moveY -= sinf(gPlayer.angle) * MOVE_SPEED;
-    }
-    if (gPad.Buttons & PSP_CTRL_LEFT) {
-        gPlayer.angle -= ROT_SPEED;
-    }
-    if (gPad.Buttons & PSP_CTRL_RIGHT) {
-        gPlayer.angle += ROT_SPEED;
-    }
-    if (gPad.Buttons & PSP_CTRL_LTRIGGER) {
-        float strafeAngle = gPlayer.angle - M_PI / 2;
-        moveX += cosf(strafeAngle) * MOVE_SPEED;
-        moveY += sinf(strafeAngle) * MOVE_SPEED;
-    }
-    if (gPad.Buttons & PSP_CTRL_RTRIGGER) {
-        float strafeAngle = gPlayer.angle + M_PI / 2;
-        moveX += cosf(strafeAngle) * MOVE_SPEED;
-        moveY += sinf(strafeAngle) * MOVE_SPEED;
+    profileBegin("sim");
+    int ticks = replayTicks(advanceFixedStep(&gClock, elapsed));
+    for (int i = 0; i < ticks && gState == STATE_GAME; i++) {
+        simulateTick(&input);
     }
+    lerpPlayer(&gView, &gPrevPlayer, &gPlayer, fixedStepAlpha(&gClock));
+    profileEnd();
 
-    /* Analog stick */
-    if (gPad.Lx != 128 || gPad.Ly != 128) {
-        float axisX = (gPad.Lx - 128) / 128.0f;
-        float axisY = (gPad.Ly - 128) / 128.0f;
-
-        if (fabsf(axisX) > 0.2f) {
-            gPlayer.angle += axisX * ROT_SPEED;
-        }
-        if (fabsf(axisY) > 0.2f) {
-            moveX -= cosf(gPlayer.angle) * axisY * MOVE_SPEED;
-            moveY -= sinf(gPlayer.angle) * axisY * MOVE_SPEED;
-        }
+    /* SELECT toggles visibility culling to compare the HUD counters */
+    if (gInput.pressed & PSP_CTRL_SELECT) {
+        gCullingEnabled = !gCullingEnabled;
     }
 
-    while (gPlayer.angle < 0) gPlayer.angle += 2 * M_PI;
-    while (gPlayer.angle >= 2 * M_PI) gPlayer.angle -= 2 * M_PI;
+    /* SQUARE cycles the texture formats: per texture, then all RGBA8888, RGB565, RGBA4444, CLUT8 */
+    if (gInput.pressed & PSP_CTRL_SQUARE) {
+        gTextureMode = (gTextureMode + 1) % TEXTURE_MODE_COUNT;
+        uploadTextures();
+    }
 
-    movePlayer(moveX, moveY);
+    /* TRIANGLE toggles the frame profiler overlay */
+    if (gInput.pressed & PSP_CTRL_TRIANGLE) {
+        gShowProfiler = !gShowProfiler;
+    }
 
-    if (gPad.Buttons & PSP_CTRL_START) {
-        if (!gButtonPressed) {
-            gState = STATE_PAUSE;
-            gPauseSelection = 0;
-            gButtonPressed = 1;
-        }
-    } else if (!(gPad.Buttons & (PSP_CTRL_UP | PSP_CTRL_DOWN | PSP_CTRL_LEFT | PSP_CTRL_RIGHT |
-                                  PSP_CTRL_LTRIGGER | PSP_CTRL_RTRIGGER | PSP_CTRL_CROSS))) {
-        gButtonPressed = 0;
+    if ((gInput.pressed & PSP_CTRL_START) && gState == STATE_GAME) {
+        gState = STATE_PAUSE;
+        gPauseSelection = 0;
     }
 }
 
 static void handlePauseInput(void)
 {
-    sceCtrlReadBufferPositive(&gPad, 1);
+    updateInput(&gInput);
 
-    if (gPad.Buttons) {
-        if (!gButtonPressed) {
-            if (gPad.Buttons & PSP_CTRL_UP) {
-                gPauseSelection = (gPauseSelection + 1) % 2;
-                if (gSelectSound) Mix_PlayChannel(-1, gSelectSound, 0);
-            }
-            if (gPad.Buttons & PSP_CTRL_DOWN) {
-                gPauseSelection = (gPauseSelection + 1) % 2;
-                if (gSelectSound) Mix_PlayChannel(-1, gSelectSound, 0);
-            }
-            if (gPad.Buttons & PSP_CTRL_CROSS) {
-                if (gPauseSelection == 0) {
-                    gState = STATE_GAME;
-                } else {
-                    gState = STATE_MENU;
-                    Mix_HaltMusic();
-                }
-            }
-            if (gPad.Buttons & PSP_CTRL_START) {
-                gState = STATE_GAME;
-            }
-            gButtonPressed = 1;
+    if (gInput.pressed & (PSP_CTRL_UP | PSP_CTRL_DOWN)) {
+        gPauseSelection = (gPauseSelection + 1) % 2;
+        playSound(gSelectSound);
+    }
+    if (gInput.pressed & PSP_CTRL_CROSS) {
+        if (gPauseSelection == 0) {
+            gState = STATE_GAME;
+        } else {
+            gState = STATE_MENU;
+            playVoice(&gSequencer, MUSIC_VOICE, NULL);
+            prefetchLevel(gFirstLevel);
         }
-    } else {
-        gButtonPressed = 0;
+    }
+    if ((gInput.pressed & PSP_CTRL_START) && gState == STATE_PAUSE) {
+        gState = STATE_GAME;
     }
 }
 
 static void handleLevelCompleteInput(void)
 {
-    sceCtrlReadBufferPositive(&gPad, 1);
+    updateInput(&gInput);
 
-    if (gPad.Buttons & PSP_CTRL_CROSS) {
-        if (!gButtonPressed) {
-            gCurrentLevel++;
-            loadLevel(gCurrentLevel);
+    if (gInput.pressed & PSP_CTRL_CROSS) {
+        /* Already built in the background, so this is just the pointer swap */
+        if (loadLevel(gCurrentLevel + 1) == 0) {
             gState = STATE_GAME;
-            gButtonPressed = 1;
         }
-    } else {
-        gButtonPressed = 0;
     }
 }
 
 static void handleWinInput(void)
 {
-    sceCtrlReadBufferPositive(&gPad, 1);
+    updateInput(&gInput);
 
-    if (gPad.Buttons & PSP_CTRL_CROSS) {
-        if (!gButtonPressed) {
-            gState = STATE_MENU;
-            gMenuSelection = 0;
-            Mix_HaltMusic();
-            gButtonPressed = 1;
-        }
-    } else {
-        gButtonPressed = 0;
+    if (gInput.pressed & PSP_CTRL_CROSS) {
+        gState = STATE_MENU;
+        gMenuSelection = 0;
+        playVoice(&gSequencer, MUSIC_VOICE, NULL);
+        prefetchLevel(gFirstLevel);
     }
 }
 
@@ -1055,10 +1166,31 @@ static void handleWinInput(void)
 
 int main(int argc, char **argv)
 {
-    (void)argc;
-    (void)argv;
+    platformInit(argc, argv);
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--texformat=", 12) == 0) {
+            int format = parseTextureFormat(argv[i] + 12);
+            if (format >= 0) gTextureMode = format + 1;
+        } else if (strcmp(argv[i], "--save-audio") == 0) {
+            gSaveAudio = 1;
+        } else if (strncmp(argv[i], "--latency=", 10) == 0) {
+            int profile = parseAudioProfile(argv[i] + 10);
+            if (profile >= 0) gAudioProfile = profile;
+        } else if (strncmp(argv[i], "--level=", 8) == 0) {
+            int level = atoi(argv[i] + 8) - 1;
+            if (level >= 0 && level < 3) gFirstLevel = level;
+        }
+    }
+
+    /* Headless runs start level 1 from the menu, then walk and turn; the taps of X move past level complete */
+    static const AutopilotStep autopilot[] = {
+        {5, 0}, {1, PSP_CTRL_CROSS}, {90, PSP_CTRL_UP}, {12, PSP_CTRL_UP | PSP_CTRL_RIGHT}, {1, PSP_CTRL_CROSS}
+    };
+    platformSetAutopilot(autopilot, (int)(sizeof(autopilot) / sizeof(autopilot[0])), 2);
 
-    sceCtrlSetSamplingCycle(0);
+    initInput(&gInput);
+    initSpatialHash(&gEntityHash);
     sceCtrlSetSamplingMode(PSP_CTRL_MODE_ANALOG);
 
     /* Initialize SDL for audio only */
@@ -1066,10 +1198,11 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) < 0) {
+    if (openAudioMonitor(&gAudio, gAudioProfile, SAMPLE_RATE) < 0) {
         SDL_Quit();
         return 1;
     }
+    initMusic();
 
     /* Initialize GLUT/OpenGL */
     glutInit(&argc, argv);
@@ -1078,32 +1211,51 @@ int main(int argc, char **argv)
     glutCreateWindow("3D Maze");
 
     setupGL();
-    initTextures();
-
-    /* Generate and load audio */
-    generateAudioFiles();
-    gMusic = Mix_LoadMUS("bgmusic.wav");
-    gWinSound = Mix_LoadWAV("win.wav");
-    gSelectSound = Mix_LoadWAV("select.wav");
-    Mix_VolumeMusic(MIX_MAX_VOLUME / 2);
-
-    srand((unsigned int)time(NULL));
-    gState = STATE_MENU;
+    initArena(&gFrameArena, FRAME_ARENA_SIZE);
+    TTF_Init();
+    initBatch(&gBatch, FONT_PATH, FONT_SIZE, SCREEN_WIDTH, SCREEN_HEIGHT);    /* Without the font, numbers fall back to segments */
+
+    /* Textures and sounds are generated off the main thread while the loading screen runs */
+    gSeedBase = replaySeed(platformHeadless() ? 1 : (uint32_t)time(NULL));    /* Headless runs and replays repeat the same levels */
+    startJob(&gAssetJob, "assets", buildAssets, freeAssetData, NULL);
+    gState = STATE_LOADING;
     gLastTime = SDL_GetTicks();
 
+    platformFrameSeconds(PLAYER_TICK_RATE);
+
     /* Main loop */
-    while (gState != STATE_QUIT) {
+    while (gState != STATE_QUIT && platformRunning()) {
+        profilerBeginFrame();
+        resetArena(&gFrameArena);
         updateFPS();
 
+        float elapsed = (float)platformFrameSeconds(PLAYER_TICK_RATE);
+
         switch (gState) {
+            case STATE_LOADING: {
+                AssetData *data = pollJob(&gAssetJob);
+                if (data || !jobPending(&gAssetJob)) {
+                    gAssets = data;
+                    initTextures();
+                    initSounds();
+
+                    gState = STATE_MENU;
+                    prefetchLevel(gFirstLevel);
+                }
+                renderLoading();
+                break;
+            }
             case STATE_MENU:
                 handleMenuInput();
                 renderMenu();
                 break;
             case STATE_GAME:
-                handleGameInput();
-                renderScene();
-                renderHUD();
+                handleGameInput(elapsed);
+                PROFILE_SCOPE("render") renderScene();
+                PROFILE_SCOPE("hud") {
+                    renderHUD();
+                    if (gShowProfiler) renderProfiler();
+                }
                 break;
             case STATE_PAUSE:
                 handlePauseInput();
@@ -1122,12 +1274,38 @@ int main(int argc, char **argv)
                 break;
         }
 
-        glutSwapBuffers();
-        sceDisplayWaitVblankStart();
+        PROFILE_SCOPE("overlay") flushBatch(&gBatch);
+
+        PROFILE_SCOPE("swap") {
+            glutSwapBuffers();
+            sceDisplayWaitVblankStart();
+        }
+        profilerEndFrame();
+    }
+
+    if (platformProfileDumps()) {
+        profilerWriteCsv("profile.csv");
+        profilerWriteTrace("profile.json");
+    }
+    if (platformHeadless()) {
+        profilerPrintSummary(stdout);
+        audioMonitorPrintSummary(&gAudio, stdout);
+        printf("overlay: %.1f draw calls and %.0f vertices per frame, %d primitives dropped\n",
+               gBatch.frames ? (double)gBatch.totalDrawCalls / gBatch.frames : 0.0,
+               gBatch.frames ? (double)gBatch.totalVertices / gBatch.frames : 0.0, gBatch.dropped);
+        if (gLevel) {
+            printf("walls: %d faces merged into %d runs, %d triangles for the window\n",
+                   gLevel->world.window.wallCount, gLevel->world.window.runCount, gLevel->world.window.runCount * 2);
+            arenaPrintSummary(&gLevel->arena, "level", stdout);
+        }
+        arenaPrintSummary(&gFrameArena, "frame", stdout);
+        platformPrintSummary(stdout);
     }
 
     /* Cleanup */
-    if (gMusic) Mix_FreeMusic(gMusic);
+    cancelJob(&gAssetJob);
+    cancelJob(&gLevelJob);
+
     if (gWinSound) Mix_FreeChunk(gWinSound);
     if (gSelectSound) Mix_FreeChunk(gSelectSound);
 
@@ -1135,13 +1313,17 @@ int main(int argc, char **argv)
     glDeleteTextures(1, &gExitTexture);
     glDeleteTextures(1, &gFloorTexture);
     glDeleteTextures(1, &gCeilingTexture);
+    freeBatch(&gBatch);
+    freeAssetData(gAssets);
 
-    if (gWallGrid) free(gWallGrid);
-    if (gWalls) free(gWalls);
+    freeLevel(gLevel);
+    freeArena(&gFrameArena);
 
-    Mix_CloseAudio();
+    closeAudioMonitor(&gAudio);
+    TTF_Quit();
     SDL_Quit();
 
+    stopReplay();
     sceKernelExitGame();
     return 0;
 }
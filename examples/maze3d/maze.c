@@ -0,0 +1,646 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "maze.h"
+
+/* Generation scratch: 2-bit direction back to the cell each maze cell was reached from */
+#define DIR_NORTH 0
+#define DIR_EAST  1
+#define DIR_SOUTH 2
+#define DIR_WEST  3
+
+#define LANE_LOW_BITS 0x5555555555555555ULL
+
+/* ============== Grid Storage ============== */
+
+static void *mazeAlloc(Arena *arena, size_t size)
+{
+    return arena ? arenaAlloc(arena, size) : malloc(size);
+}
+
+static void mazeFree(Arena *arena, void *p)
+{
+    if (!arena) free(p);
+}
+
+static void setCell(Maze *maze, int x, int y, int value)
+{
+    uint32_t *word = &maze->cells[y * maze->wordsPerRow + x / CELLS_PER_WORD];
+    int shift = (x % CELLS_PER_WORD) * CELL_BITS;
+    *word = (*word & ~(3u << shift)) | ((uint32_t)value << shift);
+}
+
+/*
+ * Reads count (at most 32) consecutive cells of row y starting at x into
+ * 2-bit lanes, a whole word at a time. Cells outside the grid read as walls.
+ */
+static uint64_t readRow(const Maze *maze, int x, int y, int count)
+{
+    uint64_t lanes = 0;
+    int x0 = x < 0 ? 0 : x;
+    int x1 = x + count > maze->gridWidth ? maze->gridWidth : x + count;
+
+    if (y < 0 || y >= maze->gridHeight || x0 >= x1) {
+        return (count >= 32 ? ~0ULL : (1ULL << (count * CELL_BITS)) - 1) & LANE_LOW_BITS;
+    }
+
+    const uint32_t *row = &maze->cells[y * maze->wordsPerRow];
+    for (int cx = x0; cx < x1; ) {
+        int shift = cx % CELLS_PER_WORD;
+        int take = CELLS_PER_WORD - shift;
+        if (take > x1 - cx) take = x1 - cx;
+
+        uint64_t part = (uint64_t)(row[cx / CELLS_PER_WORD] >> (shift * CELL_BITS));
+        part &= (1ULL << (take * CELL_BITS)) - 1;
+        lanes |= part << ((cx - x) * CELL_BITS);
+        cx += take;
+    }
+
+    /* Pad the lanes that fell off either edge with walls */
+    for (int i = 0; i < x0 - x; i++) lanes |= (uint64_t)CELL_WALL << (i * CELL_BITS);
+    for (int i = x1 - x; i < count; i++) lanes |= (uint64_t)CELL_WALL << (i * CELL_BITS);
+    return lanes;
+}
+
+uint64_t mazeRowWalls(const Maze *maze, int x, int y, int count)
+{
+    uint64_t lanes = readRow(maze, x, y, count);
+    /* CELL_WALL is the only value with the low bit set and the high bit clear */
+    return lanes & ~(lanes >> 1) & LANE_LOW_BITS;
+}
+
+/* ============== Generation ============== */
+
+static void addWall(Wall *w, int x, int y, int side, int isExit)
+{
+    float fx = (float)x;
+    float fy = (float)y;
+
+    switch (side) {
+        case FACE_NORTH:
+            w->x1 = fx;     w->z1 = fy;
+            w->x2 = fx + 1; w->z2 = fy;
+            break;
+        case FACE_SOUTH:
+            w->x1 = fx + 1; w->z1 = fy + 1;
+            w->x2 = fx;     w->z2 = fy + 1;
+            break;
+        case FACE_WEST:
+            w->x1 = fx;     w->z1 = fy + 1;
+            w->x2 = fx;     w->z2 = fy;
+            break;
+        case FACE_EAST:
+            w->x1 = fx + 1; w->z1 = fy;
+            w->x2 = fx + 1; w->z2 = fy + 1;
+            break;
+    }
+    w->cellX = (uint16_t)x;
+    w->isExit = (uint8_t)isExit;
+    w->side = (uint8_t)side;
+}
+
+/* Emits the exposed faces of row y into out (when not NULL) and returns how many there are */
+static int collectRowFaces(const Maze *maze, int y, Wall *out)
+{
+    int gw = maze->gridWidth;
+    int gh = maze->gridHeight;
+    int count = 0;
+
+    for (int x = 0; x < gw; x++) {
+        int cell = mazeCell(maze, x, y);
+        if (cell == CELL_OPEN) continue;
+
+        /* -1 marks a neighbour beyond the edge of the grid */
+        int sides[4] = {
+            y > 0 ? mazeCell(maze, x, y - 1) : -1,
+            y < gh - 1 ? mazeCell(maze, x, y + 1) : -1,
+            x > 0 ? mazeCell(maze, x - 1, y) : -1,
+            x < gw - 1 ? mazeCell(maze, x + 1, y) : -1
+        };
+
+        for (int side = FACE_NORTH; side <= FACE_EAST; side++) {
+            /* Brick faces toward any non-wall neighbour; exit cell walls are green */
+            int exposed = cell == CELL_WALL ? sides[side] >= 0 && sides[side] != CELL_WALL
+                                            : sides[side] == CELL_WALL;
+            if (exposed) {
+                if (out) addWall(&out[count], x, y, side, cell == CELL_EXIT);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* Grows run by w if w starts where the run ends, along the direction the scan meets its faces */
+static int extendRun(Wall *run, const Wall *w)
+{
+    if (run->isExit != w->isExit) return 0;
+
+    switch (w->side) {
+        case FACE_NORTH:
+            if (run->x2 != w->x1) return 0;
+            run->x2 = w->x2;
+            return 1;
+        case FACE_SOUTH:
+            if (run->x1 != w->x2) return 0;
+            run->x1 = w->x1;
+            return 1;
+        case FACE_WEST:
+            if (run->z1 != w->z2) return 0;
+            run->z1 = w->z1;
+            return 1;
+        default:
+            if (run->z2 != w->z1) return 0;
+            run->z2 = w->z2;
+            return 1;
+    }
+}
+
+/*
+ * Greedy merge in one pass over the scan-ordered faces. North and south
+ * runs grow along a row; west and east runs grow down a column, so each
+ * column keeps its open run of either side while the rows go by.
+ */
+static int mergeWallRuns(Maze *maze)
+{
+    int total = maze->wallCount > 0 ? maze->wallCount : 1;
+    int gw = maze->gridWidth;
+
+    maze->runs = mazeAlloc(maze->arena, total * sizeof(Wall));
+    maze->wallRuns = mazeAlloc(maze->arena, total * sizeof(int));
+    if (!maze->runs || !maze->wallRuns) return -1;
+
+    size_t mark = maze->arena ? arenaMark(maze->arena) : 0;
+    int *columnRuns = mazeAlloc(maze->arena, gw * 2 * sizeof(int));
+    if (!columnRuns) return -1;
+    for (int i = 0; i < gw * 2; i++) columnRuns[i] = -1;
+
+    int count = 0;
+    for (int y = 0; y < maze->gridHeight; y++) {
+        int rowRuns[2] = {-1, -1};
+
+        for (int i = maze->rowFaces[y]; i < maze->rowFaces[y + 1]; i++) {
+            const Wall *w = &maze->walls[i];
+            int *open = w->side <= FACE_SOUTH ? &rowRuns[w->side]
+                                              : &columnRuns[w->cellX * 2 + w->side - FACE_WEST];
+
+            if (*open < 0 || !extendRun(&maze->runs[*open], w)) {
+                *open = count;
+                maze->runs[count++] = *w;
+            }
+            maze->wallRuns[i] = *open;
+        }
+    }
+    maze->runCount = count;
+
+    mazeFree(maze->arena, columnRuns);
+    if (maze->arena) rewindArena(maze->arena, mark);
+    return 0;
+}
+
+int buildMazeWalls(Maze *maze)
+{
+    int gh = maze->gridHeight;
+
+    if (maze->arena) {
+        rewindArena(maze->arena, maze->arenaMark);
+    } else {
+        if (maze->walls) free(maze->walls);
+        if (maze->rowFaces) free(maze->rowFaces);
+        if (maze->runs) free(maze->runs);
+        if (maze->wallRuns) free(maze->wallRuns);
+    }
+    maze->walls = NULL;
+    maze->rowFaces = NULL;
+    maze->runs = NULL;
+    maze->wallRuns = NULL;
+    maze->wallCount = 0;
+    maze->runCount = 0;
+
+    /* Count first so the list is allocated at its exact size */
+    maze->rowFaces = mazeAlloc(maze->arena, (gh + 1) * sizeof(int));
+    if (!maze->rowFaces) return -1;
+
+    int total = 0;
+    for (int y = 0; y < gh; y++) {
+        maze->rowFaces[y] = total;
+        total += collectRowFaces(maze, y, NULL);
+    }
+    maze->rowFaces[gh] = total;
+
+    maze->walls = mazeAlloc(maze->arena, (total > 0 ? total : 1) * sizeof(Wall));
+    if (!maze->walls) return -1;
+
+    for (int y = 0; y < gh; y++) {
+        collectRowFaces(maze, y, &maze->walls[maze->rowFaces[y]]);
+    }
+    maze->wallCount = total;
+    return mergeWallRuns(maze);
+}
+
+int generateMazeGrid(Maze *maze, int width, int height, uint32_t seed)
+{
+    Arena *arena = maze->arena;
+    freeMaze(maze);
+    maze->arena = arena;
+    maze->gridWidth = width * 2 + 1;
+    maze->gridHeight = height * 2 + 1;
+    maze->wordsPerRow = (maze->gridWidth + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+
+    /* Visited cells are the ones already carved open, so only the way back needs storing */
+    int total = width * height;
+    maze->cells = mazeAlloc(arena, maze->wordsPerRow * maze->gridHeight * sizeof(uint32_t));
+    maze->arenaMark = arena ? arenaMark(arena) : 0;
+    unsigned char *parents = mazeAlloc(arena, (total + 3) / 4);
+    if (!parents || !maze->cells) {
+        if (parents) mazeFree(arena, parents);
+        freeMaze(maze);
+        maze->arena = arena;
+        return -1;
+    }
+
+    /* Every lane starts as CELL_WALL */
+    for (int i = 0; i < maze->wordsPerRow * maze->gridHeight; i++) {
+        maze->cells[i] = 0x55555555u;
+    }
+
+    uint32_t random = seed ? seed : 0x9E3779B9u;  /* xorshift never leaves zero */
+    int cx = 0, cy = 0;
+    setCell(maze, 1, 1, CELL_OPEN);
+
+    int visited = 1;
+
+    while (visited < total) {
+        int dirs[4];
+        int count = 0;
+        int gx = cx * 2 + 1;
+        int gy = cy * 2 + 1;
+
+        if (cy > 0 && mazeCell(maze, gx, gy - 2) == CELL_WALL) dirs[count++] = DIR_NORTH;
+        if (cx < width - 1 && mazeCell(maze, gx + 2, gy) == CELL_WALL) dirs[count++] = DIR_EAST;
+        if (cy < height - 1 && mazeCell(maze, gx, gy + 2) == CELL_WALL) dirs[count++] = DIR_SOUTH;
+        if (cx > 0 && mazeCell(maze, gx - 2, gy) == CELL_WALL) dirs[count++] = DIR_WEST;
+
+        if (count > 0) {
+            static const int stepX[4] = {0, 1, 0, -1};
+            static const int stepY[4] = {-1, 0, 1, 0};
+            int dir = dirs[mazeRandom(&random) % count];
+
+            /* Knock through to the neighbour and remember the way back */
+            setCell(maze, gx + stepX[dir], gy + stepY[dir], CELL_OPEN);
+            cx += stepX[dir];
+            cy += stepY[dir];
+            setCell(maze, cx * 2 + 1, cy * 2 + 1, CELL_OPEN);
+
+            int index = cy * width + cx;
+            int shift = (index % 4) * 2;
+            parents[index / 4] = (unsigned char)((parents[index / 4] & ~(3 << shift)) | (((dir + 2) & 3) << shift));
+            visited++;
+        } else {
+            int index = cy * width + cx;
+            int back = (parents[index / 4] >> ((index % 4) * 2)) & 3;
+            cx += back == DIR_EAST ? 1 : back == DIR_WEST ? -1 : 0;
+            cy += back == DIR_SOUTH ? 1 : back == DIR_NORTH ? -1 : 0;
+        }
+    }
+
+    mazeFree(arena, parents);
+    if (arena) rewindArena(arena, maze->arenaMark);
+
+    /* Mark exit cell */
+    setCell(maze, (width - 1) * 2 + 1, (height - 1) * 2 + 1, CELL_EXIT);
+    return 0;
+}
+
+int generateMaze(Maze *maze, int width, int height, uint32_t seed)
+{
+    if (generateMazeGrid(maze, width, height, seed) < 0) return -1;
+    if (buildMazeWalls(maze) < 0) {
+        freeMaze(maze);
+        return -1;
+    }
+    return 0;
+}
+
+void freeMaze(Maze *maze)
+{
+    if (!maze->arena) {
+        if (maze->cells) free(maze->cells);
+        if (maze->walls) free(maze->walls);
+        if (maze->rowFaces) free(maze->rowFaces);
+        if (maze->runs) free(maze->runs);
+        if (maze->wallRuns) free(maze->wallRuns);
+    }
+    memset(maze, 0, sizeof(*maze));
+}
+
+/* ============== Collision Detection ============== */
+
+int mazeIsWall(const Maze *maze, int x, int y)
+{
+    if (x < 0 || x >= maze->gridWidth || y < 0 || y >= maze->gridHeight) return 1;
+    return mazeCell(maze, x, y) == CELL_WALL;
+}
+
+int mazeIsExit(const Maze *maze, int x, int y)
+{
+    if (x < 0 || x >= maze->gridWidth || y < 0 || y >= maze->gridHeight) return 0;
+    return mazeCell(maze, x, y) == CELL_EXIT;
+}
+
+int mazeCheckCollision(const Maze *maze, float x, float y, float radius)
+{
+    int minX = (int)(x - radius);
+    int maxX = (int)(x + radius);
+    int minY = (int)(y - radius);
+    int maxY = (int)(y + radius);
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int spanX = minX; spanX <= maxX; spanX += 32) {
+            int count = maxX - spanX + 1;
+            if (count > 32) count = 32;
+
+            /* Whole rows of open cells are skipped without touching a single cell */
+            uint64_t walls = mazeRowWalls(maze, spanX, cy, count);
+            while (walls) {
+                int cx = spanX + __builtin_ctzll(walls) / CELL_BITS;
+                walls &= walls - 1;
+
+                float closestX = fmaxf((float)cx, fminf(x, (float)(cx + 1)));
+                float closestY = fmaxf((float)cy, fminf(y, (float)(cy + 1)));
+                float dx = x - closestX;
+                float dy = y - closestY;
+                if (dx * dx + dy * dy < radius * radius) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * When the circle at (x, y) moving by (dx, dy) first touches cell (cx, cy),
+ * as a fraction of the move, or 2 if it does not. The circle against the
+ * cell is the ray from its centre against the cell grown by radius, whose
+ * corners are quarter circles.
+ */
+static float sweepCell(float x, float y, float dx, float dy, float radius, int cx, int cy)
+{
+    /* Already touching: only a move further in is blocked, so a circle resting on a wall can slide off it */
+    float closestX = fmaxf((float)cx, fminf(x, (float)(cx + 1)));
+    float closestY = fmaxf((float)cy, fminf(y, (float)(cy + 1)));
+    float nx = x - closestX;
+    float ny = y - closestY;
+    if (nx * nx + ny * ny <= radius * radius) {
+        return nx * dx + ny * dy < 0 ? 0.0f : 2.0f;
+    }
+
+    /* Slabs of the grown square */
+    float enter = 0.0f, leave = 1.0f;
+    float lo[2] = {cx - radius, cy - radius};
+    float hi[2] = {cx + 1 + radius, cy + 1 + radius};
+    float from[2] = {x, y};
+    float move[2] = {dx, dy};
+    for (int axis = 0; axis < 2; axis++) {
+        if (move[axis] == 0) {
+            if (from[axis] < lo[axis] || from[axis] > hi[axis]) return 2.0f;
+            continue;
+        }
+        float t1 = (lo[axis] - from[axis]) / move[axis];
+        float t2 = (hi[axis] - from[axis]) / move[axis];
+        if (t1 > t2) {
+            float swap = t1;
+            t1 = t2;
+            t2 = swap;
+        }
+        enter = fmaxf(enter, t1);
+        leave = fminf(leave, t2);
+        if (enter > leave) return 2.0f;
+    }
+
+    /* Entering beside a corner rather than along an edge: test the corner's circle instead */
+    float px = x + dx * enter;
+    float py = y + dy * enter;
+    if ((px >= cx && px <= cx + 1) || (py >= cy && py <= cy + 1)) return enter;
+
+    float ox = x - (px < cx ? cx : cx + 1);
+    float oy = y - (py < cy ? cy : cy + 1);
+    float a = dx * dx + dy * dy;
+    float b = ox * dx + oy * dy;
+    float c = ox * ox + oy * oy - radius * radius;
+    float disc = b * b - a * c;
+    if (b >= 0 || disc < 0) return 2.0f;
+
+    float t = (-b - sqrtf(disc)) / a;
+    return t <= 1.0f ? t : 2.0f;
+}
+
+int mazeSweepCircle(const Maze *maze, float x, float y, float dx, float dy, float radius, float *t)
+{
+    int minX = (int)floorf(fminf(x, x + dx) - radius);
+    int maxX = (int)floorf(fmaxf(x, x + dx) + radius);
+    int minY = (int)floorf(fminf(y, y + dy) - radius);
+    int maxY = (int)floorf(fmaxf(y, y + dy) + radius);
+    float first = 2.0f;
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int spanX = minX; spanX <= maxX; spanX += 32) {
+            int count = maxX - spanX + 1;
+            if (count > 32) count = 32;
+
+            /* As in mazeCheckCollision, only wall cells in the swept box are visited */
+            uint64_t walls = mazeRowWalls(maze, spanX, cy, count);
+            while (walls) {
+                int cx = spanX + __builtin_ctzll(walls) / CELL_BITS;
+                walls &= walls - 1;
+                first = fminf(first, sweepCell(x, y, dx, dy, radius, cx, cy));
+            }
+        }
+    }
+
+    *t = first <= 1.0f ? first : 1.0f;
+    return first <= 1.0f;
+}
+
+/* ============== Visibility ============== */
+
+int initVisibility(Visibility *vis, const Maze *maze)
+{
+    int capacity = maze->wallCount > 0 ? maze->wallCount : 1;
+
+    vis->count = 0;
+    vis->arena = maze->arena;
+    vis->walls = mazeAlloc(vis->arena, capacity * sizeof(int));
+    vis->marked = vis->arena ? arenaCalloc(vis->arena, capacity, 1) : calloc(capacity, 1);
+    if (!vis->walls || !vis->marked) {
+        freeVisibility(vis);
+        return -1;
+    }
+    return 0;
+}
+
+void freeVisibility(Visibility *vis)
+{
+    if (vis->walls) mazeFree(vis->arena, vis->walls);
+    if (vis->marked) mazeFree(vis->arena, vis->marked);
+    vis->walls = NULL;
+    vis->marked = NULL;
+    vis->count = 0;
+}
+
+static void markFace(Visibility *vis, const Maze *maze, int x, int y, int side)
+{
+    /* Faces within a row are sorted by cell, so binary search for the first one of x */
+    int lo = maze->rowFaces[y];
+    int hi = maze->rowFaces[y + 1];
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (maze->walls[mid].cellX < x) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (int i = lo; i < maze->rowFaces[y + 1] && maze->walls[i].cellX == x; i++) {
+        if (maze->walls[i].side == side) {
+            if (!vis->marked[i]) {
+                vis->marked[i] = 1;
+                vis->walls[vis->count++] = i;
+            }
+            return;
+        }
+    }
+}
+
+#define VISIBILITY_REFINE_DEPTH 6
+
+static const int gOppositeSide[4] = {FACE_SOUTH, FACE_NORTH, FACE_EAST, FACE_WEST};
+
+/* Returns (cell index * 4 + face side) for the wall the ray stopped at, or -1 if it ran out of range */
+static int castRay(Visibility *vis, const Maze *maze, float px, float py,
+                   float dirX, float dirY, float range)
+{
+    int gw = maze->gridWidth;
+    int mapX = (int)px;
+    int mapY = (int)py;
+
+    float deltaX = dirX == 0 ? 1e30f : fabsf(1.0f / dirX);
+    float deltaY = dirY == 0 ? 1e30f : fabsf(1.0f / dirY);
+    int stepX, stepY;
+    float sideX, sideY;
+
+    if (dirX < 0) {
+        stepX = -1;
+        sideX = (px - mapX) * deltaX;
+    } else {
+        stepX = 1;
+        sideX = (mapX + 1.0f - px) * deltaX;
+    }
+    if (dirY < 0) {
+        stepY = -1;
+        sideY = (py - mapY) * deltaY;
+    } else {
+        stepY = 1;
+        sideY = (mapY + 1.0f - py) * deltaY;
+    }
+
+    for (;;) {
+        int prevX = mapX;
+        int prevY = mapY;
+        int side;
+        float dist;
+
+        if (sideX < sideY) {
+            dist = sideX;
+            sideX += deltaX;
+            mapX += stepX;
+            side = stepX > 0 ? FACE_WEST : FACE_EAST;
+        } else {
+            dist = sideY;
+            sideY += deltaY;
+            mapY += stepY;
+            side = stepY > 0 ? FACE_NORTH : FACE_SOUTH;
+        }
+
+        if (dist > range) return -1;
+        if (mapX < 0 || mapX >= gw || mapY < 0 || mapY >= maze->gridHeight) return -1;
+
+        if (mazeCell(maze, mapX, mapY) == CELL_WALL) {
+            markFace(vis, maze, mapX, mapY, side);
+            /* Exit faces sit on top of the brick face they are drawn against */
+            if (mazeCell(maze, prevX, prevY) == CELL_EXIT) {
+                markFace(vis, maze, prevX, prevY, gOppositeSide[side]);
+            }
+            return (mapY * gw + mapX) * 4 + side;
+        }
+    }
+}
+
+typedef struct {
+    float x, y;
+    float angle;
+    float range;
+} RayFan;
+
+static int castFanRay(Visibility *vis, const Maze *maze, const RayFan *fan, float offset)
+{
+    float a = fan->angle + offset;
+    /* Fog depth is measured along the view axis, so off-axis rays reach further */
+    return castRay(vis, maze, fan->x, fan->y, cosf(a), sinf(a), fan->range / cosf(offset));
+}
+
+/*
+ * Two rays cannot have skipped a face between them if they stopped on the same
+ * wall cell, or on the same side of two edge-adjacent cells.
+ */
+static int hitsAdjacent(const Maze *maze, int a, int b)
+{
+    if (a == b) return 1;
+    if (a < 0 || b < 0) return 0;
+
+    int cellA = a / 4;
+    int cellB = b / 4;
+    if (cellA == cellB) return 1;
+    if (a % 4 != b % 4) return 0;
+
+    int dx = abs(cellA % maze->gridWidth - cellB % maze->gridWidth);
+    int dy = abs(cellA / maze->gridWidth - cellB / maze->gridWidth);
+    return dx + dy <= 1;
+}
+
+/* Bisect between neighbouring rays until their hits touch, catching faces seen at grazing angles */
+static void refineFan(Visibility *vis, const Maze *maze, const RayFan *fan,
+                      float offset0, int hit0, float offset1, int hit1, int depth)
+{
+    if (depth == 0 || hitsAdjacent(maze, hit0, hit1)) return;
+
+    float mid = (offset0 + offset1) * 0.5f;
+    int hitMid = castFanRay(vis, maze, fan, mid);
+    refineFan(vis, maze, fan, offset0, hit0, mid, hitMid, depth - 1);
+    refineFan(vis, maze, fan, mid, hitMid, offset1, hit1, depth - 1);
+}
+
+void computeVisibility(Visibility *vis, const Maze *maze, float x, float y,
+                       float angle, float fov, float range, int rayCount)
+{
+    /* Clear only what the previous pass marked */
+    for (int i = 0; i < vis->count; i++) {
+        vis->marked[vis->walls[i]] = 0;
+    }
+    vis->count = 0;
+
+    if (rayCount < 2) rayCount = 2;
+    float step = fov / (float)(rayCount - 1);
+    RayFan fan = {x, y, angle, range};
+
+    float prevOffset = -fov * 0.5f;
+    int prevHit = castFanRay(vis, maze, &fan, prevOffset);
+
+    for (int i = 1; i < rayCount; i++) {
+        float offset = -fov * 0.5f + step * i;
+        int hit = castFanRay(vis, maze, &fan, offset);
+        refineFan(vis, maze, &fan, prevOffset, prevHit, offset, hit, VISIBILITY_REFINE_DEPTH);
+        prevOffset = offset;
+        prevHit = hit;
+    }
+}
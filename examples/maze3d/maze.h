@@ -0,0 +1,138 @@
+/**
+ * Maze generation, collision and visibility for the 3D maze
+ *
+ * Pure C with no GL or PSP dependencies so it can also be built into the
+ * host-side benchmarks in examples/bench.
+ */
+
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+/* Grid cell values, stored 2 bits per cell */
+#define CELL_OPEN 0
+#define CELL_WALL 1
+#define CELL_EXIT 2
+
+#define CELL_BITS 2
+#define CELLS_PER_WORD 16
+
+/* Which side of its grid cell a wall face lies on */
+typedef enum {
+    FACE_NORTH,
+    FACE_SOUTH,
+    FACE_WEST,
+    FACE_EAST
+} FaceSide;
+
+/* Wall vertex for rendering */
+typedef struct {
+    float x1, z1, x2, z2;
+    uint16_t cellX;     /* Grid column of the cell the face belongs to */
+    uint8_t isExit;
+    uint8_t side;
+} Wall;
+
+typedef struct {
+    /* 16 cells per word, each row padded to a whole number of words */
+    uint32_t *cells;
+    int wordsPerRow;
+    int gridWidth;
+    int gridHeight;
+
+    /* Exposed faces in grid scan order: row y owns walls[rowFaces[y] .. rowFaces[y + 1]) */
+    Wall *walls;
+    int wallCount;
+    int *rowFaces;
+
+    /*
+     * The same faces merged into maximal straight runs of one side and kind,
+     * for meshing: a run is a Wall whose ends are whole units apart, and
+     * wallRuns[i] is the run walls[i] belongs to.
+     */
+    Wall *runs;
+    int runCount;
+    int *wallRuns;
+
+    /* Set before generating to take the storage from an arena instead of the heap */
+    Arena *arena;
+    size_t arenaMark;       /* Arena offset just after the cells */
+} Maze;
+
+/* Set of walls that can be seen from a viewpoint */
+typedef struct {
+    int *walls;             /* Indices into Maze.walls */
+    int count;
+    unsigned char *marked;  /* Per wall, cleared again after every pass */
+    Arena *arena;           /* The maze's, if it had one */
+} Visibility;
+
+/* xorshift32: the same seed rebuilds the same maze on every platform, unlike rand() */
+static inline uint32_t mazeRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*
+ * Builds a perfect maze of width x height cells from seed, plus its wall
+ * list. Returns 0 on success. generateMazeGrid builds only the cell grid.
+ *
+ * With maze->arena set, buildMazeWalls rewinds the arena to arenaMark
+ * before allocating the new list. Anything the caller took from the arena
+ * after the walls (meshes, a Visibility) goes with them, so rebuilding the
+ * walls any number of times never uses more of the arena than one build.
+ * freeMaze then only forgets the storage; the arena's owner resets it.
+ */
+int generateMaze(Maze *maze, int width, int height, uint32_t seed);
+int generateMazeGrid(Maze *maze, int width, int height, uint32_t seed);
+int buildMazeWalls(Maze *maze);
+void freeMaze(Maze *maze);
+
+/* Cell value at (x, y); the caller guarantees the coordinates are inside the grid */
+static inline int mazeCell(const Maze *maze, int x, int y)
+{
+    uint32_t word = maze->cells[y * maze->wordsPerRow + x / CELLS_PER_WORD];
+    return (word >> ((x % CELLS_PER_WORD) * CELL_BITS)) & 3;
+}
+
+/*
+ * Word-at-a-time row query: bit 2*i of the result is set when cell (x + i, y)
+ * is a wall, for count cells up to 32. Cells outside the grid count as walls.
+ */
+uint64_t mazeRowWalls(const Maze *maze, int x, int y, int count);
+
+int mazeIsWall(const Maze *maze, int x, int y);
+int mazeIsExit(const Maze *maze, int x, int y);
+int mazeCheckCollision(const Maze *maze, float x, float y, float radius);
+
+/*
+ * Swept circle: moves the circle at (x, y) by (dx, dy) through the grid.
+ * Returns 1 with *t the fraction of the move made before it first touches
+ * a wall cell, or 0 with *t = 1 if the whole move is clear. A circle already
+ * touching a wall is only stopped if it moves further into it.
+ */
+int mazeSweepCircle(const Maze *maze, float x, float y, float dx, float dy, float radius, float *t);
+
+int initVisibility(Visibility *vis, const Maze *maze);
+void freeVisibility(Visibility *vis);
+
+/*
+ * Collects the walls visible from (x, y) looking along angle. Casts rayCount
+ * DDA rays spread over fov radians through the grid; each ray stops at the
+ * first wall cell, marking the face it hit, or once it is more than range
+ * units deep along the view axis. Neighbouring rays whose hits do not touch
+ * are bisected so faces seen at grazing angles are not skipped.
+ * fov must stay below pi.
+ */
+void computeVisibility(Visibility *vis, const Maze *maze, float x, float y,
+                       float angle, float fov, float range, int rayCount);
+
+#endif
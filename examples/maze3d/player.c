@@ -0,0 +1,43 @@
+#include <math.h>
+
+#include "player.h"
+
+#define TWO_PI 6.28318530718f
+
+void stepPlayer(Player *player, const World *world, const PlayerInput *input)
+{
+    player->angle += input->turn * ROT_SPEED;
+    while (player->angle < 0) player->angle += TWO_PI;
+    while (player->angle >= TWO_PI) player->angle -= TWO_PI;
+
+    float c = cosf(player->angle);
+    float s = sinf(player->angle);
+    /* Strafing right is a quarter turn clockwise from the view direction */
+    float dx = (c * input->forward - s * input->strafe) * MOVE_SPEED;
+    float dy = (s * input->forward + c * input->strafe) * MOVE_SPEED;
+
+    /* Up to the first wall in the way, then what is left of the move along each axis, so the player slides */
+    float t;
+    worldSweepCircle(world, player->x, player->y, dx, dy, PLAYER_RADIUS, &t);
+    player->x += dx * t;
+    player->y += dy * t;
+    if (t < 1) {
+        float restX = dx * (1 - t);
+        float restY = dy * (1 - t);
+        worldSweepCircle(world, player->x, player->y, restX, 0, PLAYER_RADIUS, &t);
+        player->x += restX * t;
+        worldSweepCircle(world, player->x, player->y, 0, restY, PLAYER_RADIUS, &t);
+        player->y += restY * t;
+    }
+}
+
+void lerpPlayer(Player *out, const Player *from, const Player *to, float t)
+{
+    float turn = to->angle - from->angle;
+    if (turn > TWO_PI * 0.5f) turn -= TWO_PI;
+    if (turn < -TWO_PI * 0.5f) turn += TWO_PI;
+
+    out->x = from->x + (to->x - from->x) * t;
+    out->y = from->y + (to->y - from->y) * t;
+    out->angle = from->angle + turn * t;
+}
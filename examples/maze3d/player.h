@@ -0,0 +1,37 @@
+/**
+ * Player movement for the 3D maze
+ *
+ * One call to stepPlayer is one fixed simulation tick, so the speeds below
+ * are per tick rather than per rendered frame. Pure C like maze.c so the
+ * host benchmarks can replay it.
+ */
+
+#ifndef PLAYER_H
+#define PLAYER_H
+
+#include "world.h"
+
+#define PLAYER_TICK_RATE 60
+#define PLAYER_RADIUS 0.25f
+#define MOVE_SPEED 0.08f
+#define ROT_SPEED 0.04f
+
+typedef struct {
+    float x, y;
+    float angle;
+} Player;
+
+/* Controls sampled for one tick, each in -1..1 */
+typedef struct {
+    float forward;
+    float strafe;   /* Positive is to the right */
+    float turn;     /* Positive is clockwise */
+} PlayerInput;
+
+/* Turns, then sweeps the player's circle through the world, sliding along the walls it meets */
+void stepPlayer(Player *player, const World *world, const PlayerInput *input);
+
+/* Blends two ticks for rendering, taking the short way round for the angle */
+void lerpPlayer(Player *out, const Player *from, const Player *to, float t);
+
+#endif
@@ -0,0 +1,113 @@
+#include <math.h>
+#include <string.h>
+
+#include "spatial.h"
+
+static unsigned int bucketOf(int cx, int cy)
+{
+    /* Large odd multipliers spread neighbouring cells over the table */
+    return ((unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u) & (SPATIAL_BUCKETS - 1);
+}
+
+static void cellRange(float x, float y, float radius, int *minX, int *minY, int *maxX, int *maxY)
+{
+    *minX = (int)floorf(x - radius);
+    *minY = (int)floorf(y - radius);
+    *maxX = (int)floorf(x + radius);
+    *maxY = (int)floorf(y + radius);
+}
+
+void initSpatialHash(SpatialHash *hash)
+{
+    memset(hash, 0, sizeof(*hash));
+}
+
+void buildSpatialHash(SpatialHash *hash, const SpatialEntity *entities, int count)
+{
+    int fill[SPATIAL_BUCKETS];
+    int minX, minY, maxX, maxY;
+
+    hash->dropped = 0;
+    if (count > SPATIAL_MAX_ENTITIES) {
+        hash->dropped = count - SPATIAL_MAX_ENTITIES;
+        count = SPATIAL_MAX_ENTITIES;
+    }
+    hash->entities = entities;
+    hash->entityCount = count;
+
+    /* Count per bucket, then lay the buckets out back to back */
+    memset(fill, 0, sizeof(fill));
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        const SpatialEntity *e = &entities[i];
+        cellRange(e->x, e->y, e->radius, &minX, &minY, &maxX, &maxY);
+        for (int cy = minY; cy <= maxY; cy++) {
+            for (int cx = minX; cx <= maxX; cx++) {
+                if (total == SPATIAL_MAX_ENTRIES) continue;
+                fill[bucketOf(cx, cy)]++;
+                total++;
+            }
+        }
+    }
+
+    int start = 0;
+    for (int b = 0; b < SPATIAL_BUCKETS; b++) {
+        hash->bucketStart[b] = start;
+        start += fill[b];
+        fill[b] = hash->bucketStart[b];
+    }
+    hash->bucketStart[SPATIAL_BUCKETS] = start;
+    hash->entryCount = start;
+
+    /* Same walk again, placing each entry; whatever the count stopped short of is dropped here too */
+    int placed = 0;
+    for (int i = 0; i < count; i++) {
+        const SpatialEntity *e = &entities[i];
+        cellRange(e->x, e->y, e->radius, &minX, &minY, &maxX, &maxY);
+        for (int cy = minY; cy <= maxY; cy++) {
+            for (int cx = minX; cx <= maxX; cx++) {
+                if (placed == SPATIAL_MAX_ENTRIES) {
+                    hash->dropped++;
+                    continue;
+                }
+                hash->entries[fill[bucketOf(cx, cy)]++] = i;
+                placed++;
+            }
+        }
+    }
+}
+
+int querySpatialHash(SpatialHash *hash, float x, float y, float radius, int ignore, int *results, int maxResults)
+{
+    int minX, minY, maxX, maxY;
+    int found = 0;
+
+    /* A fresh stamp forgets the last query's marks without clearing them */
+    if (++hash->queryStamp == 0) {
+        memset(hash->seen, 0, sizeof(hash->seen));
+        hash->queryStamp = 1;
+    }
+
+    cellRange(x, y, radius, &minX, &minY, &maxX, &maxY);
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            unsigned int b = bucketOf(cx, cy);
+
+            for (int k = hash->bucketStart[b]; k < hash->bucketStart[b + 1]; k++) {
+                int i = hash->entries[k];
+                if (i == ignore || hash->seen[i] == hash->queryStamp) continue;
+                hash->seen[i] = hash->queryStamp;
+
+                const SpatialEntity *e = &hash->entities[i];
+                float dx = e->x - x;
+                float dy = e->y - y;
+                float reach = e->radius + radius;
+                if (dx * dx + dy * dy >= reach * reach) continue;
+
+                if (found == maxResults) return found;
+                results[found++] = i;
+            }
+        }
+    }
+    return found;
+}
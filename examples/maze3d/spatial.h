@@ -0,0 +1,62 @@
+/**
+ * Broad phase for moving entities in the maze
+ *
+ * A uniform grid over maze cells, one hash cell per grid cell, stored as a
+ * spatial hash so the same fixed arrays serve a 5x5 level and a 1000x1000
+ * world. The hash is rebuilt from scratch every tick with a counting sort:
+ * no allocation, no linked lists, and each bucket's entities sit next to
+ * each other in memory, which matters more on the PSP's small cache than
+ * the cost of the rebuild.
+ *
+ * An entity is entered in every cell its bounding square touches, four at
+ * most while its radius stays within SPATIAL_MAX_RADIUS. Queries test the
+ * real circles, so buckets shared by far-apart cells only cost time.
+ * Walls are not in the hash; moves are checked against the grid itself
+ * with worldSweepCircle.
+ *
+ * Pure C like maze.c so the host benchmarks can run it.
+ */
+
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#define SPATIAL_BUCKETS 1024            /* Power of two */
+#define SPATIAL_MAX_ENTITIES 1024
+#define SPATIAL_MAX_RADIUS 0.5f         /* Larger entities still work but may not all fit */
+#define SPATIAL_MAX_ENTRIES (SPATIAL_MAX_ENTITIES * 4)
+
+typedef struct {
+    float x, y;
+    float radius;
+} SpatialEntity;
+
+typedef struct {
+    const SpatialEntity *entities;  /* The caller's array, as of the last build */
+    int entityCount;
+
+    int bucketStart[SPATIAL_BUCKETS + 1];   /* Bucket b holds entries[bucketStart[b] .. bucketStart[b + 1]) */
+    int entries[SPATIAL_MAX_ENTRIES];       /* Entity indices, grouped by bucket */
+    int entryCount;
+    int dropped;                            /* Entities or entries that did not fit in the last build */
+
+    /* Marks entities already reported by the current query */
+    unsigned int seen[SPATIAL_MAX_ENTITIES];
+    unsigned int queryStamp;
+} SpatialHash;
+
+void initSpatialHash(SpatialHash *hash);
+
+/*
+ * Rebuilds the hash from count entities. The array is read again by every
+ * query, so it must not move or change until the next build.
+ */
+void buildSpatialHash(SpatialHash *hash, const SpatialEntity *entities, int count);
+
+/*
+ * Writes to results the indices of the entities whose circles overlap the
+ * circle at (x, y), skipping ignore (pass -1 to keep all), in no particular
+ * order. Returns how many were written, at most maxResults.
+ */
+int querySpatialHash(SpatialHash *hash, float x, float y, float radius, int ignore, int *results, int maxResults);
+
+#endif
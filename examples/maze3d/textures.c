@@ -0,0 +1,658 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "maze.h"
+#include "textures.h"
+
+static const char *kindNames[TEXTURE_KIND_COUNT] = {"brick", "exit", "floor", "ceiling"};
+
+static unsigned int greyTexel(int c)
+{
+    return 0xFF000000u | ((unsigned int)c << 16) | ((unsigned int)c << 8) | (unsigned int)c;
+}
+
+/* Signed noise in [-range / 2, range / 2) */
+static int variation(uint32_t *state, int range)
+{
+    return (int)(mazeRandom(state) % (uint32_t)range) - range / 2;
+}
+
+/* ============== Generators ============== */
+
+/* Pattern sizes are fractions of the texture so a bigger one only adds detail */
+static void generateBrick(unsigned int *data, int size, uint32_t *state)
+{
+    int brickH = size / 4;
+    int brickW = size / 2;
+    int mortar = size >= 32 ? size / 32 : 1;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int row = y / brickH;
+            int offset = (row % 2) * (brickW / 2);
+
+            int isMortarH = (y % brickH) < mortar;
+            int isMortarV = ((x + offset) % brickW) < mortar && !isMortarH;
+
+            if (isMortarH || isMortarV) {
+                data[y * size + x] = 0xFF505050;
+            } else {
+                int v = variation(state, 40);
+                unsigned char r = (unsigned char)(140 + v);
+                unsigned char g = (unsigned char)(70 + v / 2);
+                unsigned char b = (unsigned char)(40 + v / 3);
+                data[y * size + x] = 0xFF000000 | (b << 16) | (g << 8) | r;
+            }
+        }
+    }
+}
+
+static void generateExit(unsigned int *data, int size)
+{
+    int cell = size >= 8 ? size / 8 : 1;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int checker = ((x / cell) + (y / cell)) % 2;
+            data[y * size + x] = checker ? 0xFF00FF00 : 0xFF008800;
+        }
+    }
+}
+
+static void generateFloor(unsigned int *data, int size, uint32_t *state)
+{
+    int cell = size >= 4 ? size / 4 : 1;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int checker = ((x / cell) + (y / cell)) % 2;
+            int base = checker ? 60 : 50;
+            data[y * size + x] = greyTexel(base + variation(state, 20));
+        }
+    }
+}
+
+static void generateCeiling(unsigned int *data, int size, uint32_t *state)
+{
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int c = 40 + variation(state, 15);
+            data[y * size + x] = 0xFF000000 | ((c + 20) << 16) | (c << 8) | c;
+        }
+    }
+}
+
+/* ============== Mip Chain ============== */
+
+/* Each texel of the level below is the rounded average of a 2x2 block */
+static void downsample(const unsigned int *src, unsigned int *dst, int size)
+{
+    int half = size / 2;
+
+    for (int y = 0; y < half; y++) {
+        const unsigned int *row0 = src + (y * 2) * size;
+        const unsigned int *row1 = row0 + size;
+        for (int x = 0; x < half; x++) {
+            unsigned int a = row0[x * 2], b = row0[x * 2 + 1];
+            unsigned int c = row1[x * 2], d = row1[x * 2 + 1];
+            unsigned int out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                unsigned int sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                                   ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+                out |= ((sum + 2) / 4) << shift;
+            }
+            dst[y * half + x] = out;
+        }
+    }
+}
+
+static int fullChain(int size)
+{
+    int levels = 1;
+    while (size > 1) {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
+
+static int validParams(const TextureParams *params)
+{
+    int size = params->size;
+    return params->kind >= 0 && params->kind < TEXTURE_KIND_COUNT &&
+           size >= 1 && size <= TEXTURE_MAX_SIZE && (size & (size - 1)) == 0 && params->levels >= 1;
+}
+
+static int clampLevels(const TextureParams *params)
+{
+    int full = fullChain(params->size);
+    return params->levels < full ? params->levels : full;
+}
+
+static size_t texelCount(int size, int levels)
+{
+    size_t count = 0;
+    for (int i = 0; i < levels; i++, size /= 2) count += (size_t)size * size;
+    return count;
+}
+
+/* ============== Generation and Cache ============== */
+
+int generateTexture(const TextureParams *params, TextureImage *image)
+{
+    memset(image, 0, sizeof(*image));
+    if (!validParams(params)) return -1;
+
+    image->size = params->size;
+    image->levels = clampLevels(params);
+    image->pixels = malloc(texelCount(image->size, image->levels) * sizeof(unsigned int));
+    if (!image->pixels) return -1;
+
+    uint32_t state = params->seed ? params->seed : 0x9E3779B9u;   /* xorshift never leaves zero */
+    unsigned int *base = image->pixels;
+    switch (params->kind) {
+    case TEXTURE_BRICK:   generateBrick(base, image->size, &state); break;
+    case TEXTURE_EXIT:    generateExit(base, image->size); break;
+    case TEXTURE_FLOOR:   generateFloor(base, image->size, &state); break;
+    case TEXTURE_CEILING: generateCeiling(base, image->size, &state); break;
+    default: break;
+    }
+
+    for (int level = 1, size = image->size; level < image->levels; level++, size /= 2)
+        downsample(textureLevel(image, level - 1), textureLevel(image, level), size);
+
+    return 0;
+}
+
+void textureCachePath(const TextureParams *params, const char *dir, char *path, int pathSize)
+{
+    int valid = validParams(params);
+    snprintf(path, pathSize, "%s%s%s_%d_%08x_%d.tex", dir ? dir : "", dir && *dir ? "/" : "",
+             valid ? kindNames[params->kind] : "invalid", params->size, (unsigned int)params->seed,
+             valid ? clampLevels(params) : params->levels);
+}
+
+static int readCache(const TextureParams *params, const char *path, TextureImage *image)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+
+    TextureCacheHeader header;
+    int levels = clampLevels(params);
+    size_t count = texelCount(params->size, levels);
+    int ok = fread(&header, sizeof(header), 1, f) == 1 &&
+             header.magic == TEXTURE_CACHE_MAGIC && header.version == TEXTURE_CACHE_VERSION &&
+             header.kind == (uint32_t)params->kind && header.size == (uint32_t)params->size &&
+             header.seed == params->seed && header.levels == (uint32_t)levels;
+
+    if (ok) {
+        image->size = params->size;
+        image->levels = levels;
+        image->pixels = malloc(count * sizeof(unsigned int));
+        ok = image->pixels && fread(image->pixels, sizeof(unsigned int), count, f) == count;
+    }
+
+    /* Anything after the texels means the file is not what we wrote */
+    ok = ok && fgetc(f) == EOF;
+    fclose(f);
+
+    if (!ok) {
+        freeTextureImage(image);
+        return -1;
+    }
+    return 0;
+}
+
+static void writeCache(const TextureImage *image, const TextureParams *params, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return;
+
+    TextureCacheHeader header = {TEXTURE_CACHE_MAGIC, TEXTURE_CACHE_VERSION, (uint32_t)params->kind,
+                                 (uint32_t)image->size, params->seed, (uint32_t)image->levels, {0, 0}};
+    size_t count = texelCount(image->size, image->levels);
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(image->pixels, sizeof(unsigned int), count, f) == count;
+
+    /* A half-written cache would only be rejected next time; drop it now */
+    if (fclose(f) != 0 || !ok) remove(path);
+}
+
+int loadTexture(const TextureParams *params, const char *dir, TextureImage *image)
+{
+    memset(image, 0, sizeof(*image));
+    if (!validParams(params)) return -1;
+
+    char path[256];
+    textureCachePath(params, dir, path, sizeof(path));
+    if (readCache(params, path, image) == 0) return 0;
+
+    if (generateTexture(params, image) < 0) return -1;
+    writeCache(image, params, path);
+    return 0;
+}
+
+void freeTextureImage(TextureImage *image)
+{
+    free(image->pixels);
+    image->pixels = NULL;
+    image->size = 0;
+    image->levels = 0;
+}
+
+/* ============== Packed Formats ============== */
+
+static const char *formatNames[TEXTURE_FORMAT_COUNT] = {"rgba8888", "rgb565", "rgba4444", "clut8"};
+
+int textureFormatBytes(TextureFormat format)
+{
+    switch (format) {
+    case TEXTURE_RGB565:
+    case TEXTURE_RGBA4444: return 2;
+    case TEXTURE_CLUT8:    return 1;
+    default:               return 4;
+    }
+}
+
+const char *textureFormatName(TextureFormat format)
+{
+    return format >= 0 && format < TEXTURE_FORMAT_COUNT ? formatNames[format] : "unknown";
+}
+
+int parseTextureFormat(const char *name)
+{
+    for (int i = 0; i < TEXTURE_FORMAT_COUNT; i++) {
+        if (strcmp(name, formatNames[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int packedTextureBytes(const PackedTexture *texture)
+{
+    int bytes = (int)texelCount(texture->size, texture->levels) * textureFormatBytes(texture->format);
+    if (texture->format == TEXTURE_CLUT8) bytes += TEXTURE_PALETTE_SIZE * 4;
+    return bytes;
+}
+
+void *packedLevel(const PackedTexture *texture, int level)
+{
+    size_t offset = texelCount(texture->size, level) * textureFormatBytes(texture->format);
+    return (unsigned char *)texture->texels + offset;
+}
+
+/* Rounded to the nearest step, not truncated, so mid-greys do not drift darker */
+static unsigned int scaleChannel(unsigned int c, unsigned int max)
+{
+    return (c * max + 127) / 255;
+}
+
+static uint16_t packRgb565(unsigned int texel)
+{
+    unsigned int r = texel & 0xFF, g = (texel >> 8) & 0xFF, b = (texel >> 16) & 0xFF;
+    return (uint16_t)((scaleChannel(r, 31) << 11) | (scaleChannel(g, 63) << 5) | scaleChannel(b, 31));
+}
+
+static uint16_t packRgba4444(unsigned int texel)
+{
+    unsigned int r = texel & 0xFF, g = (texel >> 8) & 0xFF, b = (texel >> 16) & 0xFF, a = texel >> 24;
+    return (uint16_t)((scaleChannel(r, 15) << 12) | (scaleChannel(g, 15) << 8) |
+                      (scaleChannel(b, 15) << 4) | scaleChannel(a, 15));
+}
+
+static unsigned int expandChannel(unsigned int c, unsigned int max)
+{
+    return (c * 255 + max / 2) / max;
+}
+
+static unsigned int unpackRgb565(uint16_t p)
+{
+    return 0xFF000000u | (expandChannel(p & 31, 31) << 16) | (expandChannel((p >> 5) & 63, 63) << 8) |
+           expandChannel(p >> 11, 31);
+}
+
+static unsigned int unpackRgba4444(uint16_t p)
+{
+    return (expandChannel(p & 15, 15) << 24) | (expandChannel((p >> 4) & 15, 15) << 16) |
+           (expandChannel((p >> 8) & 15, 15) << 8) | expandChannel(p >> 12, 15);
+}
+
+/* ============== Palette (CLUT8) ============== */
+
+typedef struct {
+    unsigned int color;
+    unsigned int count;   /* Texels of this colour over all levels */
+} ColorCount;
+
+/* Distinct colours of an image, found through an open-addressing hash */
+typedef struct {
+    ColorCount *colors;
+    unsigned char *index; /* Palette entry of each distinct colour */
+    int count;
+    int *slots;           /* -1 when empty, else a position in colors */
+    unsigned int mask;
+} ColorTable;
+
+static unsigned int hashColor(unsigned int c)
+{
+    c ^= c >> 16;
+    c *= 0x85EBCA6Bu;
+    c ^= c >> 13;
+    return c;
+}
+
+static unsigned int findSlot(const ColorTable *t, unsigned int color)
+{
+    unsigned int slot = hashColor(color) & t->mask;
+    while (t->slots[slot] >= 0 && t->colors[t->slots[slot]].color != color) slot = (slot + 1) & t->mask;
+    return slot;
+}
+
+static void rehashColors(ColorTable *t)
+{
+    memset(t->slots, 0xFF, (t->mask + 1) * sizeof(int));
+    for (int i = 0; i < t->count; i++) t->slots[findSlot(t, t->colors[i].color)] = i;
+}
+
+/* Sized for the worst case of every texel being distinct. Returns 0 on success. */
+static int buildColorTable(ColorTable *t, const TextureImage *image)
+{
+    size_t texels = texelCount(image->size, image->levels);
+    unsigned int capacity = 16;
+    while (capacity < texels * 2) capacity *= 2;
+
+    memset(t, 0, sizeof(*t));
+    t->colors = malloc(texels * sizeof(ColorCount));
+    t->index = malloc(texels);
+    t->slots = malloc(capacity * sizeof(int));
+    t->mask = capacity - 1;
+    if (!t->colors || !t->index || !t->slots) return -1;
+    memset(t->slots, 0xFF, capacity * sizeof(int));
+
+    for (size_t i = 0; i < texels; i++) {
+        unsigned int slot = findSlot(t, image->pixels[i]);
+        if (t->slots[slot] < 0) {
+            t->slots[slot] = t->count;
+            t->colors[t->count++] = (ColorCount){image->pixels[i], 0};
+        }
+        t->colors[t->slots[slot]].count++;
+    }
+    return 0;
+}
+
+static void freeColorTable(ColorTable *t)
+{
+    free(t->colors);
+    free(t->index);
+    free(t->slots);
+}
+
+/* A run of distinct colours that becomes one palette entry */
+typedef struct {
+    int first, count;
+    int channel;        /* Widest channel, 0-3 for R, G, B, A */
+    int range;
+} ColorBox;
+
+static void measureBox(const ColorTable *t, ColorBox *box)
+{
+    box->range = -1;
+    for (int channel = 0; channel < 4; channel++) {
+        int lo = 255, hi = 0;
+        for (int i = box->first; i < box->first + box->count; i++) {
+            int c = (t->colors[i].color >> (channel * 8)) & 0xFF;
+            if (c < lo) lo = c;
+            if (c > hi) hi = c;
+        }
+        if (hi - lo > box->range) {
+            box->range = hi - lo;
+            box->channel = channel;
+        }
+    }
+}
+
+/* Counting sort on the box's widest channel; stable, so the result is the same on every platform */
+static void sortBox(ColorTable *t, const ColorBox *box, ColorCount *scratch)
+{
+    int start[257] = {0};
+    int shift = box->channel * 8;
+    ColorCount *colors = t->colors + box->first;
+
+    for (int i = 0; i < box->count; i++) start[((colors[i].color >> shift) & 0xFF) + 1]++;
+    for (int k = 0; k < 256; k++) start[k + 1] += start[k];
+    for (int i = 0; i < box->count; i++) scratch[start[(colors[i].color >> shift) & 0xFF]++] = colors[i];
+    memcpy(colors, scratch, box->count * sizeof(ColorCount));
+}
+
+/*
+ * Median cut: split the widest box at its texel-weighted median until there
+ * are enough boxes. Returns the number of boxes, 0 if out of memory.
+ */
+static int medianCut(ColorTable *t, ColorBox *boxes, int maxBoxes)
+{
+    ColorCount *scratch = malloc(t->count * sizeof(ColorCount));
+    if (!scratch) return 0;
+
+    int boxCount = 1;
+    boxes[0] = (ColorBox){0, t->count, 0, 0};
+    measureBox(t, &boxes[0]);
+
+    while (boxCount < maxBoxes) {
+        int widest = -1;
+        for (int i = 0; i < boxCount; i++) {
+            if (boxes[i].count > 1 && (widest < 0 || boxes[i].range > boxes[widest].range)) widest = i;
+        }
+        if (widest < 0 || boxes[widest].range == 0) break;
+
+        ColorBox *box = &boxes[widest];
+        sortBox(t, box, scratch);
+
+        unsigned long total = 0, below = 0;
+        int last = box->first + box->count - 1;
+        for (int i = box->first; i <= last; i++) total += t->colors[i].count;
+
+        /* The upper half starts after the median texel, keeping at least one colour on each side */
+        int split = box->first;
+        while (split < last - 1 && (below + t->colors[split].count) * 2 < total) below += t->colors[split++].count;
+        split++;
+
+        ColorBox upper = {split, box->first + box->count - split, 0, 0};
+        box->count = split - box->first;
+        measureBox(t, box);
+        measureBox(t, &upper);
+        boxes[boxCount++] = upper;
+    }
+
+    free(scratch);
+    return boxCount;
+}
+
+/* Texel-weighted mean of a box */
+static unsigned int boxColor(const ColorTable *t, const ColorBox *box)
+{
+    unsigned long sum[4] = {0, 0, 0, 0}, weight = 0;
+    for (int i = box->first; i < box->first + box->count; i++) {
+        for (int k = 0; k < 4; k++) sum[k] += ((t->colors[i].color >> (k * 8)) & 0xFF) * (unsigned long)t->colors[i].count;
+        weight += t->colors[i].count;
+    }
+
+    unsigned int color = 0;
+    for (int k = 0; k < 4; k++) color |= (unsigned int)((sum[k] + weight / 2) / weight) << (k * 8);
+    return color;
+}
+
+static int colorDistance(unsigned int a, unsigned int b)
+{
+    int d = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int c = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+        d += c * c;
+    }
+    return d;
+}
+
+static int green(unsigned int color)
+{
+    return (color >> 8) & 0xFF;
+}
+
+/* Palette positions in order of green, so nearestEntry can stop early */
+static void sortByGreen(const unsigned int *palette, int size, unsigned char *order)
+{
+    for (int i = 0; i < size; i++) {
+        int j = i - 1;
+        while (j >= 0 && green(palette[order[j]]) > green(palette[i])) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = (unsigned char)i;
+    }
+}
+
+/*
+ * Starting from guess (the colour's own box), walks outward from the
+ * colour's green in both directions; once the green difference alone is
+ * as far as the best match, nothing further that way can be nearer.
+ */
+static int nearestEntry(const unsigned int *palette, const unsigned char *order, int size,
+                        unsigned int color, int guess)
+{
+    int best = guess, bestDistance = colorDistance(color, palette[guess]);
+    int g = green(color);
+
+    int lo = 0, hi = size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (green(palette[order[mid]]) < g) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (int up = lo, down = lo - 1; (up < size || down >= 0) && bestDistance > 0;) {
+        int p;
+        if (up < size) {
+            p = order[up++];
+        } else {
+            p = order[down--];
+        }
+
+        int dg = green(palette[p]) - g;
+        if (dg * dg >= bestDistance) {
+            /* This direction is done */
+            if (dg >= 0) up = size;
+            else down = -1;
+            continue;
+        }
+
+        int d = colorDistance(color, palette[p]);
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = p;
+        }
+    }
+    return best;
+}
+
+static int packClut(const TextureImage *image, PackedTexture *out)
+{
+    ColorTable t;
+    if (buildColorTable(&t, image) < 0) {
+        freeColorTable(&t);
+        return -1;
+    }
+
+    if (t.count <= TEXTURE_PALETTE_SIZE) {
+        /* Few enough colours to keep every one exactly */
+        for (int i = 0; i < t.count; i++) {
+            out->palette[i] = t.colors[i].color;
+            t.index[i] = (unsigned char)i;
+        }
+        out->paletteSize = t.count;
+    } else {
+        ColorBox boxes[TEXTURE_PALETTE_SIZE];
+        int boxCount = medianCut(&t, boxes, TEXTURE_PALETTE_SIZE);
+        if (boxCount == 0) {
+            freeColorTable(&t);
+            return -1;
+        }
+        for (int b = 0; b < boxCount; b++) out->palette[b] = boxColor(&t, &boxes[b]);
+        out->paletteSize = boxCount;
+
+        /* Once per distinct colour rather than per texel; the nearest entry is not always its own box's */
+        unsigned char order[TEXTURE_PALETTE_SIZE];
+        sortByGreen(out->palette, boxCount, order);
+        for (int b = 0; b < boxCount; b++) {
+            for (int i = boxes[b].first; i < boxes[b].first + boxes[b].count; i++) {
+                t.index[i] = (unsigned char)nearestEntry(out->palette, order, boxCount, t.colors[i].color, b);
+            }
+        }
+
+        /* Sorting moved the colours */
+        rehashColors(&t);
+    }
+
+    unsigned char *dst = out->texels;
+    size_t texels = texelCount(image->size, image->levels);
+    for (size_t i = 0; i < texels; i++) dst[i] = t.index[t.slots[findSlot(&t, image->pixels[i])]];
+
+    freeColorTable(&t);
+    return 0;
+}
+
+int packTexture(const TextureImage *image, TextureFormat format, PackedTexture *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!image->pixels || format < 0 || format >= TEXTURE_FORMAT_COUNT) return -1;
+
+    size_t texels = texelCount(image->size, image->levels);
+    out->format = format;
+    out->size = image->size;
+    out->levels = image->levels;
+    out->texels = malloc(texels * textureFormatBytes(format));
+    if (!out->texels) return -1;
+
+    const unsigned int *src = image->pixels;
+    switch (format) {
+    case TEXTURE_RGB565: {
+        uint16_t *dst = out->texels;
+        for (size_t i = 0; i < texels; i++) dst[i] = packRgb565(src[i]);
+        break;
+    }
+    case TEXTURE_RGBA4444: {
+        uint16_t *dst = out->texels;
+        for (size_t i = 0; i < texels; i++) dst[i] = packRgba4444(src[i]);
+        break;
+    }
+    case TEXTURE_CLUT8:
+        if (packClut(image, out) < 0) {
+            freePackedTexture(out);
+            return -1;
+        }
+        break;
+    default:
+        memcpy(out->texels, src, texels * sizeof(unsigned int));
+        break;
+    }
+    return 0;
+}
+
+void unpackTexture(const PackedTexture *texture, unsigned int *rgba)
+{
+    size_t texels = texelCount(texture->size, texture->levels);
+
+    for (size_t i = 0; i < texels; i++) {
+        switch (texture->format) {
+        case TEXTURE_RGB565:   rgba[i] = unpackRgb565(((const uint16_t *)texture->texels)[i]); break;
+        case TEXTURE_RGBA4444: rgba[i] = unpackRgba4444(((const uint16_t *)texture->texels)[i]); break;
+        case TEXTURE_CLUT8:    rgba[i] = texture->palette[((const unsigned char *)texture->texels)[i]]; break;
+        default:               rgba[i] = ((const unsigned int *)texture->texels)[i]; break;
+        }
+    }
+}
+
+void freePackedTexture(PackedTexture *texture)
+{
+    free(texture->texels);
+    texture->texels = NULL;
+    texture->levels = 0;
+    texture->paletteSize = 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * Procedural wall, floor and ceiling textures for the 3D maze
+ *
+ * Every texture is generated from its parameters alone (kind, size, seed,
+ * mip levels) with the maze's xorshift generator, so the same parameters
+ * give the same texels on every run and platform. The finished image, mip
+ * chain included, is cached on disk in the layout glTexImage2D takes; later
+ * launches read it back instead of generating it, so bigger textures and
+ * deeper mip chains cost a file read rather than startup time.
+ *
+ * For upload an image can be packed into a smaller texel format, chosen
+ * per texture: RGB565 and RGBA4444 at 2 bytes per texel, or 8-bit indices
+ * into a 256-entry palette (CLUT8) at 1 byte. The palette is built per
+ * texture by median cut over all its mip levels, so one CLUT serves the
+ * whole chain as the PSP's GE expects.
+ *
+ * Pure C with no GL calls: the asset job builds images on a worker thread
+ * and the main thread uploads them.
+ */
+
+#ifndef TEXTURES_H
+#define TEXTURES_H
+
+#include <stdint.h>
+
+#define TEXTURE_MAX_SIZE 1024
+#define TEXTURE_MAX_LEVELS 11   /* 1024 down to 1 */
+
+#define TEXTURE_CACHE_MAGIC 0x5845544Du   /* "MTEX" */
+#define TEXTURE_CACHE_VERSION 1           /* Bump when a generator changes its output */
+
+typedef enum {
+    TEXTURE_BRICK,
+    TEXTURE_EXIT,
+    TEXTURE_FLOOR,
+    TEXTURE_CEILING,
+    TEXTURE_KIND_COUNT
+} TextureKind;
+
+typedef enum {
+    TEXTURE_RGBA8888,
+    TEXTURE_RGB565,     /* Packed as GL_UNSIGNED_SHORT_5_6_5: red in the top bits */
+    TEXTURE_RGBA4444,   /* Packed as GL_UNSIGNED_SHORT_4_4_4_4 */
+    TEXTURE_CLUT8,
+    TEXTURE_FORMAT_COUNT
+} TextureFormat;
+
+#define TEXTURE_PALETTE_SIZE 256
+
+/* Everything the output depends on; also the cache key */
+typedef struct {
+    TextureKind kind;
+    int size;           /* Power of two; patterns scale with it */
+    uint32_t seed;
+    int levels;         /* Mip levels to build, 1 for none; clamped to the full chain */
+} TextureParams;
+
+/* RGBA8 texels (R in the low byte), level 0 first and each level straight after the one above */
+typedef struct {
+    int size;
+    int levels;
+    unsigned int *pixels;
+} TextureImage;
+
+/* An image in its upload format, levels laid out as in TextureImage */
+typedef struct {
+    TextureFormat format;
+    int size;
+    int levels;
+    void *texels;
+    unsigned int palette[TEXTURE_PALETTE_SIZE];   /* CLUT8 only, RGBA8 like the image */
+    int paletteSize;
+} PackedTexture;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t size;
+    uint32_t seed;
+    uint32_t levels;
+    uint32_t reserved[2];
+} TextureCacheHeader;
+
+/* Texels of one mip level, level sizes halving down to 1x1 */
+static inline unsigned int *textureLevel(const TextureImage *image, int level)
+{
+    unsigned int *p = image->pixels;
+    for (int i = 0, s = image->size; i < level; i++, s /= 2) p += s * s;
+    return p;
+}
+
+/* Generates the image and its mip chain. Returns 0 on success, -1 on bad parameters or no memory. */
+int generateTexture(const TextureParams *params, TextureImage *image);
+
+/*
+ * Reads the cached image for params from dir, or generates it and writes
+ * the cache. A cache that is missing, truncated or built from other
+ * parameters is regenerated. Returns 0 on success.
+ */
+int loadTexture(const TextureParams *params, const char *dir, TextureImage *image);
+
+/* Cache file name for params, e.g. "brick_64_0001b21c_7.tex" */
+void textureCachePath(const TextureParams *params, const char *dir, char *path, int pathSize);
+
+void freeTextureImage(TextureImage *image);
+
+int textureFormatBytes(TextureFormat format);
+const char *textureFormatName(TextureFormat format);
+
+/* Parses a name from textureFormatName. Returns -1 if unknown. */
+int parseTextureFormat(const char *name);
+
+/* Bytes of texture memory the packed texture takes, palette included */
+int packedTextureBytes(const PackedTexture *texture);
+
+/* Texels of one level, textureFormatBytes(format) each */
+void *packedLevel(const PackedTexture *texture, int level);
+
+/* Converts every level of image. Returns 0 on success, -1 if out of memory. */
+int packTexture(const TextureImage *image, TextureFormat format, PackedTexture *out);
+
+/* Expands back to RGBA8 into a buffer laid out like TextureImage.pixels, e.g. where GL has no paletted textures */
+void unpackTexture(const PackedTexture *texture, unsigned int *rgba);
+
+void freePackedTexture(PackedTexture *texture);
+
+#endif
@@ -0,0 +1,220 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "world.h"
+
+#define WORLD_WINDOW_GRID (WORLD_WINDOW_CHUNKS * WORLD_CHUNK_GRID + 1)
+#define ALL_WALLS 0x55555555u
+#define LOW_LANES 0x55555555u
+
+#define SALT_CHUNK 0
+#define SALT_DOOR_SIDE 1
+#define SALT_DOOR_POS 2
+
+/* ============== Chunk Generation ============== */
+
+/* Mixes the world seed with chunk coordinates (murmur3 finaliser) */
+static uint32_t hashChunk(uint32_t seed, int cx, int cy, uint32_t salt)
+{
+    uint32_t h = seed ^ ((uint32_t)cx * 0x9E3779B1u) ^ ((uint32_t)cy * 0x85EBCA77u) ^ (salt * 0xC2B2AE3Du);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void setChunkCell(WorldChunk *chunk, int x, int y, int value)
+{
+    int shift = x * CELL_BITS;
+    chunk->rows[y] = (chunk->rows[y] & ~(3u << shift)) | ((uint32_t)value << shift);
+}
+
+static int generateChunk(const World *world, WorldChunk *chunk, int cx, int cy)
+{
+    int cw = world->mazeWidth - cx * WORLD_CHUNK_CELLS;
+    int ch = world->mazeHeight - cy * WORLD_CHUNK_CELLS;
+    if (cw > WORLD_CHUNK_CELLS) cw = WORLD_CHUNK_CELLS;
+    if (ch > WORLD_CHUNK_CELLS) ch = WORLD_CHUNK_CELLS;
+
+    /* Scratch: with an arena it is rewound straight after, so the chunk costs the heap nothing */
+    Arena *arena = world->window.arena;
+    size_t mark = arena ? arenaMark(arena) : 0;
+    Maze local;
+    memset(&local, 0, sizeof(local));
+    local.arena = arena;
+    if (generateMazeGrid(&local, cw, ch, hashChunk(world->seed, cx, cy, SALT_CHUNK)) < 0) {
+        if (arena) rewindArena(arena, mark);
+        return -1;
+    }
+
+    /* The local maze is at most 17 cells wide: its first 16 columns fit one word, and its east
+       and south borders belong to the neighbouring chunks. Dropping the high bits turns the
+       local exit back into an open cell. */
+    for (int y = 0; y < WORLD_CHUNK_GRID; y++) {
+        uint32_t row = ALL_WALLS;
+        if (y < local.gridHeight - 1) {
+            int width = local.gridWidth - 1;
+            uint32_t mask = width >= CELLS_PER_WORD ? ~0u : (1u << (width * CELL_BITS)) - 1;
+            row = (local.cells[y * local.wordsPerRow] & LOW_LANES & mask) | (ALL_WALLS & ~mask);
+        }
+        chunk->rows[y] = row;
+    }
+    freeMaze(&local);
+    if (arena) rewindArena(arena, mark);
+
+    /* One door per chunk, west or north, links every chunk back to (0, 0) without loops */
+    int openWest = cx > 0;
+    if (cx > 0 && cy > 0) openWest = hashChunk(world->seed, cx, cy, SALT_DOOR_SIDE) & 1;
+    if (cx > 0 || cy > 0) {
+        uint32_t pos = hashChunk(world->seed, cx, cy, SALT_DOOR_POS);
+        if (openWest) setChunkCell(chunk, 0, (int)(pos % ch) * 2 + 1, CELL_OPEN);
+        else setChunkCell(chunk, (int)(pos % cw) * 2 + 1, 0, CELL_OPEN);
+    }
+
+    /* The exit sits in the far corner of the whole level */
+    if (cx == world->chunksX - 1 && cy == world->chunksY - 1) {
+        setChunkCell(chunk, (cw - 1) * 2 + 1, (ch - 1) * 2 + 1, CELL_EXIT);
+    }
+
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->valid = 1;
+    return 0;
+}
+
+const WorldChunk *acquireWorldChunk(World *world, int cx, int cy)
+{
+    WorldChunk *slot = NULL;
+
+    for (int i = 0; i < WORLD_CACHE_CHUNKS; i++) {
+        WorldChunk *c = &world->cache[i];
+        if (c->valid && c->cx == cx && c->cy == cy) {
+            c->lastUsed = ++world->useClock;
+            return c;
+        }
+        /* Prefer an empty slot, otherwise the least recently used one */
+        if (!slot || (slot->valid && (!c->valid || c->lastUsed < slot->lastUsed))) {
+            slot = c;
+        }
+    }
+
+    if (slot->valid) world->chunksEvicted++;
+    slot->valid = 0;
+    if (generateChunk(world, slot, cx, cy) < 0) return NULL;
+
+    world->chunksGenerated++;
+    slot->lastUsed = ++world->useClock;
+    return slot;
+}
+
+/* ============== World ============== */
+
+int initWorld(World *world, int mazeWidth, int mazeHeight, uint32_t seed, Arena *arena)
+{
+    memset(world, 0, sizeof(*world));
+    world->mazeWidth = mazeWidth;
+    world->mazeHeight = mazeHeight;
+    world->chunksX = (mazeWidth + WORLD_CHUNK_CELLS - 1) / WORLD_CHUNK_CELLS;
+    world->chunksY = (mazeHeight + WORLD_CHUNK_CELLS - 1) / WORLD_CHUNK_CELLS;
+    world->seed = seed;
+
+    Maze *w = &world->window;
+    w->gridWidth = WORLD_WINDOW_GRID;
+    w->gridHeight = WORLD_WINDOW_GRID;
+    w->wordsPerRow = (WORLD_WINDOW_GRID + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    w->arena = arena;
+    w->cells = arena ? arenaAlloc(arena, w->wordsPerRow * w->gridHeight * sizeof(uint32_t))
+                     : malloc(w->wordsPerRow * w->gridHeight * sizeof(uint32_t));
+    if (!w->cells) return -1;
+    w->arenaMark = arena ? arenaMark(arena) : 0;
+
+    /* Force the first update to fill the window */
+    world->originChunkX = -1;
+    world->originChunkY = -1;
+    return 0;
+}
+
+void freeWorld(World *world)
+{
+    freeMaze(&world->window);
+}
+
+static int clampOrigin(int playerChunk, int chunks)
+{
+    int origin = playerChunk - WORLD_WINDOW_CHUNKS / 2;
+    if (origin > chunks - WORLD_WINDOW_CHUNKS) origin = chunks - WORLD_WINDOW_CHUNKS;
+    if (origin < 0) origin = 0;
+    return origin;
+}
+
+/*
+ * Origin along one axis for a player at pos. Once the window has been
+ * placed, it only follows the player WORLD_WINDOW_MARGIN cells past a seam,
+ * so pacing back and forth across one rebuilds nothing.
+ */
+static int followOrigin(float pos, int current, int chunks)
+{
+    int target = clampOrigin((int)pos / WORLD_CHUNK_GRID, chunks);
+    if (current < 0 || target == current) return target;
+
+    float probe = target > current ? pos - WORLD_WINDOW_MARGIN : pos + WORLD_WINDOW_MARGIN;
+    if (probe < 0) probe = 0;
+    return clampOrigin((int)probe / WORLD_CHUNK_GRID, chunks);
+}
+
+int updateWorld(World *world, float x, float y)
+{
+    int ox = followOrigin(x, world->originChunkX, world->chunksX);
+    int oy = followOrigin(y, world->originChunkY, world->chunksY);
+    if (ox == world->originChunkX && oy == world->originChunkY) return 0;
+
+    Maze *w = &world->window;
+    if (!w->cells) return -1;
+    for (int i = 0; i < w->wordsPerRow * w->gridHeight; i++) {
+        w->cells[i] = ALL_WALLS;
+    }
+
+    /* Chunks are word-aligned in the window, so each chunk row is a single word copy */
+    for (int wy = 0; wy < WORLD_WINDOW_CHUNKS; wy++) {
+        for (int wx = 0; wx < WORLD_WINDOW_CHUNKS; wx++) {
+            int cx = ox + wx;
+            int cy = oy + wy;
+            if (cx >= world->chunksX || cy >= world->chunksY) continue;
+
+            const WorldChunk *chunk = acquireWorldChunk(world, cx, cy);
+            if (!chunk) continue;
+            for (int r = 0; r < WORLD_CHUNK_GRID; r++) {
+                w->cells[(wy * WORLD_CHUNK_GRID + r) * w->wordsPerRow + wx] = chunk->rows[r];
+            }
+        }
+    }
+
+    world->originChunkX = ox;
+    world->originChunkY = oy;
+    world->originX = ox * WORLD_CHUNK_GRID;
+    world->originY = oy * WORLD_CHUNK_GRID;
+
+    return buildMazeWalls(w) < 0 ? -1 : 1;
+}
+
+int worldIsWall(const World *world, int x, int y)
+{
+    return mazeIsWall(&world->window, x - world->originX, y - world->originY);
+}
+
+int worldIsExit(const World *world, int x, int y)
+{
+    return mazeIsExit(&world->window, x - world->originX, y - world->originY);
+}
+
+int worldCheckCollision(const World *world, float x, float y, float radius)
+{
+    return mazeCheckCollision(&world->window, x - world->originX, y - world->originY, radius);
+}
+
+int worldSweepCircle(const World *world, float x, float y, float dx, float dy, float radius, float *t)
+{
+    return mazeSweepCircle(&world->window, x - world->originX, y - world->originY, dx, dy, radius, t);
+}
@@ -0,0 +1,91 @@
+/**
+ * Streaming chunked maze world
+ *
+ * The level is split into chunks of WORLD_CHUNK_CELLS x WORLD_CHUNK_CELLS
+ * maze cells. Each chunk is generated on its own from a seed derived from
+ * the world seed and its coordinates, so an evicted chunk is rebuilt exactly
+ * when it comes back. Every chunk opens one door in its west or north edge
+ * (the binary-tree rule applied to whole chunks), which keeps the level a
+ * perfect maze and means each seam belongs to exactly one chunk.
+ *
+ * Only a WORLD_WINDOW_CHUNKS square of chunks around the player is copied
+ * into a Maze (the window) for collision, visibility and meshing. Memory is
+ * the same for a 5x5 level as for a 100000x100000 one.
+ */
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "maze.h"
+
+#define WORLD_CHUNK_CELLS 8
+#define WORLD_CHUNK_GRID (WORLD_CHUNK_CELLS * 2)    /* One packed word per chunk row */
+#define WORLD_WINDOW_CHUNKS 3
+#define WORLD_CACHE_CHUNKS 16
+
+/*
+ * Grid cells the player must be past a chunk seam before the window moves.
+ * Two keeps a player in a doorway from rebuilding it, and still leaves 14
+ * cells of window ahead, inside the game's 15-cell fog.
+ */
+#define WORLD_WINDOW_MARGIN 2
+
+/*
+ * Most wall faces one window can expose, for sizing storage up front. Every
+ * face belongs to a maze cell (4 at most, one per wall beside it) or to a
+ * door leading out of the window; the exit cell adds up to 4 of its own.
+ */
+#define WORLD_WINDOW_CELLS (WORLD_WINDOW_CHUNKS * WORLD_CHUNK_CELLS)
+#define WORLD_MAX_WALLS (4 * WORLD_WINDOW_CELLS * WORLD_WINDOW_CELLS + 4 * WORLD_WINDOW_CELLS + 4)
+
+/* Chunk (cx, cy) owns grid cells [cx * 16, cx * 16 + 16) on both axes, including its west and north edges */
+typedef struct {
+    int cx, cy;
+    int valid;
+    unsigned int lastUsed;
+    uint32_t rows[WORLD_CHUNK_GRID];
+} WorldChunk;
+
+typedef struct {
+    int mazeWidth;
+    int mazeHeight;
+    int chunksX;
+    int chunksY;
+    uint32_t seed;
+
+    WorldChunk cache[WORLD_CACHE_CHUNKS];
+    unsigned int useClock;
+
+    /* Resident window, in grid cells; window coordinate = world coordinate - origin */
+    Maze window;
+    int originChunkX;
+    int originChunkY;
+    int originX;
+    int originY;
+
+    int chunksGenerated;
+    int chunksEvicted;
+} World;
+
+/* Returns 0 on success. With an arena the window and its wall lists live there (see buildMazeWalls). */
+int initWorld(World *world, int mazeWidth, int mazeHeight, uint32_t seed, Arena *arena);
+void freeWorld(World *world);
+
+/*
+ * Recentres the window on the chunk containing (x, y), once (x, y) is
+ * WORLD_WINDOW_MARGIN cells inside that chunk. Returns 1 when the
+ * window moved and its wall list was rebuilt, 0 when nothing changed and
+ * -1 if the wall list could not be allocated.
+ */
+int updateWorld(World *world, float x, float y);
+
+/* Returns the chunk's rows from the cache, generating it (and evicting the least recently used chunk) if needed */
+const WorldChunk *acquireWorldChunk(World *world, int cx, int cy);
+
+/* World-space queries, answered from the window; anything outside it is solid */
+int worldIsWall(const World *world, int x, int y);
+int worldIsExit(const World *world, int x, int y);
+int worldCheckCollision(const World *world, float x, float y, float radius);
+int worldSweepCircle(const World *world, float x, float y, float dx, float dy, float radius, float *t);
+
+#endif